@@ -0,0 +1,113 @@
+#ifndef __Benchmark_h__
+#define __Benchmark_h__
+
+#include <stdint.h>
+#include "basicmaths.h"
+#include <time.h>
+#include "message.h"
+
+/**
+ * Minimal micro-benchmark harness for the host build of LibSource.
+ *
+ * Each benchmark is registered with BENCHMARK(name) and is called once per
+ * block size. Set up any state first, then run the code under test in a
+ * while(bench.run()) loop: the harness decides how many iterations to time.
+ * Results are reported in ns per sample, i.e. per element of the block.
+ * Benchmarks whose work doesn't scale with the block size can set
+ * bench.items to the number of operations per iteration instead.
+ *
+ * BENCHMARK(FloatArray_multiply){
+ *   FloatArray a = FloatArray::create(bench.blocksize);
+ *   while(bench.run())
+ *     a.multiply(0.5f);
+ *   FloatArray::destroy(a);
+ * }
+ */
+class BenchmarkContext {
+public:
+  BenchmarkContext(int size, uint64_t minimumNs)
+    : blocksize(size), iterations(0), elapsed(0), start(0),
+      minimum(minimumNs), skipped(false), items(size), remaining(0), batch(1) {}
+  /**
+   * Returns true while the benchmark loop should keep iterating.
+   * The clock is read once per batch of iterations, and the batch size
+   * doubles, so that timer overhead doesn't dominate short blocks.
+   */
+  bool run(){
+    if(remaining > 0){
+      remaining--;
+      iterations++;
+      return true;
+    }
+    uint64_t now = getNanoseconds();
+    if(iterations == 0){
+      start = now;
+    }else{
+      elapsed = now - start;
+      if(elapsed >= minimum)
+	return false;
+      batch = batch < 4096 ? batch*2 : batch;
+    }
+    remaining = batch-1;
+    iterations++;
+    return true;
+  }
+  /** Mark this block size as not applicable, e.g. below a minimum FFT length */
+  void skip(){
+    skipped = true;
+  }
+  /** Prevent the compiler from optimising away a result */
+  template<typename T>
+  static void keep(T value){
+    asm volatile("" : : "g"(value) : "memory");
+  }
+  static void keep(float* ptr){
+    asm volatile("" : : "r"(ptr) : "memory");
+  }
+  double getNanosecondsPerSample(){
+    return iterations > 0 ? (double)elapsed/(iterations*(double)items) : 0.0;
+  }
+  static uint64_t getNanoseconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+  }
+  const int blocksize;
+  uint64_t iterations;
+  uint64_t elapsed;
+  uint64_t start;
+  uint64_t minimum;
+  bool skipped;
+  /** number of samples, or other operations, per iteration */
+  int items;
+private:
+  uint32_t remaining;
+  uint32_t batch;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkContext& bench);
+
+class Benchmark {
+public:
+  Benchmark(const char* aName, BenchmarkFunction fn) : name(aName), function(fn), next(NULL){
+    // append to keep registration order within a file
+    Benchmark** tail = &getFirst();
+    while(*tail != NULL)
+      tail = &(*tail)->next;
+    *tail = this;
+  }
+  static Benchmark*& getFirst(){
+    static Benchmark* first = NULL;
+    return first;
+  }
+  const char* name;
+  BenchmarkFunction function;
+  Benchmark* next;
+};
+
+#define BENCHMARK(name) \
+  static void bench_##name(BenchmarkContext& bench); \
+  static Benchmark benchmark_##name(#name, bench_##name); \
+  static void bench_##name(BenchmarkContext& bench)
+
+#endif // __Benchmark_h__
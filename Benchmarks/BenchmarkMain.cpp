@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "Benchmark.h"
+#include "device.h"
+#include "message.h"
+#include "heap.h"
+
+/*
+ * Runs every registered benchmark at block sizes from 16 to
+ * AUDIO_MAX_BLOCK_SIZE, writes the results as JSON and optionally compares
+ * them against a stored baseline, failing on regressions.
+ */
+
+#define MIN_BLOCKSIZE 16
+#define MAX_RESULTS   1024
+
+struct BenchmarkResult {
+  char name[64];
+  int blocksize;
+  double ns;
+};
+
+static BenchmarkResult results[MAX_RESULTS];
+static int numberOfResults = 0;
+
+/* the same regions as the renderer, see render.cpp */
+#define FAST_HEAP_SIZE   (32*1024)
+#define NORMAL_HEAP_SIZE (56*1024)
+#define BULK_HEAP_SIZE   (1024*1024)
+
+static struct {
+  uint8_t fast[FAST_HEAP_SIZE];
+  uint8_t normal[NORMAL_HEAP_SIZE];
+  uint8_t bulk[BULK_HEAP_SIZE];
+} heap __attribute__ ((aligned (8)));
+
+__attribute__ ((constructor (101)))
+static void defineHeapRegions(){
+  const HeapRegion_t xHeapRegions[] = {
+    { heap.fast, FAST_HEAP_SIZE },
+    { heap.normal, NORMAL_HEAP_SIZE },
+    { heap.bulk, BULK_HEAP_SIZE },
+    { NULL, 0 } /* Terminates the array. */
+  };
+  vPortDefineHeapRegions(xHeapRegions);
+}
+
+extern "C" void vApplicationMallocFailedHook( void ){}
+
+/*
+ * As in the renderer, all allocations come from the simulated heap, so
+ * that memory allocated with a MemoryHint can be released with delete.
+ */
+void * operator new(size_t size) { return pvPortMalloc(size); }
+void * operator new[](size_t size) { return pvPortMalloc(size); }
+void operator delete(void* ptr) { vPortFree(ptr); }
+void operator delete[](void * ptr) { vPortFree(ptr); }
+
+void debugMessage(const char* msg){
+  fprintf(stderr, "%s\n", msg);
+}
+
+void error(int8_t code, const char* reason){
+  fprintf(stderr, "Error %d: %s\n", code, reason);
+  exit(-1);
+}
+
+void assert_failed(const char* msg, const char* location, int line){
+  fprintf(stderr, "Assertion failed: %s in %s line %d\n", msg, location, line);
+  exit(-1);
+}
+
+static void writeResults(FILE* fp){
+  fprintf(fp, "{\n  \"unit\": \"ns/sample\",\n  \"benchmarks\": [\n");
+  for(int i=0; i<numberOfResults; ++i)
+    fprintf(fp, "    {\"name\": \"%s\", \"blocksize\": %d, \"ns_per_sample\": %.4f}%s\n",
+	    results[i].name, results[i].blocksize, results[i].ns,
+	    i+1 < numberOfResults ? "," : "");
+  fprintf(fp, "  ]\n}\n");
+}
+
+/* Compare results against a baseline file in the format written by writeResults() */
+static int compareResults(const char* filename, double tolerance){
+  FILE* fp = fopen(filename, "r");
+  if(fp == NULL){
+    fprintf(stderr, "Failed to open baseline %s\n", filename);
+    return -1;
+  }
+  int regressions = 0, compared = 0;
+  char line[256];
+  while(fgets(line, sizeof(line), fp) != NULL){
+    BenchmarkResult base;
+    if(sscanf(line, " {\"name\": \"%63[^\"]\", \"blocksize\": %d, \"ns_per_sample\": %lf",
+	      base.name, &base.blocksize, &base.ns) != 3)
+      continue;
+    for(int i=0; i<numberOfResults; ++i){
+      if(results[i].blocksize == base.blocksize && strcmp(results[i].name, base.name) == 0){
+	compared++;
+	if(results[i].ns > base.ns*(1.0+tolerance)){
+	  printf("REGRESSION %s blocksize %d: %.4f ns/sample, baseline %.4f (+%.0f%%)\n",
+		 base.name, base.blocksize, results[i].ns, base.ns,
+		 100.0*(results[i].ns/base.ns - 1.0));
+	  regressions++;
+	}
+	break;
+      }
+    }
+  }
+  fclose(fp);
+  printf("Compared %d results against %s with %.0f%% tolerance: %d regressions\n",
+	 compared, filename, tolerance*100, regressions);
+  return regressions;
+}
+
+static void usage(const char* name){
+  fprintf(stderr,
+	  "Usage: %s [options] [filter]\n"
+	  "  -o file.json    write results to file (default stdout)\n"
+	  "  -b file.json    compare against baseline and fail on regressions\n"
+	  "  -t percent      regression tolerance (default 20)\n"
+	  "  -m ms           minimum time per measurement (default 20)\n"
+	  "  -r repeats      measurements per result, the fastest is kept (default 3)\n"
+	  "  filter          only run benchmarks whose name contains this string\n", name);
+}
+
+int main(int argc, char** argv){
+  const char* outfile = NULL;
+  const char* baseline = NULL;
+  double tolerance = 0.2;
+  uint64_t minimum = 20000000;
+  int repeats = 3;
+  int opt;
+  while((opt = getopt(argc, argv, "o:b:t:m:r:h")) != -1){
+    switch(opt){
+    case 'o':
+      outfile = optarg;
+      break;
+    case 'b':
+      baseline = optarg;
+      break;
+    case 't':
+      tolerance = atof(optarg)/100.0;
+      break;
+    case 'm':
+      minimum = atoi(optarg)*1000000ULL;
+      break;
+    case 'r':
+      repeats = atoi(optarg) > 0 ? atoi(optarg) : 1;
+      break;
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+  const char* filter = optind < argc ? argv[optind] : NULL;
+
+  for(Benchmark* b = Benchmark::getFirst(); b != NULL; b = b->next){
+    if(filter != NULL && strstr(b->name, filter) == NULL)
+      continue;
+    for(int blocksize = MIN_BLOCKSIZE; blocksize <= AUDIO_MAX_BLOCK_SIZE; blocksize *= 2){
+      double fastest = 0.0;
+      bool skipped = false;
+      for(int i=0; i<repeats; ++i){
+	BenchmarkContext bench(blocksize, minimum);
+	b->function(bench);
+	skipped = bench.skipped;
+	if(skipped)
+	  break;
+	double ns = bench.getNanosecondsPerSample();
+	if(i == 0 || ns < fastest)
+	  fastest = ns;
+      }
+      if(skipped)
+	continue;
+      if(numberOfResults == MAX_RESULTS){
+	fprintf(stderr, "Too many results\n");
+	return -1;
+      }
+      BenchmarkResult& result = results[numberOfResults++];
+      strncpy(result.name, b->name, sizeof(result.name)-1);
+      result.name[sizeof(result.name)-1] = '\0';
+      result.blocksize = blocksize;
+      result.ns = fastest;
+      fprintf(stderr, "%-40s %5d %10.4f ns/sample\n", b->name, blocksize, fastest);
+    }
+  }
+
+  if(outfile != NULL){
+    FILE* fp = fopen(outfile, "w");
+    if(fp == NULL){
+      fprintf(stderr, "Failed to open %s\n", outfile);
+      return -1;
+    }
+    writeResults(fp);
+    fclose(fp);
+  }else{
+    writeResults(stdout);
+  }
+
+  if(baseline != NULL && compareResults(baseline, tolerance) != 0)
+    return 1;
+  return 0;
+}
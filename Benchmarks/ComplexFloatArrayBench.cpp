@@ -0,0 +1,51 @@
+#include "Benchmark.h"
+#include "ComplexFloatArray.h"
+
+static void fillNoise(ComplexFloatArray array){
+  for(int i=0; i<array.getSize(); ++i){
+    array[i].re = rand()/(float)RAND_MAX*2.0f - 1.0f;
+    array[i].im = rand()/(float)RAND_MAX*2.0f - 1.0f;
+  }
+}
+
+BENCHMARK(ComplexFloatArray_complexByComplexMultiplication){
+  ComplexFloatArray a = ComplexFloatArray::create(bench.blocksize);
+  ComplexFloatArray b = ComplexFloatArray::create(bench.blocksize);
+  ComplexFloatArray c = ComplexFloatArray::create(bench.blocksize);
+  fillNoise(a);
+  fillNoise(b);
+  while(bench.run()){
+    a.complexByComplexMultiplication(b, c);
+    bench.keep((float*)c);
+  }
+  ComplexFloatArray::destroy(a);
+  ComplexFloatArray::destroy(b);
+  ComplexFloatArray::destroy(c);
+}
+
+BENCHMARK(ComplexFloatArray_getMagnitudeValues){
+  ComplexFloatArray a = ComplexFloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    a.getMagnitudeValues(b);
+    bench.keep((float*)b);
+  }
+  ComplexFloatArray::destroy(a);
+  FloatArray::destroy(b);
+}
+
+BENCHMARK(ComplexFloatArray_add){
+  ComplexFloatArray a = ComplexFloatArray::create(bench.blocksize);
+  ComplexFloatArray b = ComplexFloatArray::create(bench.blocksize);
+  ComplexFloatArray c = ComplexFloatArray::create(bench.blocksize);
+  fillNoise(a);
+  fillNoise(b);
+  while(bench.run()){
+    a.add(b, c);
+    bench.keep((float*)c);
+  }
+  ComplexFloatArray::destroy(a);
+  ComplexFloatArray::destroy(b);
+  ComplexFloatArray::destroy(c);
+}
@@ -0,0 +1,36 @@
+#include "Benchmark.h"
+#include "FastFourierTransform.h"
+
+/* forward and inverse transform of one block, minimum FFT length is 32 */
+BENCHMARK(FastFourierTransform_fft){
+  if(bench.blocksize < 32)
+    return bench.skip();
+  FastFourierTransform fft(bench.blocksize);
+  FloatArray a = FloatArray::create(bench.blocksize);
+  ComplexFloatArray b = ComplexFloatArray::create(bench.blocksize);
+  for(int i=0; i<a.getSize(); ++i)
+    a[i] = rand()/(float)RAND_MAX*2.0f - 1.0f;
+  while(bench.run()){
+    fft.fft(a, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(a);
+  ComplexFloatArray::destroy(b);
+}
+
+BENCHMARK(FastFourierTransform_ifft){
+  if(bench.blocksize < 32)
+    return bench.skip();
+  FastFourierTransform fft(bench.blocksize);
+  FloatArray a = FloatArray::create(bench.blocksize);
+  ComplexFloatArray b = ComplexFloatArray::create(bench.blocksize);
+  for(int i=0; i<a.getSize(); ++i)
+    a[i] = rand()/(float)RAND_MAX*2.0f - 1.0f;
+  fft.fft(a, b);
+  while(bench.run()){
+    fft.ifft(b, a);
+    bench.keep((float*)a);
+  }
+  FloatArray::destroy(a);
+  ComplexFloatArray::destroy(b);
+}
@@ -0,0 +1,271 @@
+#include "Benchmark.h"
+#include "Patch.h"
+#include "BiquadFilter.h"
+#include "MultiBiquadFilter.h"
+#include "BiquadFilterBank.h"
+#include "MemoryBuffer.hpp"
+#include "FirFilter.h"
+#include "FirDecimator.h"
+#include "FirInterpolator.h"
+#include "PartitionedConvolver.h"
+#include "NonUniformConvolver.h"
+#include "Resample.h"
+
+// Patch.cpp, which defines it, is not linked
+AudioBuffer::~AudioBuffer(){}
+
+static void fillNoise(FloatArray array){
+  for(int i=0; i<array.getSize(); ++i)
+    array[i] = rand()/(float)RAND_MAX*2.0f - 1.0f;
+}
+
+/* four stage (8th order) low pass */
+BENCHMARK(BiquadFilter_process){
+  BiquadFilter* filter = BiquadFilter::create(4);
+  filter->setLowPass(0.2f, FilterStage::BUTTERWORTH_Q);
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    filter->process(a, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  BiquadFilter::destroy(filter);
+}
+
+/* the same four stage low pass on 2 and on 8 channels, with one filter per channel */
+BENCHMARK(BiquadFilter_process8){
+  BiquadFilter* filters[8];
+  FloatArray samples = FloatArray::create(8*bench.blocksize);
+  MemoryBuffer buffer(samples, 8, bench.blocksize);
+  for(int ch=0; ch<8; ch++){
+    filters[ch] = BiquadFilter::create(4);
+    filters[ch]->setLowPass(0.2f, FilterStage::BUTTERWORTH_Q);
+    fillNoise(buffer.getSamples(ch));
+  }
+  while(bench.run()){
+    for(int ch=0; ch<8; ch++)
+      filters[ch]->process(buffer.getSamples(ch));
+    bench.keep((float*)buffer.getSamples(0));
+  }
+  for(int ch=0; ch<8; ch++)
+    BiquadFilter::destroy(filters[ch]);
+  FloatArray::destroy(samples);
+}
+
+BENCHMARK(MultiBiquadFilter_process2){
+  MultiBiquadFilter* filter = MultiBiquadFilter::create(2, 4, bench.blocksize);
+  filter->setLowPass(0.2f, FilterStage::BUTTERWORTH_Q);
+  FloatArray samples = FloatArray::create(2*bench.blocksize);
+  MemoryBuffer buffer(samples, 2, bench.blocksize);
+  fillNoise(buffer.getSamples(0));
+  fillNoise(buffer.getSamples(1));
+  while(bench.run()){
+    filter->process(buffer);
+    bench.keep((float*)buffer.getSamples(0));
+  }
+  MultiBiquadFilter::destroy(filter);
+  FloatArray::destroy(samples);
+}
+
+BENCHMARK(MultiBiquadFilter_process8){
+  MultiBiquadFilter* filter = MultiBiquadFilter::create(8, 4, bench.blocksize);
+  filter->setLowPass(0.2f, FilterStage::BUTTERWORTH_Q);
+  FloatArray samples = FloatArray::create(8*bench.blocksize);
+  MemoryBuffer buffer(samples, 8, bench.blocksize);
+  for(int ch=0; ch<8; ch++)
+    fillNoise(buffer.getSamples(ch));
+  while(bench.run()){
+    filter->process(buffer);
+    bench.keep((float*)buffer.getSamples(0));
+  }
+  MultiBiquadFilter::destroy(filter);
+  FloatArray::destroy(samples);
+}
+
+/* a 32 band vocoder synthesis bank, summed, with a filter per band or as one bank */
+BENCHMARK(BiquadFilter_processBands){
+  const int bands = 32;
+  BiquadFilter* filters[bands];
+  for(int b=0; b<bands; b++){
+    filters[b] = BiquadFilter::create(1);
+    filters[b]->setBandPass(0.005f*powf(100, b/(float)(bands-1)), 8);
+  }
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  FloatArray c = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    b.clear();
+    for(int i=0; i<bands; i++){
+      c.copyFrom(a);
+      filters[i]->process(c);
+      b.add(c);
+    }
+    bench.keep((float*)b);
+  }
+  for(int i=0; i<bands; i++)
+    BiquadFilter::destroy(filters[i]);
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FloatArray::destroy(c);
+}
+
+BENCHMARK(BiquadFilterBank_process){
+  BiquadFilterBank* bank = BiquadFilterBank::create(32, bench.blocksize);
+  bank->setBandPasses(0.005f, 0.5f, 8);
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    bank->process(a, b);
+    bench.keep((float*)b);
+  }
+  BiquadFilterBank::destroy(bank);
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+}
+
+BENCHMARK(FirFilter_processBlock){
+  const int taps = 64;
+  FirFilter* filter = FirFilter::create(taps, bench.blocksize);
+  FloatArray coefficients = filter->getCoefficients();
+  for(int i=0; i<taps; ++i)
+    coefficients[i] = 1.0f/taps;
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    filter->processBlock(a, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FirFilter::destroy(filter);
+}
+
+/* 64 tap lowpass, down and back up by 4 */
+BENCHMARK(FirDecimator_processBlock){
+  FirDecimator* filter = FirDecimator::create(4, 64, bench.blocksize);
+  filter->setLowPass(0.2f);
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize/4);
+  fillNoise(a);
+  while(bench.run()){
+    filter->processBlock(a, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FirDecimator::destroy(filter);
+}
+
+BENCHMARK(FirInterpolator_processBlock){
+  FirInterpolator* filter = FirInterpolator::create(4, 64, bench.blocksize/4);
+  filter->setLowPass(0.2f);
+  FloatArray a = FloatArray::create(bench.blocksize/4);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    filter->processBlock(a, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FirInterpolator::destroy(filter);
+}
+
+/* a 2048 tap impulse response, as a FIR and partitioned in the frequency domain */
+BENCHMARK(FirFilter_processBlockLong){
+  const int taps = 2048;
+  FirFilter* filter = FirFilter::create(taps, bench.blocksize);
+  fillNoise(filter->getCoefficients());
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    filter->processBlock(a, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FirFilter::destroy(filter);
+}
+
+BENCHMARK(PartitionedConvolver_process){
+  const int taps = 2048;
+  PartitionedConvolver* convolver = PartitionedConvolver::create(bench.blocksize, taps);
+  FloatArray impulse = FloatArray::create(taps);
+  fillNoise(impulse);
+  convolver->setImpulseResponse(impulse);
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    convolver->process(a, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(impulse);
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  PartitionedConvolver::destroy(convolver);
+}
+
+/* a 16384 tap impulse response, a third of a second at 48kHz */
+BENCHMARK(PartitionedConvolver_processLong){
+  const int taps = 16384;
+  PartitionedConvolver* convolver = PartitionedConvolver::create(bench.blocksize, taps);
+  FloatArray impulse = FloatArray::create(taps);
+  fillNoise(impulse);
+  convolver->setImpulseResponse(impulse);
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    convolver->process(a, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(impulse);
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  PartitionedConvolver::destroy(convolver);
+}
+
+BENCHMARK(NonUniformConvolver_processLong){
+  const int taps = 16384;
+  NonUniformConvolver* convolver = NonUniformConvolver::create(bench.blocksize, taps);
+  FloatArray impulse = FloatArray::create(taps);
+  fillNoise(impulse);
+  convolver->setImpulseResponse(impulse);
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    convolver->process(a, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(impulse);
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  NonUniformConvolver::destroy(convolver);
+}
+
+/* 4x oversampling round trip, as around a waveshaper */
+BENCHMARK(Resampler_4x){
+  Resampler* resampler = Resampler::create(4, bench.blocksize);
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray up = FloatArray::create(4*bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    resampler->upsample(a, up);
+    resampler->downsample(up, b);
+    bench.keep((float*)b);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(up);
+  FloatArray::destroy(b);
+  Resampler::destroy(resampler);
+}
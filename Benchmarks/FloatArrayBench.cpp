@@ -0,0 +1,240 @@
+#include "Benchmark.h"
+#include "FloatArray.h"
+#include "FloatExpression.h"
+
+static void fillNoise(FloatArray array){
+  for(int i=0; i<array.getSize(); ++i)
+    array[i] = rand()/(float)RAND_MAX*2.0f - 1.0f;
+}
+
+// results go to a separate array so that repeated iterations don't decay into denormals
+BENCHMARK(FloatArray_multiply){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  FloatArray c = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  fillNoise(b);
+  while(bench.run()){
+    a.multiply(b, c);
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FloatArray::destroy(c);
+}
+
+BENCHMARK(FloatArray_multiplyScalar){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray c = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    a.multiply(0.5f, c);
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(c);
+}
+
+BENCHMARK(FloatArray_add){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  FloatArray c = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  fillNoise(b);
+  while(bench.run()){
+    a.add(b, c);
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FloatArray::destroy(c);
+}
+
+BENCHMARK(FloatArray_getRms){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run())
+    bench.keep(a.getRms());
+  FloatArray::destroy(a);
+}
+
+BENCHMARK(FloatArray_getMax){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run())
+    bench.keep(a.getMaxValue());
+  FloatArray::destroy(a);
+}
+
+BENCHMARK(FloatArray_clip){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray c = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  while(bench.run()){
+    c.copyFrom(a);
+    c.clip(0.5f);
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(c);
+}
+
+/* output = clip(a*gain + b*mix), as separate passes and as one expression */
+BENCHMARK(FloatArray_mixChained){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  FloatArray c = FloatArray::create(bench.blocksize);
+  FloatArray tmp = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  fillNoise(b);
+  while(bench.run()){
+    a.multiply(0.8f, c);
+    b.multiply(0.6f, tmp);
+    c.add(tmp);
+    c.clip();
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FloatArray::destroy(c);
+  FloatArray::destroy(tmp);
+}
+
+BENCHMARK(FloatArray_mixExpression){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  FloatArray c = FloatArray::create(bench.blocksize);
+  fillNoise(a);
+  fillNoise(b);
+  while(bench.run()){
+    c = clip(a*0.8f + b*0.6f);
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FloatArray::destroy(c);
+}
+
+/* convolution of a block with a 32 tap kernel, as used for short FIRs */
+BENCHMARK(FloatArray_convolve){
+  const int kernel = 32;
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(kernel);
+  FloatArray c = FloatArray::create(bench.blocksize+kernel-1);
+  fillNoise(a);
+  fillNoise(b);
+  while(bench.run()){
+    a.convolve(b, c);
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FloatArray::destroy(c);
+}
+
+/*
+ * a 4096 sample signal convolved with a kernel of blocksize taps, directly
+ * and with the FFT, to find the kernel length from which fftConvolve() is faster
+ */
+BENCHMARK(FloatArray_convolveDirect){
+  const int length = 4096;
+  FloatArray a = FloatArray::create(length);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  FloatArray c = FloatArray::create(length+bench.blocksize-1);
+  fillNoise(a);
+  fillNoise(b);
+  bench.items = length;
+  while(bench.run()){
+    a.convolve(b, c);
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FloatArray::destroy(c);
+}
+
+BENCHMARK(FloatArray_convolveFft){
+  const int length = 4096;
+  FloatArray a = FloatArray::create(length);
+  FloatArray b = FloatArray::create(bench.blocksize);
+  FloatArray c = FloatArray::create(length+bench.blocksize-1);
+  fillNoise(a);
+  fillNoise(b);
+  bench.items = length;
+  while(bench.run()){
+    a.fftConvolve(b, c);
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FloatArray::destroy(c);
+}
+
+BENCHMARK(FloatArray_correlate){
+  const int kernel = 32;
+  FloatArray a = FloatArray::create(bench.blocksize);
+  FloatArray b = FloatArray::create(kernel);
+  FloatArray c = FloatArray::create(bench.blocksize+kernel-1);
+  fillNoise(a);
+  fillNoise(b);
+  while(bench.run()){
+    a.correlate(b, c);
+    bench.keep((float*)c);
+  }
+  FloatArray::destroy(a);
+  FloatArray::destroy(b);
+  FloatArray::destroy(c);
+}
+
+BENCHMARK(FloatArray_ramp){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  while(bench.run()){
+    a.ramp(0.25f, 0.75f);
+    bench.keep((float*)a);
+  }
+  FloatArray::destroy(a);
+}
+
+BENCHMARK(FloatArray_expRamp){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  while(bench.run()){
+    a.expRamp(0.25f, 0.75f);
+    bench.keep((float*)a);
+  }
+  FloatArray::destroy(a);
+}
+
+/* the approximations against per sample calls to libm */
+#define FLOAT_ARRAY_FUNCTION_BENCHMARK(method, function, offset)	\
+  BENCHMARK(FloatArray_##method){					\
+    FloatArray a = FloatArray::create(bench.blocksize);			\
+    FloatArray b = FloatArray::create(bench.blocksize);			\
+    fillNoise(a);							\
+    a.add(offset);							\
+    while(bench.run()){							\
+      a.method(b);							\
+      bench.keep((float*)b);						\
+    }									\
+    FloatArray::destroy(a);						\
+    FloatArray::destroy(b);						\
+  }									\
+  BENCHMARK(FloatArray_##method##Libm){					\
+    FloatArray a = FloatArray::create(bench.blocksize);			\
+    FloatArray b = FloatArray::create(bench.blocksize);			\
+    fillNoise(a);							\
+    a.add(offset);							\
+    while(bench.run()){							\
+      for(int i=0; i<a.getSize(); ++i)					\
+	b[i] = function(a[i]);						\
+      bench.keep((float*)b);						\
+    }									\
+    FloatArray::destroy(a);						\
+    FloatArray::destroy(b);						\
+  }
+
+FLOAT_ARRAY_FUNCTION_BENCHMARK(sine, sinf, 0.0f)
+FLOAT_ARRAY_FUNCTION_BENCHMARK(hyperbolicTangent, tanhf, 0.0f)
+FLOAT_ARRAY_FUNCTION_BENCHMARK(exp, expf, 0.0f)
+FLOAT_ARRAY_FUNCTION_BENCHMARK(log2, log2f, 2.0f)
+
+#undef FLOAT_ARRAY_FUNCTION_BENCHMARK
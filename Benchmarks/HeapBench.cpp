@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include "Benchmark.h"
+#include "heap.h"
+
+/*
+ * Replays allocation traces, recorded from patches with the renderer's -a
+ * option, against the heap selected with HEAP, e.g.
+ * make HEAP=heap_tlsf bench BENCH_FILTER=Heap
+ * The traces were recorded at the default block size of 128, so they are
+ * only replayed at that size. Results are in ns per allocation or free.
+ */
+
+#undef malloc
+#undef free
+
+#define TRACE_BLOCKSIZE  128
+
+struct TraceOperation {
+  int id;
+  int size; // -1 to free
+  int region;
+};
+
+struct Trace {
+  TraceOperation* operations;
+  int size;
+  int blocks;
+};
+
+static bool readTrace(const char* name, Trace& trace){
+  char filename[256];
+  snprintf(filename, sizeof(filename), "%s/%s.trace", BENCH_TRACES, name);
+  FILE* fp = fopen(filename, "r");
+  if(fp == NULL){
+    fprintf(stderr, "Failed to open %s\n", filename);
+    return false;
+  }
+  int capacity = 1024;
+  trace.operations = (TraceOperation*)malloc(capacity*sizeof(TraceOperation));
+  trace.size = 0;
+  trace.blocks = 0;
+  char line[64];
+  while(fgets(line, sizeof(line), fp) != NULL){
+    TraceOperation op;
+    if(sscanf(line, "m %d %d %d", &op.id, &op.size, &op.region) == 3){
+      trace.blocks = max(trace.blocks, op.id+1);
+    }else if(sscanf(line, "f %d", &op.id) == 1){
+      op.size = -1;
+    }else{
+      continue;
+    }
+    if(trace.size == capacity){
+      capacity *= 2;
+      trace.operations = (TraceOperation*)realloc(trace.operations, capacity*sizeof(TraceOperation));
+    }
+    trace.operations[trace.size++] = op;
+  }
+  fclose(fp);
+  return true;
+}
+
+static void replayTrace(BenchmarkContext& bench, const char* name){
+  Trace trace;
+  if(bench.blocksize != TRACE_BLOCKSIZE || !readTrace(name, trace)){
+    bench.skip();
+    return;
+  }
+  void** blocks = (void**)calloc(trace.blocks, sizeof(void*));
+  // blocks that are still allocated at the end of the trace are freed
+  // after each replay, so that every replay starts with the same heap
+  bench.items = trace.size;
+  for(int i=0; i<trace.size; ++i)
+    bench.items += trace.operations[i].size < 0 ? -1 : 1;
+  while(bench.run()){
+    for(int i=0; i<trace.size; ++i){
+      TraceOperation& op = trace.operations[i];
+      if(op.size < 0){
+	vPortFree(blocks[op.id]);
+	blocks[op.id] = NULL;
+      }else{
+	void* ptr = NULL;
+	if(op.region >= 0)
+	  ptr = pvPortMallocFrom(op.size, op.region);
+	if(ptr == NULL)
+	  ptr = pvPortMalloc(op.size);
+	blocks[op.id] = ptr;
+      }
+    }
+    for(int i=0; i<trace.blocks; ++i){
+      vPortFree(blocks[i]);
+      blocks[i] = NULL;
+    }
+  }
+  free(blocks);
+  free(trace.operations);
+}
+
+/* LibSource FFT, filters and oscillators, with a temporary array in each block */
+BENCHMARK(Heap_spectral){
+  replayTrace(bench, "spectral");
+}
+
+/* Gen style construction: buffers are replaced once resized, leaving small holes */
+BENCHMARK(Heap_gen){
+  replayTrace(bench, "gen");
+}
+
+/* Heavy style: small objects, then messages allocated and freed in each block */
+BENCHMARK(Heap_heavy){
+  replayTrace(bench, "heavy");
+}
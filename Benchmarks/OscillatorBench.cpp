@@ -0,0 +1,46 @@
+#include "Benchmark.h"
+#include "SineOscillator.h"
+#include "ChirpOscillator.h"
+#include "NoiseOscillator.h"
+#include "PolyBlepOscillator.h"
+#include "WavetableOscillator.h"
+
+static void runOscillator(BenchmarkContext& bench, Oscillator* osc){
+  FloatArray a = FloatArray::create(bench.blocksize);
+  osc->setFrequency(440.0f);
+  while(bench.run()){
+    osc->getSamples(a);
+    bench.keep((float*)a);
+  }
+  FloatArray::destroy(a);
+}
+
+BENCHMARK(SineOscillator_getSamples){
+  SineOscillator* osc = SineOscillator::create(48000);
+  runOscillator(bench, osc);
+  delete osc;
+}
+
+BENCHMARK(ChirpOscillator_getSamples){
+  ChirpOscillator* osc = ChirpOscillator::create(48000);
+  runOscillator(bench, osc);
+  delete osc;
+}
+
+BENCHMARK(WhiteNoiseOscillator_getSamples){
+  WhiteNoiseOscillator* osc = WhiteNoiseOscillator::create();
+  runOscillator(bench, osc);
+  delete osc;
+}
+
+BENCHMARK(PolyBlepOscillator_getSamples){
+  PolyBlepOscillator* osc = PolyBlepOscillator::create(48000);
+  runOscillator(bench, osc);
+  PolyBlepOscillator::destroy(osc);
+}
+
+BENCHMARK(WavetableOscillator_getSamples){
+  WavetableOscillator* osc = WavetableOscillator::create(48000, 1024);
+  runOscillator(bench, osc);
+  WavetableOscillator::destroy(osc);
+}
@@ -0,0 +1,104 @@
+#include "Benchmark.h"
+#include "SampleConversion.h"
+#include "device.h"
+
+/* the codec buffer holds two channels of two 16-bit words per sample */
+static int16_t frames[AUDIO_MAX_BLOCK_SIZE*4];
+static float left[AUDIO_MAX_BLOCK_SIZE];
+static float right[AUDIO_MAX_BLOCK_SIZE];
+
+static void fillFrames(int blocksize){
+  for(int i=0; i<blocksize*4; ++i)
+    frames[i] = rand() & 0xff00;
+}
+
+BENCHMARK(SampleConversion_split24be){
+  fillFrames(bench.blocksize);
+  while(bench.run()){
+    sample_split24be(frames, left, right, bench.blocksize);
+    bench.keep(left);
+  }
+}
+
+BENCHMARK(SampleConversion_comb24be){
+  fillFrames(bench.blocksize);
+  sample_split24be(frames, left, right, bench.blocksize);
+  while(bench.run()){
+    sample_comb24be(left, right, frames, bench.blocksize);
+    bench.keep(left);
+  }
+}
+
+BENCHMARK(SampleConversion_split24le){
+  fillFrames(bench.blocksize);
+  while(bench.run()){
+    sample_split24le(frames, left, right, bench.blocksize);
+    bench.keep(left);
+  }
+}
+
+BENCHMARK(SampleConversion_comb24le){
+  fillFrames(bench.blocksize);
+  sample_split24le(frames, left, right, bench.blocksize);
+  while(bench.run()){
+    sample_comb24le(left, right, frames, bench.blocksize);
+    bench.keep(left);
+  }
+}
+
+/* one frame at a time, for comparison with the vector kernels */
+BENCHMARK(SampleConversion_split24be_scalar){
+  fillFrames(bench.blocksize);
+  while(bench.run()){
+    for(int i=0; i<bench.blocksize; ++i)
+      sample_split24be_frame(frames+i*4, left+i, right+i);
+    bench.keep(left);
+  }
+}
+
+BENCHMARK(SampleConversion_comb24be_scalar){
+  fillFrames(bench.blocksize);
+  sample_split24be(frames, left, right, bench.blocksize);
+  while(bench.run()){
+    for(int i=0; i<bench.blocksize; ++i)
+      sample_comb24be_frame(left[i], right[i], frames+i*4);
+    bench.keep(left);
+  }
+}
+
+/* saturated output, with overs in the signal so that clipping actually happens */
+static void fillOvers(int blocksize){
+  for(int i=0; i<blocksize; ++i){
+    left[i] = rand()/(float)RAND_MAX*3.0f - 1.5f;
+    right[i] = rand()/(float)RAND_MAX*3.0f - 1.5f;
+  }
+}
+
+BENCHMARK(SampleConversion_comb24be_saturate){
+  fillOvers(bench.blocksize);
+  while(bench.run()){
+    sample_comb24be_saturate(left, right, frames, bench.blocksize);
+    bench.keep(frames);
+  }
+}
+
+/* previous saturating loop: per sample 64-bit clip, as clip_q63_to_q31() in CMSIS */
+static inline int32_t clip_q63(int64_t x){
+  return ((int32_t)(x >> 32) != ((int32_t)x >> 31)) ? ((INT32_MAX ^ ((int32_t)(x >> 63)))) : (int32_t)x;
+}
+
+BENCHMARK(SampleConversion_comb24be_clip_q63){
+  fillOvers(bench.blocksize);
+  while(bench.run()){
+    int16_t* dst = frames;
+    for(int i=0; i<bench.blocksize; ++i){
+      int32_t qint = clip_q63((int64_t)(left[i] * 2147483648.0f));
+      *dst++ = qint >> 16;
+      *dst++ = qint & 0xffff;
+      qint = clip_q63((int64_t)(right[i] * 2147483648.0f));
+      *dst++ = qint >> 16;
+      *dst++ = qint & 0xffff;
+    }
+    bench.keep(frames);
+  }
+}
@@ -0,0 +1,703 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "ProgramVector.h"
+#include "Patch.h"
+#include "device.h"
+#include "main.h"
+#include "message.h"
+#include "ServiceCall.h"
+#include "heap.h"
+#include "heap_stats.h"
+#include "MemoryHint.h"
+
+// the renderer's own buffers use the system allocator, outside the simulated heap
+#undef malloc
+#undef free
+
+/*
+ * Native offline patch renderer.
+ * Streams a WAV file through setup() and processBlock(), exactly as the
+ * firmware would with a stand-in ProgramVector, and times every block.
+ */
+
+#define NOF_PARAMETERS 40
+#define NOF_CHANNELS   2
+
+ProgramVector programVector;
+
+static int16_t parameters[NOF_PARAMETERS];
+static bool overridden[NOF_PARAMETERS]; // set with -p
+static const char* parameterNames[NOF_PARAMETERS];
+static const char* patchName = NULL;
+static char messageBuffer[128];
+static bool verbose = false;
+
+extern "C" {
+  void registerPatch(const char* name, uint8_t inputChannels, uint8_t outputChannels);
+  void registerPatchParameter(uint8_t id, const char* name);
+  void programReady();
+  void programStatus(ProgramVectorAudioStatus status);
+  int serviceCall(int service, void** params, int len);
+  void setButton(uint8_t id, uint16_t state, uint16_t samples);
+  void setPatchParameter(uint8_t id, int16_t value);
+  void vApplicationMallocFailedHook( void );
+}
+
+void registerPatch(const char* name, uint8_t inputChannels, uint8_t outputChannels){
+  patchName = name;
+}
+
+void registerPatchParameter(uint8_t pid, const char* name){
+  if(pid < NOF_PARAMETERS)
+    parameterNames[pid] = name;
+}
+
+void programReady(){}
+
+void programStatus(ProgramVectorAudioStatus status){
+  if(status == AUDIO_ERROR_STATUS){
+    ProgramVector* pv = getProgramVector();
+    fprintf(stderr, "Program error %d: %s\n", pv->error, pv->message ? pv->message : "");
+    exit(-1);
+  }
+}
+
+int serviceCall(int service, void** params, int len){
+  return OWL_SERVICE_INVALID_ARGS;
+}
+
+void setButton(uint8_t id, uint16_t state, uint16_t samples){
+  ProgramVector* pv = getProgramVector();
+  if(id < 16){
+    if(state)
+      pv->buttons |= 1<<id;
+    else
+      pv->buttons &= ~(1<<id);
+  }
+}
+
+void setPatchParameter(uint8_t id, int16_t value){
+  if(id < NOF_PARAMETERS)
+    parameters[id] = value;
+}
+
+/*
+ * Simulated heap: the patch allocates from heap_5 with the same three
+ * regions as the firmware, in address order, so that memory hints and
+ * out of memory errors behave as they would on the device. The internal
+ * SRAM region is sized for a small program; on the device it is whatever
+ * the program leaves of the patch RAM.
+ */
+#define FAST_HEAP_SIZE   (32*1024)
+#define NORMAL_HEAP_SIZE (56*1024)
+#define BULK_HEAP_SIZE   (1024*1024)
+#define NOF_HEAP_REGIONS 3
+
+static struct {
+  uint8_t fast[FAST_HEAP_SIZE];
+  uint8_t normal[NORMAL_HEAP_SIZE];
+  uint8_t bulk[BULK_HEAP_SIZE];
+} heap __attribute__ ((aligned (8)));
+
+static const char* heapRegionNames[NOF_HEAP_REGIONS] = { "fast", "normal", "bulk" };
+static const size_t heapRegionSizes[NOF_HEAP_REGIONS] = { FAST_HEAP_SIZE, NORMAL_HEAP_SIZE, BULK_HEAP_SIZE };
+static size_t heapRegionFree[NOF_HEAP_REGIONS];
+
+// define the regions before any static initialisers run, as main.cpp does
+__attribute__ ((constructor (101)))
+static void defineHeapRegions(){
+  const HeapRegion_t xHeapRegions[] = {
+    { heap.fast, FAST_HEAP_SIZE },
+    { heap.normal, NORMAL_HEAP_SIZE },
+    { heap.bulk, BULK_HEAP_SIZE },
+    { NULL, 0 } /* Terminates the array. */
+  };
+  vPortDefineHeapRegions(xHeapRegions);
+  for(int i=0; i<NOF_HEAP_REGIONS; ++i)
+    heapRegionFree[i] = xPortGetFreeRegionSize(i);
+}
+
+void vApplicationMallocFailedHook( void ){
+  error(0x60, pcHeapStatsSummary());
+}
+
+void * operator new(size_t size) { traceHEAP_SITE(); return pvPortMalloc(size); }
+void * operator new[](size_t size) { traceHEAP_SITE(); return pvPortMalloc(size); }
+void operator delete(void* ptr) { vPortFree(ptr); }
+void operator delete[](void * ptr) { vPortFree(ptr); }
+
+/*
+ * Allocation trace, written with -a and replayed by the heap benchmarks.
+ * Each allocation is given an id, in order, and written as
+ * "m id size region", with region -1 for no hint. Frees are written as
+ * "f id". Failed allocations, such as the regions tried in turn by
+ * allocateMemory(), are not recorded.
+ * Every allocation is also counted by heap_stats.c, for the heap report.
+ */
+struct TraceBlock {
+  void* ptr;
+  int id;
+};
+static FILE* traceFile = NULL;
+static TraceBlock* traceBlocks = NULL;
+static int traceLive = 0;
+static int traceCapacity = 0;
+static int traceCount = 0;
+
+void vHeapTraceMalloc( void *pv, size_t xWantedSize, BaseType_t xRegion, const void *pvSite ){
+  vHeapStatsMalloc(pv, xWantedSize, xRegion, pvSite);
+  if(traceFile == NULL || pv == NULL)
+    return;
+  if(traceLive == traceCapacity){
+    traceCapacity = traceCapacity ? traceCapacity*2 : 256;
+    traceBlocks = (TraceBlock*)realloc(traceBlocks, traceCapacity*sizeof(TraceBlock));
+  }
+  traceBlocks[traceLive].ptr = pv;
+  traceBlocks[traceLive].id = traceCount;
+  traceLive++;
+  fprintf(traceFile, "m %d %zu %ld\n", traceCount++, xWantedSize, (long)xRegion);
+}
+
+void vHeapTraceFree( void *pv ){
+  vHeapStatsFree(pv);
+  if(traceFile == NULL)
+    return;
+  // recent allocations are the most likely to be freed
+  for(int i=traceLive-1; i>=0; --i){
+    if(traceBlocks[i].ptr == pv){
+      fprintf(traceFile, "f %d\n", traceBlocks[i].id);
+      traceBlocks[i] = traceBlocks[--traceLive];
+      return;
+    }
+  }
+}
+
+/*
+ * External SRAM is several times slower than internal memory, while on the
+ * host all three regions are equally fast. To approximate the cost of
+ * accessing it, the bulk region is evicted from the host caches before
+ * each timed block if the patch has allocated from it. The fast and normal
+ * regions are both internal memory and are left alone. Cache lines are
+ * flushed with the SSE2 instructions, so this is a no-op on other hosts.
+ */
+static void evictBulkMemory(){
+#ifdef __SSE2__
+  if(xPortGetFreeRegionSize(MEMORY_BULK) == heapRegionFree[MEMORY_BULK])
+    return;
+  for(size_t i=0; i<BULK_HEAP_SIZE; i+=64)
+    _mm_clflush(heap.bulk+i);
+  _mm_mfence();
+#endif
+}
+
+/*
+ * Allocations by call site, or by MemoryTag, largest peak first. Sites are
+ * return addresses, named with the nearest exported symbol.
+ */
+static void printHeapSites(){
+  const HeapSiteStats_t* sites[HEAP_STATS_MAX_SITES];
+  int count = 0;
+  while(count < HEAP_STATS_MAX_SITES && (sites[count] = pxHeapStatsGetSite(count)) != NULL)
+    count++;
+  for(int i=1; i<count; ++i)
+    for(int j=i; j>0 && sites[j]->xPeakBytes > sites[j-1]->xPeakBytes; --j){
+      const HeapSiteStats_t* site = sites[j];
+      sites[j] = sites[j-1];
+      sites[j-1] = site;
+    }
+  for(int i=0; i<count; ++i){
+    char name[64];
+    Dl_info info;
+    if(sites[i]->pcTag != NULL){
+      snprintf(name, sizeof(name), "%s", sites[i]->pcTag);
+    }else if(dladdr(sites[i]->pvSite, &info) && info.dli_sname != NULL){
+      char* demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, NULL);
+      snprintf(name, sizeof(name), "%s+0x%zx", demangled ? demangled : info.dli_sname,
+	       (size_t)((const char*)sites[i]->pvSite - (const char*)info.dli_saddr));
+      free(demangled);
+    }else{
+      snprintf(name, sizeof(name), "%p", sites[i]->pvSite);
+    }
+    printf("  %-40s bytes %zu peak %zu allocations %u\n", name,
+	   sites[i]->xBytes, sites[i]->xPeakBytes, sites[i]->ulAllocations);
+  }
+}
+
+static void printHeapStats(){
+  const HeapStats_t* stats = pxHeapStatsGet();
+  size_t heapSize = 0;
+  for(int i=0; i<NOF_HEAP_REGIONS; ++i)
+    heapSize += heapRegionFree[i];
+  printf("Heap peak: requested %zu allocated %zu\n", stats->xPeakBytes,
+	 heapSize - xPortGetMinimumEverFreeHeapSize());
+  printf("Heap allocations %u frees %u", stats->ulAllocations, stats->ulFrees);
+  if(stats->ulUntracked)
+    printf(" untracked %u", stats->ulUntracked);
+  printf("\n");
+  printHeapSites();
+  HeapRegionStats_t regions[NOF_HEAP_REGIONS];
+  uint32_t histogram[HEAP_STATS_HISTOGRAM_BINS];
+  vHeapStatsGetFreeBlocks(regions, NOF_HEAP_REGIONS, histogram);
+  for(int i=0; i<NOF_HEAP_REGIONS; ++i){
+    HeapRegionStats_t& region = regions[i];
+    printf("  %-6s free blocks %u largest %zu fragmentation %.1f%%\n", heapRegionNames[i],
+	   region.ulFreeBlocks, region.xLargestFreeBlock, region.xFreeBytes ?
+	   100.0*(1.0 - (double)region.xLargestFreeBlock/region.xFreeBytes) : 0.0);
+  }
+  printf("Free blocks by size:");
+  for(int i=0; i<HEAP_STATS_HISTOGRAM_BINS; ++i)
+    if(histogram[i])
+      printf(" %s%zu:%u", i ? ">=" : "<", i ? (size_t)16<<i : (size_t)32, histogram[i]);
+  printf("\n");
+}
+
+static void setMessage(const char* fmt, ...){
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(messageBuffer, sizeof(messageBuffer), fmt, args);
+  va_end(args);
+  getProgramVector()->message = messageBuffer;
+  if(verbose)
+    fprintf(stderr, "%s\n", messageBuffer);
+}
+
+void debugMessage(const char* msg){
+  setMessage("%s", msg);
+}
+
+void debugMessage(const char* msg, int a){
+  setMessage("%s %d", msg, a);
+}
+
+void debugMessage(const char* msg, int a, int b, int c){
+  setMessage("%s %d %d %d", msg, a, b, c);
+}
+
+void debugMessage(const char* msg, float a){
+  setMessage("%s %f", msg, a);
+}
+
+void debugMessage(const char* msg, float a, float b){
+  setMessage("%s %f %f", msg, a, b);
+}
+
+void debugMessage(const char* msg, float a, float b, float c){
+  setMessage("%s %f %f %f", msg, a, b, c);
+}
+
+void error(int8_t code, const char* reason){
+  ProgramVector* pv = getProgramVector();
+  pv->error = code;
+  pv->message = (char*)reason;
+  programStatus(AUDIO_ERROR_STATUS);
+}
+
+void assert_failed(const char* msg, const char* location, int line){
+  setMessage("%s in %s line %d", msg, location, line);
+  programStatus(AUDIO_ERROR_STATUS);
+}
+
+void assert_failed(uint8_t* location, uint32_t line){
+  assert_failed("Assertion Failed", (const char*)location, line);
+}
+
+/* WAV file input and output */
+
+struct WavData {
+  int channels;
+  int frames;
+  uint32_t samplerate;
+  float* samples; // interleaved
+};
+
+static uint32_t readLE(const uint8_t* p, int bytes){
+  uint32_t value = 0;
+  for(int i=0; i<bytes; ++i)
+    value |= (uint32_t)p[i] << (8*i);
+  return value;
+}
+
+static void writeLE(FILE* fp, uint32_t value, int bytes){
+  for(int i=0; i<bytes; ++i)
+    fputc((value >> (8*i)) & 0xff, fp);
+}
+
+static bool readWav(const char* filename, WavData& wav){
+  FILE* fp = fopen(filename, "rb");
+  if(fp == NULL){
+    fprintf(stderr, "Failed to open %s\n", filename);
+    return false;
+  }
+  fseek(fp, 0, SEEK_END);
+  long len = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  uint8_t* data = len < 12 ? NULL : (uint8_t*)malloc(len);
+  if(data == NULL || fread(data, 1, len, fp) != (size_t)len ||
+     memcmp(data, "RIFF", 4) != 0 || memcmp(data+8, "WAVE", 4) != 0){
+    fprintf(stderr, "Not a WAV file: %s\n", filename);
+    fclose(fp);
+    free(data);
+    return false;
+  }
+  fclose(fp);
+  int format = 0, bits = 0;
+  const uint8_t* pcm = NULL;
+  uint32_t pcmsize = 0;
+  wav.channels = 0;
+  wav.samplerate = 0;
+  long pos = 12;
+  while(pos + 8 <= len){
+    const uint8_t* chunk = data+pos;
+    uint32_t size = readLE(chunk+4, 4);
+    bool truncated = size > (uint32_t)(len-pos-8);
+    if(memcmp(chunk, "fmt ", 4) == 0 && size >= 16){
+      if(truncated){
+	fprintf(stderr, "Truncated WAV file: %s\n", filename);
+	free(data);
+	return false;
+      }
+      format = readLE(chunk+8, 2);
+      wav.channels = readLE(chunk+10, 2);
+      wav.samplerate = readLE(chunk+12, 4);
+      bits = readLE(chunk+22, 2);
+      if(format == 0xfffe && size >= 40) // WAVE_FORMAT_EXTENSIBLE: use sub format
+	format = readLE(chunk+32, 2);
+    }else if(memcmp(chunk, "data", 4) == 0){
+      pcm = chunk+8;
+      pcmsize = min(size, (uint32_t)(len-pos-8));
+    }
+    if(truncated)
+      break;
+    pos += 8 + size + (size & 1);
+  }
+  int bytes = bits/8;
+  if(pcm == NULL || wav.channels == 0 || wav.samplerate == 0 ||
+     !((format == 1 && (bits == 16 || bits == 24 || bits == 32)) ||
+       (format == 3 && bits == 32))){
+    fprintf(stderr, "Unsupported WAV format %d/%d bits: %s\n", format, bits, filename);
+    free(data);
+    return false;
+  }
+  wav.frames = pcmsize/(bytes*wav.channels);
+  wav.samples = (float*)malloc(wav.frames*wav.channels*sizeof(float));
+  for(int i=0; i<wav.frames*wav.channels; ++i){
+    uint32_t raw = readLE(pcm+i*bytes, bytes);
+    if(format == 3){
+      union { uint32_t i; float f; } u = { raw };
+      wav.samples[i] = u.f;
+    }else{
+      int32_t value = raw << (32-bits); // left justify to sign extend
+      wav.samples[i] = value / 2147483648.0f;
+    }
+  }
+  free(data);
+  return true;
+}
+
+static bool writeWav(const char* filename, WavData& wav, bool useFloat){
+  FILE* fp = fopen(filename, "wb");
+  if(fp == NULL){
+    fprintf(stderr, "Failed to open %s\n", filename);
+    return false;
+  }
+  int bytes = useFloat ? 4 : 3;
+  uint32_t datasize = wav.frames*wav.channels*bytes;
+  fwrite("RIFF", 1, 4, fp);
+  writeLE(fp, 36 + datasize + (datasize & 1), 4);
+  fwrite("WAVEfmt ", 1, 8, fp);
+  writeLE(fp, 16, 4);
+  writeLE(fp, useFloat ? 3 : 1, 2);
+  writeLE(fp, wav.channels, 2);
+  writeLE(fp, wav.samplerate, 4);
+  writeLE(fp, wav.samplerate*wav.channels*bytes, 4);
+  writeLE(fp, wav.channels*bytes, 2);
+  writeLE(fp, bytes*8, 2);
+  fwrite("data", 1, 4, fp);
+  writeLE(fp, datasize, 4);
+  for(int i=0; i<wav.frames*wav.channels; ++i){
+    float sample = wav.samples[i];
+    if(useFloat){
+      union { float f; uint32_t i; } u = { sample };
+      writeLE(fp, u.i, 4);
+    }else{
+      sample = max(-1.0f, min(sample, 1.0f));
+      writeLE(fp, (uint32_t)(int32_t)(sample*8388607.0f), 3);
+    }
+  }
+  if(datasize & 1)
+    fputc(0, fp);
+  fclose(fp);
+  return true;
+}
+
+/* Conversion to and from the codec frame format expected by SampleBuffer */
+
+static void encodeFrames(const float* src, int channels, int16_t* dst, int blocksize){
+  for(int i=0; i<blocksize; ++i){
+    for(int ch=0; ch<NOF_CHANNELS; ++ch){
+      float sample = src[i*channels + min(ch, channels-1)];
+      sample = max(-1.0f, min(sample, 1.0f));
+#if AUDIO_BITDEPTH == 16
+      *dst++ = (int16_t)(sample*32767.0f);
+#else
+      int32_t qint = ((int32_t)(sample*8388607.0f)) << 8; // 24-bit left justified
+#ifdef AUDIO_BIGEND
+      *dst++ = qint >> 16;
+      *dst++ = qint & 0xffff;
+#else
+      *dst++ = qint & 0xffff;
+      *dst++ = qint >> 16;
+#endif
+#endif
+    }
+  }
+}
+
+static void decodeFrames(const int16_t* src, float* dst, int blocksize){
+  for(int i=0; i<blocksize*NOF_CHANNELS; ++i){
+#if AUDIO_BITDEPTH == 16
+    *dst++ = *src++ / 32768.0f;
+#else
+#ifdef AUDIO_BIGEND
+    int32_t qint = ((uint16_t)src[0] << 16) | (uint16_t)src[1];
+#else
+    int32_t qint = ((uint16_t)src[1] << 16) | (uint16_t)src[0];
+#endif
+    src += 2;
+    *dst++ = qint / 2147483648.0f;
+#endif
+  }
+}
+
+static uint64_t getNanoseconds(){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static void usage(const char* name){
+  fprintf(stderr,
+	  "Usage: %s [options] input.wav output.wav\n"
+	  "  -b blocksize    audio block size in frames (default 128)\n"
+	  "  -s samplerate   sample rate for the real-time budget (default: input file rate)\n"
+	  "  -p id=value     set parameter A-H (or numeric id) to a value from 0.0 to 1.0\n"
+	  "  -t seconds      render an extra tail of silence after the input\n"
+	  "  -c file.csv     write the time of each block in ns to a CSV file\n"
+	  "  -f              write 32-bit float output instead of 24-bit PCM\n"
+	  "  -a trace.txt    record every heap allocation and free to a trace file\n"
+	  "  -v              print patch messages as they are set\n", name);
+}
+
+static bool setParameterOption(const char* option){
+  const char* eq = strchr(option, '=');
+  if(eq == NULL)
+    return false;
+  int pid;
+  if(option[0] >= 'A' && option[0] <= 'H' && eq == option+1)
+    pid = option[0] - 'A';
+  else
+    pid = atoi(option);
+  if(pid < 0 || pid >= NOF_PARAMETERS)
+    return false;
+  float value = atof(eq+1);
+  parameters[pid] = max(0, min((int)(value*4096), 4095));
+  overridden[pid] = true;
+  return true;
+}
+
+int main(int argc, char** argv){
+  int blocksize = 128;
+  uint32_t samplerate = 0;
+  float tail = 0.0f;
+  bool useFloat = false;
+  const char* csvfile = NULL;
+  const char* tracefile = NULL;
+  int opt;
+  while((opt = getopt(argc, argv, "b:s:p:t:c:fa:vh")) != -1){
+    switch(opt){
+    case 'b':
+      blocksize = atoi(optarg);
+      break;
+    case 's':
+      samplerate = atoi(optarg);
+      break;
+    case 'p':
+      if(!setParameterOption(optarg)){
+	fprintf(stderr, "Invalid parameter option: %s\n", optarg);
+	return -1;
+      }
+      break;
+    case 't':
+      tail = atof(optarg);
+      break;
+    case 'c':
+      csvfile = optarg;
+      break;
+    case 'f':
+      useFloat = true;
+      break;
+    case 'a':
+      tracefile = optarg;
+      break;
+    case 'v':
+      verbose = true;
+      break;
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+  if(argc - optind != 2){
+    usage(argv[0]);
+    return -1;
+  }
+  // blocks are converted two frames at a time in SampleBuffer
+  if(blocksize <= 0 || blocksize > AUDIO_MAX_BLOCK_SIZE || (blocksize & 1)){
+    fprintf(stderr, "Invalid blocksize %d\n", blocksize);
+    return -1;
+  }
+
+  WavData input;
+  if(!readWav(argv[optind], input))
+    return -1;
+  if(tracefile != NULL){
+    traceFile = fopen(tracefile, "w");
+    if(traceFile == NULL){
+      fprintf(stderr, "Failed to open %s\n", tracefile);
+      return -1;
+    }
+  }
+  if(samplerate == 0)
+    samplerate = input.samplerate;
+
+  // set up program vector with sample rate, blocksize, callbacks et c
+  int16_t* audio_input = (int16_t*)malloc(blocksize*NOF_CHANNELS*2*sizeof(int16_t));
+  int16_t* audio_output = (int16_t*)malloc(blocksize*NOF_CHANNELS*2*sizeof(int16_t));
+  ProgramVector* pv = getProgramVector();
+  pv->checksum = PROGRAM_VECTOR_CHECKSUM_V12;
+  pv->hardware_version = OWL_PEDAL_HARDWARE;
+  pv->audio_input = audio_input;
+  pv->audio_output = audio_output;
+  pv->audio_bitdepth = AUDIO_BITDEPTH;
+  pv->audio_blocksize = blocksize;
+  pv->audio_samplingrate = samplerate;
+  pv->parameters = parameters;
+  pv->parameters_size = NOF_PARAMETERS;
+  pv->buttons = 0;
+  pv->error = 0;
+  pv->registerPatch = registerPatch;
+  pv->registerPatchParameter = registerPatchParameter;
+  pv->programReady = programReady;
+  pv->programStatus = programStatus;
+  pv->serviceCall = serviceCall;
+  pv->cycles_per_block = 0;
+  pv->heap_bytes_used = 0;
+  pv->message = NULL;
+  pv->setButton = setButton;
+  pv->setPatchParameter = setPatchParameter;
+  pv->buttonChangedCallback = onButtonChanged;
+  pv->encoderChangedCallback = onEncoderChanged;
+
+  // parameter defaults set by the patch are overridden by command line values
+  int16_t overrides[NOF_PARAMETERS];
+  memcpy(overrides, parameters, sizeof(parameters));
+  setup(pv);
+  for(int i=0; i<NOF_PARAMETERS; ++i)
+    if(overridden[i])
+      parameters[i] = overrides[i];
+  size_t heapSize = 0;
+  for(int i=0; i<NOF_HEAP_REGIONS; ++i)
+    heapSize += heapRegionFree[i];
+  pv->heap_bytes_used = heapSize - xPortGetFreeHeapSize();
+
+  int frames = input.frames + (int)(tail*input.samplerate);
+  int blocks = (frames + blocksize - 1)/blocksize;
+  WavData output;
+  output.channels = NOF_CHANNELS;
+  output.frames = blocks*blocksize;
+  output.samplerate = input.samplerate;
+  output.samples = (float*)malloc(output.frames*NOF_CHANNELS*sizeof(float));
+  float* silence = (float*)calloc(blocksize*input.channels, sizeof(float));
+  float* padded = (float*)malloc(blocksize*input.channels*sizeof(float));
+  uint32_t* times = (uint32_t*)malloc(blocks*sizeof(uint32_t));
+
+  for(int i=0; i<blocks; ++i){
+    int offset = i*blocksize;
+    const float* src;
+    if(offset + blocksize <= input.frames){
+      src = input.samples + offset*input.channels;
+    }else if(offset < input.frames){
+      int len = (input.frames - offset)*input.channels;
+      memcpy(padded, input.samples + offset*input.channels, len*sizeof(float));
+      memset(padded+len, 0, (blocksize*input.channels-len)*sizeof(float));
+      src = padded;
+    }else{
+      src = silence;
+    }
+    encodeFrames(src, input.channels, audio_input, blocksize);
+    pv->programReady();
+    evictBulkMemory();
+    uint64_t start = getNanoseconds();
+    processBlock(pv);
+    times[i] = getNanoseconds() - start;
+    pv->cycles_per_block = times[i];
+    decodeFrames(audio_output, output.samples + offset*NOF_CHANNELS, blocksize);
+  }
+
+  if(traceFile != NULL)
+    fclose(traceFile);
+  traceFile = NULL;
+
+  if(!writeWav(argv[optind+1], output, useFloat))
+    return -1;
+
+  if(csvfile != NULL){
+    FILE* fp = fopen(csvfile, "w");
+    if(fp == NULL){
+      fprintf(stderr, "Failed to open %s\n", csvfile);
+      return -1;
+    }
+    fprintf(fp, "block,ns\n");
+    for(int i=0; i<blocks; ++i)
+      fprintf(fp, "%d,%u\n", i, times[i]);
+    fclose(fp);
+  }
+
+  uint64_t total = 0;
+  uint32_t fastest = UINT32_MAX, slowest = 0;
+  for(int i=0; i<blocks; ++i){
+    total += times[i];
+    fastest = min(fastest, times[i]);
+    slowest = max(slowest, times[i]);
+  }
+  double mean = blocks ? (double)total/blocks : 0.0;
+  double budget = 1e9*blocksize/samplerate;
+  printf("Patch %s\n", patchName ? patchName : "(unregistered)");
+  for(int i=0; i<NOF_PARAMETERS; ++i)
+    if(parameterNames[i] != NULL)
+      printf("Parameter %d %s: %.3f\n", i, parameterNames[i], parameters[i]/4096.0f);
+  printf("Rendered %d blocks of %d frames at %u Hz\n", blocks, blocksize, samplerate);
+  printf("Block time ns: mean %.0f min %u max %u budget %.0f\n", mean, fastest, slowest, budget);
+  printf("Headroom: mean %.1f%% worst %.1f%%\n",
+	 100.0*(1.0 - mean/budget), 100.0*(1.0 - slowest/budget));
+  printf("Heap bytes used: %u\n", pv->heap_bytes_used);
+  for(int i=0; i<NOF_HEAP_REGIONS; ++i){
+    size_t available = xPortGetFreeRegionSize(i);
+    printf("  %-6s used %zu free %zu of %zu\n", heapRegionNames[i],
+	   heapRegionFree[i] - available, available, heapRegionSizes[i]);
+  }
+  printHeapStats();
+  if(pv->message != NULL)
+    printf("Message: %s\n", pv->message);
+  return 0;
+}
@@ -0,0 +1,346 @@
+#ifndef __BiquadFilterBank_h__
+#define __BiquadFilterBank_h__
+
+#include "FloatArray.h"
+#include "Patch.h"
+#include "BiquadFilter.h"
+#ifndef ARM_CORTEX
+#include "simd.h"
+#endif
+
+/**
+ * Bank of parallel second order filters, all fed the same input, for
+ * vocoders and graphic EQs. Each band is one Direct Form 2 Transposed
+ * stage, usually a band pass, and the coefficients and state are stored
+ * as one array per coefficient, indexed by band, so that all the bands are
+ * updated together in a single pass over the block, SIMD_FLOAT_LANES bands
+ * at a time on the host.
+ * On ARM each band is filtered on its own with the CMSIS Direct Form 2
+ * Transposed cascade, into a block of its own rather than interleaved, and
+ * the coefficients and state are stored band by band as CMSIS expects.
+ * Its speed on the device has not been measured, only on the host.
+ * The bands can be written out separately, one channel per band, or
+ * summed with a gain per band. Each band can also have an envelope
+ * follower, which tracks the smoothed absolute value of its output.
+ * @code
+ * bank = BiquadFilterBank::create(16, getBlockSize());
+ * bank->setBandPasses(0.005, 0.5, 8);
+ * bank->setEnvelopeFollower(0.999);
+ * ...
+ * analysis->process(modulator);
+ * synthesis->getGains().copyFrom(analysis->getEnvelopes());
+ * synthesis->process(carrier, output);
+ * @endcode
+ */
+class BiquadFilterBank {
+private:
+  FloatArray coefficients; // five rows of width: b0, b1, b2, a1, a2
+  FloatArray state; // two rows of width: d1, d2
+  FloatArray gains;
+  FloatArray envelopes;
+#ifdef ARM_CORTEX
+  FloatArray buffer; // the output of one band, and the sum of the bands
+  arm_biquad_cascade_df2T_instance_f32* filters;
+#else
+  FloatArray buffer; // interleaved band outputs
+#endif /* ARM_CORTEX */
+  float lambda; // envelope smoothing, 0 for none
+  int bands;
+  int width; // bands, rounded up to a whole number of vectors
+  int blockSize;
+
+  /* the index of coefficient i of band */
+  int getIndex(int band, int i){
+#ifdef ARM_CORTEX
+    return band*BIQUAD_COEFFICIENTS_PER_STAGE+i;
+#else
+    return i*width+band;
+#endif /* ARM_CORTEX */
+  }
+
+#ifdef ARM_CORTEX
+  /* one band of input into output, and its envelope */
+  void processBand(int b, float* input, float* output, int size){
+    arm_biquad_cascade_df2T_f32(&filters[b], input, output, size);
+    if(lambda > 0){
+      float e = envelopes[b];
+      for(int n=0; n<size; n++){
+	float y = fabsf(output[n]);
+	e = y + lambda*(e - y);
+      }
+      envelopes[b] = e;
+    }
+  }
+#else
+  float* getRow(FloatArray array, int row){
+    return array.getData()+row*width;
+  }
+
+  /* all bands of input into buffer, interleaved */
+  void processBands(float* input, int size){
+    const float* b0 = getRow(coefficients, 0);
+    const float* b1 = getRow(coefficients, 1);
+    const float* b2 = getRow(coefficients, 2);
+    const float* a1 = getRow(coefficients, 3);
+    const float* a2 = getRow(coefficients, 4);
+    float* d1 = getRow(state, 0);
+    float* d2 = getRow(state, 1);
+    float* env = envelopes.getData();
+    float* frames = buffer.getData();
+    int b = 0;
+#ifdef SIMD_FLOAT_LANES
+    for(; b+SIMD_FLOAT_LANES<=width; b+=SIMD_FLOAT_LANES){
+      simd_float vb0 = simd_load(b0+b), vb1 = simd_load(b1+b), vb2 = simd_load(b2+b);
+      simd_float va1 = simd_load(a1+b), va2 = simd_load(a2+b);
+      simd_float s1 = simd_load(d1+b), s2 = simd_load(d2+b);
+      for(int n=0; n<size; n++){
+	simd_float x = simd_set(input[n]);
+	simd_float y = simd_add(simd_mul(vb0, x), s1);
+	s1 = simd_add(simd_add(simd_mul(vb1, x), simd_mul(va1, y)), s2);
+	s2 = simd_add(simd_mul(vb2, x), simd_mul(va2, y));
+	simd_store(frames+n*width+b, y);
+      }
+      simd_store(d1+b, s1);
+      simd_store(d2+b, s2);
+      if(lambda > 0){
+	simd_float e = simd_load(env+b);
+	simd_float k = simd_set(lambda);
+	for(int n=0; n<size; n++){
+	  simd_float y = simd_abs(simd_load(frames+n*width+b));
+	  e = simd_add(y, simd_mul(k, simd_sub(e, y)));
+	}
+	simd_store(env+b, e);
+      }
+    }
+#endif
+    for(; b<width; b++){
+      float s1 = d1[b];
+      float s2 = d2[b];
+      for(int n=0; n<size; n++){
+	float x = input[n];
+	float y = b0[b]*x + s1;
+	s1 = b1[b]*x + a1[b]*y + s2;
+	s2 = b2[b]*x + a2[b]*y;
+	frames[n*width+b] = y;
+      }
+      d1[b] = s1;
+      d2[b] = s2;
+      if(lambda > 0){
+	float e = env[b];
+	for(int n=0; n<size; n++){
+	  float y = fabsf(frames[n*width+b]);
+	  e = y + lambda*(e - y);
+	}
+	env[b] = e;
+      }
+    }
+  }
+#endif /* ARM_CORTEX */
+
+public:
+  BiquadFilterBank() : lambda(0), bands(0), width(0), blockSize(0) {
+#ifdef ARM_CORTEX
+    filters = NULL;
+#endif /* ARM_CORTEX */
+  }
+
+  BiquadFilterBank(int aBands, int aBlockSize){
+    init(aBands, aBlockSize);
+  }
+
+  ~BiquadFilterBank(){
+    FloatArray::destroy(coefficients);
+    FloatArray::destroy(state);
+    FloatArray::destroy(gains);
+    FloatArray::destroy(envelopes);
+    FloatArray::destroy(buffer);
+#ifdef ARM_CORTEX
+    delete[] filters;
+#endif /* ARM_CORTEX */
+  }
+
+  void init(int aBands, int aBlockSize){
+    bands = aBands;
+    blockSize = aBlockSize;
+#ifdef SIMD_FLOAT_LANES
+    width = (bands+SIMD_FLOAT_LANES-1)/SIMD_FLOAT_LANES*SIMD_FLOAT_LANES;
+#else
+    width = bands;
+#endif
+    // the padding bands have zero coefficients, so their output is zero
+    coefficients = FloatArray::create(5*width);
+    state = FloatArray::create(2*width);
+    gains = FloatArray::create(width);
+    envelopes = FloatArray::create(width);
+#ifdef ARM_CORTEX
+    buffer = FloatArray::create(2*blockSize);
+    filters = new arm_biquad_cascade_df2T_instance_f32[bands];
+    for(int b=0; b<bands; b++)
+      arm_biquad_cascade_df2T_init_f32(&filters[b], 1, coefficients.getData()+b*BIQUAD_COEFFICIENTS_PER_STAGE, state.getData()+b*BIQUAD_STATE_VARIABLES_PER_STAGE);
+#else
+    buffer = FloatArray::create(width*blockSize);
+#endif /* ARM_CORTEX */
+    gains.subArray(0, bands).setAll(1);
+    lambda = 0;
+  }
+
+  /**
+   * Clear the filter state and the envelopes.
+   */
+  void reset(){
+    state.clear();
+    envelopes.clear();
+  }
+
+  int getBands(){
+    return bands;
+  }
+
+  /**
+   * Set the coefficients of one band, in the order used by BiquadFilter:
+   * b0, b1, b2, a1, a2.
+   */
+  void setCoefficients(int band, FloatArray newCoefficients){
+    ASSERT(band < bands && newCoefficients.getSize() == BIQUAD_COEFFICIENTS_PER_STAGE, "wrong size");
+    for(int i=0; i<BIQUAD_COEFFICIENTS_PER_STAGE; i++)
+      coefficients[getIndex(band, i)] = newCoefficients[i];
+  }
+
+  void setBandPass(int band, float fc, float q){
+    float c[BIQUAD_COEFFICIENTS_PER_STAGE];
+    FilterStage::setBandPass(c, fc, q);
+    setCoefficients(band, FloatArray(c, BIQUAD_COEFFICIENTS_PER_STAGE));
+  }
+
+  void setPeak(int band, float fc, float q, float gain){
+    float c[BIQUAD_COEFFICIENTS_PER_STAGE];
+    FilterStage::setPeak(c, fc, q, gain);
+    setCoefficients(band, FloatArray(c, BIQUAD_COEFFICIENTS_PER_STAGE));
+  }
+
+  /**
+   * Set all bands to band passes with centre frequencies spaced evenly in
+   * pitch from low to high, as fractions of the Nyquist frequency.
+   */
+  void setBandPasses(float low, float high, float q){
+    for(int i=0; i<bands; i++){
+      float fc = bands > 1 ? low*powf(high/low, i/(float)(bands-1)) : low;
+      setBandPass(i, fc, q);
+    }
+  }
+
+  /**
+   * The gains applied to the bands when they are summed, which are all 1
+   * to begin with.
+   */
+  FloatArray getGains(){
+    return gains.subArray(0, bands);
+  }
+
+  void setGain(int band, float gain){
+    ASSERT(band < bands, "Invalid band");
+    gains[band] = gain;
+  }
+
+  /**
+   * Follow the envelope of each band, smoothing the absolute value with
+   * y = lambda*y + (1-lambda)*|x|, as for parameter smoothing. A lambda of
+   * 0 turns the followers off.
+   */
+  void setEnvelopeFollower(float aLambda){
+    lambda = aLambda;
+  }
+
+  /**
+   * The envelope of each band at the end of the last block.
+   */
+  FloatArray getEnvelopes(){
+    return envelopes.subArray(0, bands);
+  }
+
+  /**
+   * Filter input only to update the envelopes.
+   */
+  void process(FloatArray input){
+    ASSERT(input.getSize() <= blockSize, "Wrong size");
+#ifdef ARM_CORTEX
+    for(int b=0; b<bands; b++)
+      processBand(b, input.getData(), buffer.getData(), input.getSize());
+#else
+    processBands(input.getData(), input.getSize());
+#endif /* ARM_CORTEX */
+  }
+
+  /**
+   * Filter input into one channel of output per band.
+   */
+  void process(FloatArray input, AudioBuffer& output){
+    int size = input.getSize();
+    ASSERT(size <= blockSize && output.getSize() == size, "Wrong size");
+    ASSERT(output.getChannels() >= bands, "Too few channels");
+#ifdef ARM_CORTEX
+    // through buffer, in case input is also one of the output channels
+    FloatArray band = buffer.subArray(0, size);
+    for(int b=0; b<bands; b++){
+      processBand(b, input.getData(), band.getData(), size);
+      output.getSamples(b).copyFrom(band);
+    }
+#else
+    processBands(input.getData(), size);
+    const float* frames = buffer.getData();
+    for(int b=0; b<bands; b++){
+      float* samples = output.getSamples(b).getData();
+      for(int n=0; n<size; n++)
+	samples[n] = frames[n*width+b];
+    }
+#endif /* ARM_CORTEX */
+  }
+
+  /**
+   * Filter input, and sum the bands times their gains into output, which
+   * can be the same array.
+   */
+  void process(FloatArray input, FloatArray output){
+    int size = input.getSize();
+    ASSERT(size <= blockSize && output.getSize() == size, "Wrong size");
+#ifdef ARM_CORTEX
+    FloatArray band = buffer.subArray(0, size);
+    FloatArray sum = buffer.subArray(blockSize, size);
+    sum.clear();
+    for(int b=0; b<bands; b++){
+      processBand(b, input.getData(), band.getData(), size);
+      band.multiply(gains[b]);
+      sum.add(band);
+    }
+    output.copyFrom(sum);
+#else
+    processBands(input.getData(), size);
+    const float* frames = buffer.getData();
+    const float* g = gains.getData();
+    for(int n=0; n<size; n++){
+      const float* y = frames+n*width;
+      float sum = 0;
+      int b = 0;
+#ifdef SIMD_FLOAT_LANES
+      simd_float acc = simd_set(0);
+      for(; b+SIMD_FLOAT_LANES<=width; b+=SIMD_FLOAT_LANES)
+	acc = simd_add(acc, simd_mul(simd_load(y+b), simd_load(g+b)));
+      sum = simd_sum(acc);
+#endif
+      for(; b<width; b++)
+	sum += y[b]*g[b];
+      output[n] = sum;
+    }
+#endif /* ARM_CORTEX */
+  }
+
+  static BiquadFilterBank* create(int bands, int blockSize){
+    return new BiquadFilterBank(bands, blockSize);
+  }
+
+  static void destroy(BiquadFilterBank* bank){
+    delete bank;
+  }
+};
+
+#endif // __BiquadFilterBank_h__
@@ -200,9 +200,15 @@ void ComplexFloatArray::scale(float factor){
 }
 
 ComplexFloatArray ComplexFloatArray::create(int size){
+  traceHEAP_SITE();
   return ComplexFloatArray(new ComplexFloat[size], size);
 }
 
+ComplexFloatArray ComplexFloatArray::create(int size, MemoryHint hint){
+  traceHEAP_SITE();
+  return ComplexFloatArray(new(hint) ComplexFloat[size], size);
+}
+
 void ComplexFloatArray::destroy(ComplexFloatArray array){
   delete array.data;
 }
@@ -318,6 +318,14 @@ public:
   */
   static ComplexFloatArray create(int size);
 
+  /**
+   * Creates a new ComplexFloatArray in the memory region given by hint.
+   * The contents are not initialised. If no region has enough memory,
+   * **data** is NULL.
+   * @see MemoryHint
+   */
+  static ComplexFloatArray create(int size, MemoryHint hint);
+
   /**
    * Destroys a ComplexFloatArray created with the create() method.
    * @param array The ComplexFloatArray to be destroyed.
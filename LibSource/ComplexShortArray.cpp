@@ -97,6 +97,7 @@ void ComplexShortArray::complexByComplexMultiplication(ComplexShortArray operand
 }
 
 ComplexShortArray ComplexShortArray::create(unsigned int size){
+  traceHEAP_SITE();
   return ComplexShortArray(new ComplexShort[size], size);
 }
 
@@ -38,13 +38,16 @@ int FastFourierTransform::getSize(){
 
 #else /* ARM_CORTEX */
 
-FastFourierTransform::FastFourierTransform(){}
+FastFourierTransform::FastFourierTransform() :
+  cfgfft(NULL), cfgifft(NULL) {}
 
 FastFourierTransform::FastFourierTransform(int aSize){
   init(aSize);
 }
 
 FastFourierTransform::~FastFourierTransform(){
+  kiss_fft_free(cfgfft);
+  kiss_fft_free(cfgifft);
   ComplexFloatArray::destroy(temp);
 }
 
@@ -52,7 +55,7 @@ void FastFourierTransform::init(int aSize){
   ASSERT(aSize==32 || aSize ==64 || aSize==128 || aSize==256 || aSize==512 || aSize==1024 || aSize==2048 || aSize==4096, "Unsupported FFT size");
   cfgfft = kiss_fft_alloc(aSize, 0 , 0, 0);
   cfgifft = kiss_fft_alloc(aSize, 1,0, 0);
-  temp = ComplexFloatArray::create(getSize());
+  temp = ComplexFloatArray::create(aSize);
 }
 
 void FastFourierTransform::fft(FloatArray input, ComplexFloatArray output){
@@ -0,0 +1,149 @@
+#ifndef __FirDecimator_h__
+#define __FirDecimator_h__
+
+#include "FloatArray.h"
+#ifndef ARM_CORTEX
+#include "simd.h"
+#endif
+
+/**
+ * Lowpass FIR filter and downsampler, for analysing a signal at a reduced
+ * sample rate. Only every factor'th output of the filter is computed, so
+ * the cost is numTaps/factor multiply-adds per input sample.
+ * The coefficients are in the order used by CMSIS, which is time reversed,
+ * so it makes no difference for symmetric (linear phase) filters.
+ * Each call to processBlock() takes a multiple of factor input samples, up
+ * to the block size given to create().
+ * @code
+ * decimator = FirDecimator::create(4, 64, getBlockSize());
+ * decimator->setLowPass(0.2);
+ * analysis = FloatArray::create(getBlockSize()/4);
+ * ...
+ * decimator->processBlock(buffer.getSamples(LEFT_CHANNEL), analysis);
+ * @endcode
+ */
+class FirDecimator {
+private:
+  FloatArray coefficients;
+  FloatArray states;
+  int factor;
+  int blockSize;
+#ifdef ARM_CORTEX
+  arm_fir_decimate_instance_f32 instance;
+#else
+  static float dot(const float* a, const float* b, int size){
+    float result = 0;
+    int n = 0;
+#ifdef SIMD_FLOAT_LANES
+    simd_float acc = simd_set(0);
+    for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+      acc = simd_add(acc, simd_mul(simd_load(a+n), simd_load(b+n)));
+    result = simd_sum(acc);
+#endif
+    for(; n<size; n++)
+      result += a[n]*b[n];
+    return result;
+  }
+#endif /* ARM_CORTEX */
+
+public:
+  FirDecimator() : factor(1), blockSize(0) {}
+
+  FirDecimator(int aFactor, int numTaps, int aBlockSize){
+    init(aFactor, numTaps, aBlockSize);
+  }
+
+  ~FirDecimator(){
+    FloatArray::destroy(coefficients);
+    FloatArray::destroy(states);
+  }
+
+  /**
+   * @param aFactor the decimation factor
+   * @param aBlockSize the largest input block, a multiple of aFactor
+   */
+  void init(int aFactor, int numTaps, int aBlockSize){
+    ASSERT(aBlockSize % aFactor == 0, "Block size must be a multiple of factor");
+    factor = aFactor;
+    blockSize = aBlockSize;
+    coefficients = FloatArray::create(numTaps);
+    states = FloatArray::create(numTaps + blockSize - 1);
+#ifdef ARM_CORTEX
+    arm_fir_decimate_init_f32(&instance, numTaps, factor, coefficients.getData(), states.getData(), blockSize);
+#endif /* ARM_CORTEX */
+  }
+
+  void reset(){
+    states.clear();
+  }
+
+  /**
+   * Filter and decimate source into destination, which must be 1/factor of
+   * the size.
+   */
+  void processBlock(FloatArray source, FloatArray destination){
+    int size = source.getSize();
+    ASSERT(size <= blockSize && size % factor == 0, "Wrong size");
+    ASSERT(destination.getSize() == size/factor, "Sizes don't match");
+#ifdef ARM_CORTEX
+    arm_fir_decimate_f32(&instance, source.getData(), destination.getData(), size);
+#else
+    // the states hold numTaps-1 samples of history, oldest first, followed
+    // by the new input, as with CMSIS
+    int history = coefficients.getSize()-1;
+    states.subArray(history, size).copyFrom(source);
+    const float* c = coefficients.getData();
+    for(int i=0; i<destination.getSize(); i++)
+      destination[i] = dot(states.getData()+i*factor, c, coefficients.getSize());
+    states.move(size, 0, history);
+#endif /* ARM_CORTEX */
+  }
+
+  FloatArray getCoefficients(){
+    return coefficients;
+  }
+
+  /**
+   * Copies coefficients value from an array.
+   */
+  void setCoefficients(FloatArray newCoefficients){
+    ASSERT(coefficients.getSize()==newCoefficients.getSize(), "wrong size");
+    coefficients.copyFrom(newCoefficients);
+  }
+
+  /**
+   * Set the coefficients to a Blackman windowed sinc lowpass with unity
+   * gain. fc is the cutoff as a fraction of the Nyquist frequency of the
+   * input, and should be a little below 1/factor to keep aliases out of the
+   * output.
+   */
+  void setLowPass(float fc){
+    setLowPass(coefficients, fc, 1.0f);
+  }
+
+  int getFactor(){
+    return factor;
+  }
+
+  static void setLowPass(FloatArray coefficients, float fc, float gain){
+    int size = coefficients.getSize();
+    float centre = (size-1)*0.5f;
+    for(int i=0; i<size; i++){
+      float t = i-centre;
+      float sinc = t == 0 ? fc : sinf(M_PI*fc*t)/(M_PI*t);
+      float phase = 2*M_PI*(i+1)/(size+1);
+      coefficients[i] = sinc*(0.42f - 0.5f*cosf(phase) + 0.08f*cosf(2*phase));
+    }
+    coefficients.multiply(gain/coefficients.getMean()/size);
+  }
+
+  static FirDecimator* create(int factor, int numTaps, int blockSize){
+    return new FirDecimator(factor, numTaps, blockSize);
+  }
+
+  static void destroy(FirDecimator* filter){
+    delete filter;
+  }
+};
+
+#endif // __FirDecimator_h__
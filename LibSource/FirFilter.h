@@ -24,11 +24,10 @@ private:
       float y = 0;
       for(int k = 0; k < coefficients.getSize(); k++){
         y += coefficients[k] * states[tempPointer];
-        tempPointer = (tempPointer == states.getSize()) ? 0 : tempPointer+1;
+        tempPointer = (tempPointer == 0) ? states.getSize()-1 : tempPointer-1;
       }
       destination[n] = y;
-      //  destination[n] = 0;
-      pointer = (pointer == states.getSize()) ? 0 : pointer+1;
+      pointer = (pointer == states.getSize()-1) ? 0 : pointer+1;
     }
 #endif /* ARM_CORTEX */
   }
@@ -84,8 +83,8 @@ public:
   }
 
   static void destroy(FirFilter* filter){
-    delete filter->coefficients;
-    delete filter->states;
+    // coefficients are freed by the destructor
+    FloatArray::destroy(filter->states);
     delete filter;
   }
 };
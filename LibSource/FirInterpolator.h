@@ -0,0 +1,149 @@
+#ifndef __FirInterpolator_h__
+#define __FirInterpolator_h__
+
+#include "FloatArray.h"
+#include "FirDecimator.h"
+#ifndef ARM_CORTEX
+#include "simd.h"
+#endif
+
+/**
+ * Upsampler and lowpass FIR filter, for returning to the full sample rate
+ * after processing at a reduced one. The filter is split into factor
+ * phases of numTaps/factor taps, one for each output sample, so the zeros
+ * that upsampling inserts are never multiplied and the cost is numTaps
+ * multiply-adds per input sample.
+ * numTaps must be a multiple of factor. The coefficients are in the order
+ * used by CMSIS, which is time reversed, and should sum to factor for
+ * unity gain.
+ * @code
+ * interpolator = FirInterpolator::create(4, 64, getBlockSize()/4);
+ * interpolator->setLowPass(0.2);
+ * ...
+ * interpolator->processBlock(analysis, buffer.getSamples(LEFT_CHANNEL));
+ * @endcode
+ */
+class FirInterpolator {
+private:
+  FloatArray coefficients;
+  FloatArray states;
+  int factor;
+  int blockSize;
+#ifdef ARM_CORTEX
+  arm_fir_interpolate_instance_f32 instance;
+#endif /* ARM_CORTEX */
+
+public:
+  FirInterpolator() : factor(1), blockSize(0) {}
+
+  FirInterpolator(int aFactor, int numTaps, int aBlockSize){
+    init(aFactor, numTaps, aBlockSize);
+  }
+
+  ~FirInterpolator(){
+    FloatArray::destroy(coefficients);
+    FloatArray::destroy(states);
+  }
+
+  /**
+   * @param aFactor the interpolation factor
+   * @param numTaps a multiple of aFactor
+   * @param aBlockSize the largest input block
+   */
+  void init(int aFactor, int numTaps, int aBlockSize){
+    ASSERT(numTaps % aFactor == 0, "Taps must be a multiple of factor");
+    factor = aFactor;
+    blockSize = aBlockSize;
+    coefficients = FloatArray::create(numTaps);
+    states = FloatArray::create(numTaps/factor + blockSize - 1);
+#ifdef ARM_CORTEX
+    arm_fir_interpolate_init_f32(&instance, factor, numTaps, coefficients.getData(), states.getData(), blockSize);
+#endif /* ARM_CORTEX */
+  }
+
+  void reset(){
+    states.clear();
+  }
+
+  /**
+   * Upsample and filter source into destination, which must be factor
+   * times the size.
+   */
+  void processBlock(FloatArray source, FloatArray destination){
+    int size = source.getSize();
+    ASSERT(size <= blockSize, "Too large");
+    ASSERT(destination.getSize() == size*factor, "Sizes don't match");
+#ifdef ARM_CORTEX
+    arm_fir_interpolate_f32(&instance, source.getData(), destination.getData(), size);
+#else
+    // output j after input n is the sum over the phase length of
+    // states[n+t]*coefficients[factor-1-j+t*factor], as with CMSIS
+    int phaseLength = coefficients.getSize()/factor;
+    int history = phaseLength-1;
+    states.subArray(history, size).copyFrom(source);
+    const float* x = states.getData();
+    float* y = destination.getData();
+    int n = 0;
+#ifdef SIMD_FLOAT_LANES
+    // one phase for several inputs at a time, to keep the sum in a register
+    for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES){
+      for(int j=0; j<factor; j++){
+	const float* c = coefficients.getData()+factor-1-j;
+	simd_float acc = simd_set(0);
+	for(int t=0; t<phaseLength; t++)
+	  acc = simd_add(acc, simd_mul(simd_load(x+n+t), simd_set(c[t*factor])));
+	float sums[SIMD_FLOAT_LANES];
+	simd_store(sums, acc);
+	for(int k=0; k<SIMD_FLOAT_LANES; k++)
+	  y[(n+k)*factor+j] = sums[k];
+      }
+    }
+#endif
+    for(; n<size; n++){
+      for(int j=0; j<factor; j++){
+	const float* c = coefficients.getData()+factor-1-j;
+	float sum = 0;
+	for(int t=0; t<phaseLength; t++)
+	  sum += x[n+t]*c[t*factor];
+	y[n*factor+j] = sum;
+      }
+    }
+    states.move(size, 0, history);
+#endif /* ARM_CORTEX */
+  }
+
+  FloatArray getCoefficients(){
+    return coefficients;
+  }
+
+  /**
+   * Copies coefficients value from an array.
+   */
+  void setCoefficients(FloatArray newCoefficients){
+    ASSERT(coefficients.getSize()==newCoefficients.getSize(), "wrong size");
+    coefficients.copyFrom(newCoefficients);
+  }
+
+  /**
+   * Set the coefficients to a Blackman windowed sinc lowpass with unity
+   * gain. fc is the cutoff as a fraction of the Nyquist frequency of the
+   * output, and should be a little below 1/factor to remove the images.
+   */
+  void setLowPass(float fc){
+    FirDecimator::setLowPass(coefficients, fc, factor);
+  }
+
+  int getFactor(){
+    return factor;
+  }
+
+  static FirInterpolator* create(int factor, int numTaps, int blockSize){
+    return new FirInterpolator(factor, numTaps, blockSize);
+  }
+
+  static void destroy(FirInterpolator* filter){
+    delete filter;
+  }
+};
+
+#endif // __FirInterpolator_h__
@@ -1,8 +1,46 @@
 #include "FloatArray.h"
 #include "basicmaths.h"
 #include "message.h"
+#include "simd.h"
+#include "simd_math.h"
+#include "ComplexFloatArray.h"
+#include "FastFourierTransform.h"
 #include <string.h>
 
+#ifndef ARM_CORTEX
+static float getSum(const float* data, int size){
+  float result=0;
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  simd_float acc = simd_set(0);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    acc = simd_add(acc, simd_load(data+n));
+  result = simd_sum(acc);
+#endif
+  for(; n<size; n++)
+    result += data[n];
+  return result;
+}
+
+// sum of the squared differences from offset
+static float getSumOfSquares(const float* data, int size, float offset){
+  float result=0;
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  simd_float acc = simd_set(0);
+  simd_float x0 = simd_set(offset);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES){
+    simd_float x = simd_sub(simd_load(data+n), x0);
+    acc = simd_add(acc, simd_mul(x, x));
+  }
+  result = simd_sum(acc);
+#endif
+  for(; n<size; n++)
+    result += (data[n]-offset)*(data[n]-offset);
+  return result;
+}
+#endif /* ARM_CORTEX */
+
  FloatArray::FloatArray() :
    data(NULL), size(0) {}
 
@@ -18,7 +56,29 @@ void FloatArray::getMin(float* value, int* index){
 #else
   *value=data[0];
   *index=0;
-  for(int n=1; n<size; n++){
+  int n=1;
+#ifdef SIMD_FLOAT_LANES
+  if(size >= 2*SIMD_FLOAT_LANES){
+    // find the value, then the index of its first occurrence
+    // simd_min(x, acc) keeps acc when x is NaN, as the scalar loop does
+    simd_float acc = simd_set(data[0]);
+    for(n=0; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+      acc = simd_min(simd_load(data+n), acc);
+    float result = simd_hmin(acc);
+    for(; n<size; n++)
+      if(data[n]<result)
+        result=data[n];
+    for(n=0; n<size && data[n]!=result; n++);
+    if(n<size){
+      *value=result;
+      *index=n;
+      return;
+    }
+    // data[0] is NaN
+    n=1;
+  }
+#endif
+  for(; n<size; n++){
     float currentValue=data[n];
     if(currentValue<*value){
       *value=currentValue;
@@ -54,7 +114,29 @@ void FloatArray::getMax(float* value, int* index){
 #else
   *value=data[0];
   *index=0;
-  for(int n=1; n<size; n++){
+  int n=1;
+#ifdef SIMD_FLOAT_LANES
+  if(size >= 2*SIMD_FLOAT_LANES){
+    // find the value, then the index of its first occurrence
+    // simd_max(x, acc) keeps acc when x is NaN, as the scalar loop does
+    simd_float acc = simd_set(data[0]);
+    for(n=0; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+      acc = simd_max(simd_load(data+n), acc);
+    float result = simd_hmax(acc);
+    for(; n<size; n++)
+      if(data[n]>result)
+        result=data[n];
+    for(n=0; n<size && data[n]!=result; n++);
+    if(n<size){
+      *value=result;
+      *index=n;
+      return;
+    }
+    // data[0] is NaN
+    n=1;
+  }
+#endif
+  for(; n<size; n++){
     float currentValue=data[n];
     if(currentValue>*value){
       *value=currentValue;
@@ -86,8 +168,14 @@ void FloatArray::rectify(FloatArray& destination){ //this is actually "copy data
   arm_abs_f32(data, destination.getData(), size);
 #else
   int minSize= min(size,destination.getSize()); //TODO: shall we take this out and allow it to segfault?
-  for(int n=0; n<minSize; n++){
-    destination[n] = fabs(data[n]);
+  float* dst = destination.getData();
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  for(; n+SIMD_FLOAT_LANES<=minSize; n+=SIMD_FLOAT_LANES)
+    simd_store(dst+n, simd_abs(simd_load(data+n)));
+#endif
+  for(; n<minSize; n++){
+    dst[n] = fabs(data[n]);
   }
 #endif  
 }
@@ -131,12 +219,7 @@ float FloatArray::getRms(){
 #ifdef ARM_CORTEX  
   arm_rms_f32 (data, size, &result);
 #else
-  result=0;
-  float *pSrc= data;
-  for(int n=0; n<size; n++){
-    result += pSrc[n]*pSrc[n];
-  }
-  result=sqrtf(result/size);
+  result=sqrtf(getSumOfSquares(data, size, 0)/size);
 #endif
   return result;
 }
@@ -147,11 +230,7 @@ float FloatArray::getMean(){
 #ifdef ARM_CORTEX  
   arm_mean_f32 (data, size, &result);
 #else
-  result=0;
-  for(int n=0; n<size; n++){
-    result+=data[n];
-  }
-  result=result/size;
+  result=getSum(data, size)/size;
 #endif
   return result;
 }
@@ -162,11 +241,7 @@ float FloatArray::getPower(){
 #ifdef ARM_CORTEX  
   arm_power_f32 (data, size, &result);
 #else
-  result=0;
-  float *pSrc = data;
-  for(int n=0; n<size; n++){
-    result += pSrc[n]*pSrc[n];
-  }
+  result=getSumOfSquares(data, size, 0);
 #endif
   return result;
 }
@@ -188,12 +263,9 @@ float FloatArray::getVariance(){
 #ifdef ARM_CORTEX  
   arm_var_f32(data, size, &result);
 #else
-  float sumOfSquares=getPower();
-  float sum=0;
-  for(int n=0; n<size; n++){
-    sum+=data[n];
-  }
-  result=(sumOfSquares - sum*sum/size) / (size - 1);
+  // two passes, which is more accurate than the sum of squares less the squared sum
+  float mean=getSum(data, size)/size;
+  result=getSumOfSquares(data, size, mean) / (size - 1);
 #endif
   return result;
 }
@@ -203,7 +275,14 @@ void FloatArray::clip(){
 }
 
 void FloatArray::clip(float max){
-  for(int n=0; n<size; n++){
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  simd_float hi = simd_set(max);
+  simd_float lo = simd_set(-max);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(data+n, simd_max(lo, simd_min(hi, simd_load(data+n)))); // keeps NaN
+#endif
+  for(; n<size; n++){
     if(data[n]>max)
       data[n]=max;
     else if(data[n]<-max)
@@ -211,7 +290,14 @@ void FloatArray::clip(float max){
   }
 }
 void FloatArray::clip(float min, float max){
-  for(int n=0; n<size; n++){
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  simd_float hi = simd_set(max);
+  simd_float lo = simd_set(min);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(data+n, simd_max(lo, simd_min(hi, simd_load(data+n)))); // keeps NaN
+#endif
+  for(; n<size; n++){
     if(data[n]>max)
       data[n]=max;
     else if(data[n]<min)
@@ -279,12 +365,93 @@ void FloatArray::setAll(float value){
 #ifdef ARM_CORTEX
   arm_fill_f32(value, data, size);
 #else
-  for(int n=0; n<size; n++){
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  simd_float x = simd_set(value);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(data+n, x);
+#endif
+  for(; n<size; n++){
     data[n]=value;
   }
 #endif /* ARM_CORTEX */
 }
 
+void FloatArray::ramp(float from, float to){
+  // each element is computed from its index so that errors don't accumulate
+  float step = (to-from)/size;
+  int n = 0;
+#ifdef SIMD_FLOAT_LANES
+  float index[SIMD_FLOAT_LANES];
+  for(int i=0; i<SIMD_FLOAT_LANES; i++)
+    index[i] = i+1;
+  simd_float x = simd_load(index);
+  simd_float lanes = simd_set(SIMD_FLOAT_LANES);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES){
+    simd_store(data+n, simd_add(simd_set(from), simd_mul(simd_set(step), x)));
+    x = simd_add(x, lanes);
+  }
+#else
+  // four independent lanes
+  for(; n+4<=size; n+=4){
+    data[n] = from + step*(n+1);
+    data[n+1] = from + step*(n+2);
+    data[n+2] = from + step*(n+3);
+    data[n+3] = from + step*(n+4);
+  }
+#endif
+  for(; n<size; n++)
+    data[n] = from + step*(n+1);
+  if(size > 0)
+    data[size-1] = to;
+}
+
+void FloatArray::expRamp(float from, float to){
+  ASSERT(from > 0.0f && to > 0.0f, "Exponential ramp requires positive values");
+  float ratio = expf(logf(to/from)/size);
+  float v = from*ratio;
+  int n = 0;
+#ifdef SIMD_FLOAT_LANES
+  // one lane per element, each multiplied by ratio^lanes per iteration
+  float first[SIMD_FLOAT_LANES];
+  float power = 1.0f;
+  for(int i=0; i<SIMD_FLOAT_LANES; i++){
+    first[i] = v*power;
+    power *= ratio;
+  }
+  simd_float x = simd_load(first);
+  simd_float step = simd_set(power);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES){
+    simd_store(data+n, x);
+    x = simd_mul(x, step);
+  }
+  if(n > 0)
+    v = data[n-1]*ratio;
+#else
+  // four lanes, each multiplied by ratio^4 per iteration
+  float ratio4 = ratio*ratio*ratio*ratio;
+  float v1 = v*ratio;
+  float v2 = v1*ratio;
+  float v3 = v2*ratio;
+  for(; n+4<=size; n+=4){
+    data[n] = v;
+    data[n+1] = v1;
+    data[n+2] = v2;
+    data[n+3] = v3;
+    v *= ratio4;
+    v1 *= ratio4;
+    v2 *= ratio4;
+    v3 *= ratio4;
+  }
+#endif
+  for(; n<size; n++){
+    data[n] = v;
+    v *= ratio;
+  }
+  if(size > 0)
+    data[size-1] = to;
+}
+
 void FloatArray::add(FloatArray operand2, FloatArray destination){ //allows in-place
   ASSERT(operand2.size >= size &&  destination.size<=size, "Arrays must be matching size");
 /// @note When built for ARM Cortex-M processor series, this method uses the optimized <a href="http://www.keil.com/pack/doc/CMSIS/General/html/index.html">CMSIS library</a>
@@ -295,7 +462,12 @@ void FloatArray::add(FloatArray operand2, FloatArray destination){ //allows in-p
   */
   arm_add_f32(data, operand2.data, destination.data, size);
 #else
-  for(int n=0; n<size; n++){
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(destination.data+n, simd_add(simd_load(data+n), simd_load(operand2.data+n)));
+#endif
+  for(; n<size; n++){
     destination[n]=data[n]+operand2[n];
   }
 #endif /* ARM_CORTEX */
@@ -307,9 +479,15 @@ void FloatArray::add(FloatArray operand2){ //in-place
 }
 
 void FloatArray::add(float scalar){
-  for(int n=0; n<size; n++){
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  simd_float x = simd_set(scalar);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(data+n, simd_add(simd_load(data+n), x));
+#endif
+  for(; n<size; n++){
     data[n]+=scalar;
-  } 
+  }
 }
 
 void FloatArray::subtract(FloatArray operand2, FloatArray destination){ //allows in-place
@@ -321,11 +499,16 @@ void FloatArray::subtract(FloatArray operand2, FloatArray destination){ //allows
       void 	arm_sub_f32 (float32_t *pSrcA, float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
   */
   arm_sub_f32(data, operand2.data, destination.data, size);
-  #else
-  for(int n=0; n<size; n++){
+#else
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(destination.data+n, simd_sub(simd_load(data+n), simd_load(operand2.data+n)));
+#endif
+  for(; n<size; n++){
     destination[n]=data[n]-operand2[n];
   }
-  #endif /* ARM_CORTEX */
+#endif /* ARM_CORTEX */
 }
 
 void FloatArray::subtract(FloatArray operand2){ //in-place
@@ -334,9 +517,15 @@ void FloatArray::subtract(FloatArray operand2){ //in-place
 }
 
 void FloatArray::subtract(float scalar){
-  for(int n=0; n<size; n++){
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  simd_float x = simd_set(scalar);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(data+n, simd_sub(simd_load(data+n), x));
+#endif
+  for(; n<size; n++){
     data[n]-=scalar;
-  } 
+  }
 }
 
 void FloatArray::multiply(FloatArray operand2, FloatArray destination){ //allows in-place
@@ -348,12 +537,16 @@ void FloatArray::multiply(FloatArray operand2, FloatArray destination){ //allows
       void 	arm_mult_f32 (float32_t *pSrcA, float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
   */
     arm_mult_f32(data, operand2.data, destination, size);
-  #else
-  for(int n=0; n<size; n++){
+#else
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(destination.data+n, simd_mul(simd_load(data+n), simd_load(operand2.data+n)));
+#endif
+  for(; n<size; n++){
     destination[n]=data[n]*operand2[n];
   }
-
-  #endif /* ARM_CORTEX */
+#endif /* ARM_CORTEX */
 }
 
 void FloatArray::multiply(FloatArray operand2){ //in-place
@@ -365,8 +558,7 @@ void FloatArray::multiply(float scalar){
 #ifdef ARM_CORTEX
   arm_scale_f32(data, scalar, data, size);
 #else
-  for(int n=0; n<size; n++)
-    data[n]*=scalar;
+  multiply(scalar, *this);
 #endif
 }
 
@@ -374,7 +566,13 @@ void FloatArray::multiply(float scalar, FloatArray destination){
 #ifdef ARM_CORTEX
   arm_scale_f32(data, scalar, destination, size);
 #else
-  for(int n=0; n<size; n++)
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  simd_float x = simd_set(scalar);
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(destination.data+n, simd_mul(simd_load(data+n), x));
+#endif
+  for(; n<size; n++)
     destination[n] = data[n] * scalar;
 #endif
 }
@@ -383,17 +581,122 @@ void FloatArray::negate(FloatArray& destination){//allows in-place
   /// @note When built for ARM Cortex-M processor series, this method uses the optimized <a href="http://www.keil.com/pack/doc/CMSIS/General/html/index.html">CMSIS library</a>
 #ifdef ARM_CORTEX
   arm_negate_f32(data, destination.getData(), size); 
-  #else
-  for(int n=0; n<size; n++){
-    destination[n]=-data[n];
+#else
+  float* dst = destination.getData();
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(dst+n, simd_neg(simd_load(data+n)));
+#endif
+  for(; n<size; n++){
+    dst[n]=-data[n];
   }
-  #endif /* ARM_CORTEX */
+#endif /* ARM_CORTEX */
 }
 void FloatArray::negate(){
   /// @note When built for ARM Cortex-M processor series, this method uses the optimized <a href="http://www.keil.com/pack/doc/CMSIS/General/html/index.html">CMSIS library</a>
   negate(*this);
 }
 
+/*
+ * Apply an element-wise function, from simd_math.h, with the vector
+ * primitives where available. CMSIS has no block versions of these
+ * functions, so on ARM the same polynomials are evaluated one element at
+ * a time on the FPU.
+ */
+template<typename Function>
+static void applyFunction(const float* source, float* destination, int size, Function function){
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(destination+n, function(simd_load(source+n)));
+#endif
+  for(; n<size; n++)
+    destination[n] = function(source[n]);
+}
+
+struct SineFunction {
+  template<typename V> V operator()(V x) const{ return simd_sinf(x); }
+};
+
+struct HyperbolicTangentFunction {
+  template<typename V> V operator()(V x) const{ return simd_tanhf(x); }
+};
+
+struct ExpFunction {
+  template<typename V> V operator()(V x) const{
+    // limited so that the result is a normal float
+    x = simd_min(simd_max(x, simd_splat<V>(-87.33f)), simd_splat<V>(88.02f));
+    return simd_pow2f(simd_mul(x, simd_splat<V>(1.44269504089f)));
+  }
+};
+
+struct Pow2Function {
+  template<typename V> V operator()(V x) const{ return simd_pow2f(x); }
+};
+
+struct Log2Function {
+  template<typename V> V operator()(V x) const{ return simd_log2f(x); }
+};
+
+struct SoftClipFunction {
+  template<typename V> V operator()(V x) const{ return simd_softclipf(x); }
+};
+
+void FloatArray::sine(FloatArray destination){
+  ASSERT(destination.size >= size, "Destination array too small");
+  applyFunction(data, destination.data, size, SineFunction());
+}
+
+void FloatArray::sine(){
+  sine(*this);
+}
+
+void FloatArray::hyperbolicTangent(FloatArray destination){
+  ASSERT(destination.size >= size, "Destination array too small");
+  applyFunction(data, destination.data, size, HyperbolicTangentFunction());
+}
+
+void FloatArray::hyperbolicTangent(){
+  hyperbolicTangent(*this);
+}
+
+void FloatArray::exp(FloatArray destination){
+  ASSERT(destination.size >= size, "Destination array too small");
+  applyFunction(data, destination.data, size, ExpFunction());
+}
+
+void FloatArray::exp(){
+  exp(*this);
+}
+
+void FloatArray::pow2(FloatArray destination){
+  ASSERT(destination.size >= size, "Destination array too small");
+  applyFunction(data, destination.data, size, Pow2Function());
+}
+
+void FloatArray::pow2(){
+  pow2(*this);
+}
+
+void FloatArray::log2(FloatArray destination){
+  ASSERT(destination.size >= size, "Destination array too small");
+  applyFunction(data, destination.data, size, Log2Function());
+}
+
+void FloatArray::log2(){
+  log2(*this);
+}
+
+void FloatArray::softClip(FloatArray destination){
+  ASSERT(destination.size >= size, "Destination array too small");
+  applyFunction(data, destination.data, size, SoftClipFunction());
+}
+
+void FloatArray::softClip(){
+  softClip(*this);
+}
+
 void FloatArray::noise(){
   noise(-1, 1);
 }
@@ -456,6 +759,92 @@ void FloatArray::convolve(FloatArray operand2, FloatArray destination, int offse
 #endif /* ARM_CORTEX */
 }
 
+/*
+ * Multiplies two spectra from FastFourierTransform::fft() into result.
+ * arm_rfft_fast_f32 returns only the first half of the spectrum, with the
+ * real valued DC and Nyquist bins packed into the first element.
+ */
+static void multiplySpectra(ComplexFloatArray a, ComplexFloatArray b, ComplexFloatArray result, int fftSize){
+#ifdef ARM_CORTEX
+  int bins = fftSize/2;
+  a.subArray(1, bins-1).complexByComplexMultiplication(b.subArray(1, bins-1), result.subArray(1, bins-1));
+  result[0].re = a[0].re*b[0].re;
+  result[0].im = a[0].im*b[0].im;
+#else
+  a.subArray(0, fftSize).complexByComplexMultiplication(b.subArray(0, fftSize), result);
+#endif /* ARM_CORTEX */
+}
+
+void FloatArray::fftConvolve(FloatArray operand2, FloatArray destination){
+  ASSERT(destination.size >= size + operand2.size -1, "Destination array too small");
+  // the shorter operand is split into segments of K samples, the longer
+  // one into blocks of B samples, with K+B-1 <= fftSize
+  FloatArray signal = *this;
+  FloatArray kernel = operand2;
+  if(kernel.size > signal.size){
+    signal = operand2;
+    kernel = *this;
+  }
+  const int maxFftSize = 4096;
+  int fftSize = 32;
+  while(fftSize < 2*kernel.size && fftSize < maxFftSize)
+    fftSize *= 2;
+  int K = min(kernel.size, fftSize/2);
+  int B = fftSize-K+1;
+  FloatArray buffer = FloatArray::create(fftSize);
+  ComplexFloatArray kernelSpectrum = ComplexFloatArray::create(fftSize);
+  ComplexFloatArray signalSpectrum = ComplexFloatArray::create(fftSize);
+  ComplexFloatArray product = ComplexFloatArray::create(fftSize);
+  if(buffer.getData() == NULL || kernelSpectrum.getData() == NULL ||
+     signalSpectrum.getData() == NULL || product.getData() == NULL){
+    // out of memory: the direct convolution needs no buffers
+    FloatArray::destroy(buffer);
+    ComplexFloatArray::destroy(kernelSpectrum);
+    ComplexFloatArray::destroy(signalSpectrum);
+    ComplexFloatArray::destroy(product);
+    convolve(operand2, destination);
+    return;
+  }
+  FastFourierTransform fft(fftSize);
+  destination.subArray(0, size+operand2.size-1).clear();
+  for(int k=0; k<kernel.size; k+=K){
+    int kernelLength = min(K, kernel.size-k);
+    buffer.clear();
+    buffer.copyFrom(kernel.getData()+k, kernelLength);
+    fft.fft(buffer, kernelSpectrum);
+    for(int b=0; b<signal.size; b+=B){
+      int blockLength = min(B, signal.size-b);
+      buffer.clear();
+      buffer.copyFrom(signal.getData()+b, blockLength);
+      fft.fft(buffer, signalSpectrum);
+      multiplySpectra(signalSpectrum, kernelSpectrum, product, fftSize);
+      fft.ifft(product, buffer);
+      FloatArray tail = destination.subArray(k+b, blockLength+kernelLength-1);
+      tail.add(buffer.subArray(0, tail.getSize()));
+    }
+  }
+  FloatArray::destroy(buffer);
+  ComplexFloatArray::destroy(kernelSpectrum);
+  ComplexFloatArray::destroy(signalSpectrum);
+  ComplexFloatArray::destroy(product);
+}
+
+void FloatArray::fftCorrelate(FloatArray operand2, FloatArray destination){
+  ASSERT(destination.size >= size+operand2.size-1, "Destination array too small");
+  destination.setAll(0);
+#ifdef ARM_CORTEX
+  // as arm_correlate_f32, which leaves the first size-operand2.size
+  // elements for the zero padding of operand2
+  int offset = max(size-operand2.size, 0);
+  ASSERT(destination.size >= offset+size+operand2.size-1, "Destination array too small");
+#else
+  int offset = 0;
+#endif /* ARM_CORTEX */
+  operand2.reverse();
+  fftConvolve(operand2, destination.subArray(offset, size+operand2.size-1));
+  operand2.reverse();
+}
+
 void FloatArray::correlate(FloatArray operand2, FloatArray destination){ 
   destination.setAll(0);
   /// @note When built for ARM Cortex-M processor series, this method uses the optimized <a href="http://www.keil.com/pack/doc/CMSIS/General/html/index.html">CMSIS library</a>
@@ -478,8 +867,18 @@ void FloatArray::correlateInitialized(FloatArray operand2, FloatArray destinatio
 }
 
 FloatArray FloatArray::create(int size){
+  traceHEAP_SITE();
   FloatArray fa(new float[size], size);
-  fa.clear();
+  if(fa.data != NULL)
+    fa.clear();
+  return fa;
+}
+
+FloatArray FloatArray::create(int size, MemoryHint hint){
+  traceHEAP_SITE();
+  FloatArray fa(new(hint) float[size], size);
+  if(fa.data != NULL)
+    fa.clear();
   return fa;
 }
 
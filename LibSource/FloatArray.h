@@ -2,6 +2,9 @@
 #define __FloatArray_h__
 
 #include <cstddef>
+#include "MemoryHint.h"
+
+template<typename E> class FloatExpression;
 
 /**
  * This class contains useful methods for manipulating arrays of floats.
@@ -16,6 +19,15 @@ public:
   FloatArray();
   FloatArray(float* data, int size);
 
+  /**
+   * Evaluate an element-wise expression into the array, in a single pass.
+   * Copying or assigning a FloatArray to another only copies the handle,
+   * but assigning an expression writes the contents.
+   * @see FloatExpression.h
+   */
+  template<typename E>
+  FloatArray& operator=(const FloatExpression<E>& expression);
+
   int getSize() const{
     return size;
   }
@@ -124,6 +136,100 @@ public:
    * Sets each element in the array to its opposite.
   */
   void negate(); 
+
+  /**
+   * Approximate sine of the array, in radians.
+   * Stores sin(x) of each element in the array into destination, with an
+   * absolute error below 2e-7 for |x| < 1000. The error increases with |x|
+   * beyond that.
+   * Not called sin() because basicmaths.h defines sin() as a macro on ARM.
+   * @param[out] destination the destination array, can be this array.
+  */
+  void sine(FloatArray destination);
+
+  /**
+   * Approximate sine of the array, in place.
+   * @see sine(FloatArray)
+  */
+  void sine();
+
+  /**
+   * Approximate hyperbolic tangent of the array.
+   * Stores tanh(x) of each element in the array into destination, with an
+   * absolute error below 5e-7. Values saturate to exactly +/-1 for |x| > 7.9.
+   * Not called tanh() because basicmaths.h defines tanh() as a macro on ARM.
+   * @param[out] destination the destination array, can be this array.
+  */
+  void hyperbolicTangent(FloatArray destination);
+
+  /**
+   * Approximate hyperbolic tangent of the array, in place.
+   * @see hyperbolicTangent(FloatArray)
+  */
+  void hyperbolicTangent();
+
+  /**
+   * Approximate exponential of the array.
+   * Stores e^x of each element in the array into destination, with a
+   * relative error below 1.5e-6 for |x| < 20, and below 2.5e-7 + |x|*6e-8
+   * in general. x is limited to about [-87.3, 88.0], where the result is
+   * a normal float, so there is no overflow to infinity or underflow to 0.
+   * @param[out] destination the destination array, can be this array.
+  */
+  void exp(FloatArray destination);
+
+  /**
+   * Approximate exponential of the array, in place.
+   * @see exp(FloatArray)
+  */
+  void exp();
+
+  /**
+   * Approximate power of 2 of the array.
+   * Stores 2^x of each element in the array into destination, with a
+   * relative error below 2.5e-7 for x in [-126, 127]. x is limited to that
+   * range.
+   * @param[out] destination the destination array, can be this array.
+  */
+  void pow2(FloatArray destination);
+
+  /**
+   * Approximate power of 2 of the array, in place.
+   * @see pow2(FloatArray)
+  */
+  void pow2();
+
+  /**
+   * Approximate base 2 logarithm of the array.
+   * Stores log2(x) of each element in the array into destination, with an
+   * absolute error below 4e-7 + |log2(x)|*6e-8. The elements must be
+   * positive normal numbers: the result for 0, negative numbers and
+   * denormals is undefined.
+   * To convert to decibels, multiply by 20*log10(2) = 6.0206.
+   * @param[out] destination the destination array, can be this array.
+  */
+  void log2(FloatArray destination);
+
+  /**
+   * Approximate base 2 logarithm of the array, in place.
+   * @see log2(FloatArray)
+  */
+  void log2();
+
+  /**
+   * Cubic soft clipping.
+   * Stores 1.5x - 0.5x^3 of each element x into destination, with x first
+   * limited to [-1, 1], so that the output is smooth and reaches +/-1 at
+   * +/-1. The gain for small signals is 1.5.
+   * @param[out] destination the destination array, can be this array.
+  */
+  void softClip(FloatArray destination);
+
+  /**
+   * Cubic soft clipping, in place.
+   * @see softClip(FloatArray)
+  */
+  void softClip();
   
   /**
    * Random values
@@ -265,10 +371,27 @@ public:
 /**
    * Convolution between arrays.
    * Sets **destination** to the result of the convolution between the array and **operand2**
+   * The result is computed directly, without allocating memory. For long
+   * operands fftConvolve() is faster: the FloatArray_convolveDirect and
+   * FloatArray_convolveFft benchmarks give the crossover on a given target.
    * @param[in] operand2 the second operand for the convolution
    * @param[out] destination array. It must have a minimum size of this+other-1.
   */
   void convolve(FloatArray operand2, FloatArray destination);
+
+  /**
+   * Convolution between arrays, using the FFT.
+   * Computes the same result as convolve(), by overlap-add of blocks of the
+   * longer operand with segments of up to 2048 elements of the shorter one,
+   * in O((M+N)log(M)) rather than O(M*N) operations.
+   * Temporary buffers of up to 112k and an FFT instance are allocated and
+   * freed on each call, so this is not suitable for processAudio(). There,
+   * a PartitionedConvolver, which allocates its state once, is preferable.
+   * If the buffers can't be allocated the result is computed directly.
+   * @param[in] operand2 the second operand for the convolution
+   * @param[out] destination array. It must have a minimum size of this+other-1.
+  */
+  void fftConvolve(FloatArray operand2, FloatArray destination);
   
   /** 
    * Partial convolution between arrays.
@@ -285,10 +408,20 @@ public:
   /** 
    * Correlation between arrays.
    * Sets **destination** to the correlation of the array and **operand2**.
+   * The result is computed directly, without allocating memory.
    * @param[in] operand2 the second operand for the correlation
    * @param[out] destination the destination array. It must have a minimum size of 2*max(srcALen, srcBLen)-1
   */
   void correlate(FloatArray operand2, FloatArray destination);
+
+  /**
+   * Correlation between arrays, using the FFT.
+   * Computes the same result as correlate() with fftConvolve(), and
+   * allocates temporary buffers in the same way.
+   * @param[in] operand2 the second operand for the correlation
+   * @param[out] destination the destination array. It must have a minimum size of 2*max(srcALen, srcBLen)-1
+  */
+  void fftCorrelate(FloatArray operand2, FloatArray destination);
   
   /**
    * Correlation between arrays.
@@ -305,6 +438,24 @@ public:
    * @param[in] value all the elements are set to this value.
   */
   void setAll(float value);
+
+  /**
+   * Linear ramp.
+   * Sets the elements of the array to values evenly spaced between **from** and **to**.
+   * The first element is one step on from **from**, and the last element is equal to **to**,
+   * so that consecutive ramps join up without repeating a value.
+   * @param[in] from the value before the first element
+   * @param[in] to the value of the last element
+  */
+  void ramp(float from, float to);
+
+  /**
+   * Exponential ramp.
+   * Like ramp(), but with a constant ratio between consecutive elements instead of a constant difference.
+   * @param[in] from the value before the first element, must be greater than 0
+   * @param[in] to the value of the last element, must be greater than 0
+  */
+  void expRamp(float from, float to);
   
   /**
    * A subset of the array.
@@ -441,9 +592,17 @@ public:
    * Allocates size*sizeof(float) bytes of memory and returns a FloatArray that points to it.
    * @param size the size of the new FloatArray.
    * @return a FloatArray which **data** point to the newly allocated memory and **size** is initialized to the proper value.
+   * If the allocation fails, **data** is NULL.
    * @remarks a FloatArray created with this method has to be destroyed invoking the FloatArray::destroy() method.
   */
   static FloatArray create(int size);
+
+  /**
+   * Creates a new FloatArray in the memory region given by hint.
+   * If no region has enough memory, **data** is NULL.
+   * @see MemoryHint
+   */
+  static FloatArray create(int size, MemoryHint hint);
   
   /**
    * Destroys a FloatArray created with the create() method.
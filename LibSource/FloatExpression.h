@@ -0,0 +1,284 @@
+#ifndef __FloatExpression_h__
+#define __FloatExpression_h__
+
+#include "FloatArray.h"
+#include "message.h"
+#include "simd.h"
+
+/**
+ * Element-wise expressions of FloatArrays and floats, evaluated in a single
+ * loop when assigned to a FloatArray.
+ * Each call to a FloatArray method such as multiply() or add() makes a full
+ * pass over the block. Building an expression with the operators +, - and *
+ * and the functions clip() and rectify() instead defers the work until the
+ * result is assigned, so that
+ * @code
+ * output = clip(input*gain + delayed*mix);
+ * @endcode
+ * reads each input once and writes output once, with no temporary arrays.
+ * Scalar operands must be float: an int added to a FloatArray is pointer
+ * arithmetic, as before.
+ * The destination can also be one of the operands. Assignment writes
+ * output.getSize() elements, and the array operands must be at least as
+ * long. Expressions hold copies of the array handles, not the data, so an
+ * expression must not outlive its arrays.
+ * On the host the loop uses the vector primitives in simd.h. On ARM it is
+ * unrolled in the same way as the CMSIS functions.
+ */
+template<typename E>
+class FloatExpression {
+public:
+  const E& self() const{
+    return static_cast<const E&>(*this);
+  }
+};
+
+/** An array operand */
+class FloatArrayExpression : public FloatExpression<FloatArrayExpression> {
+private:
+  const float* data;
+  int size;
+public:
+  FloatArrayExpression(FloatArray array) :
+    data(array.getData()), size(array.getSize()) {}
+  int getSize() const{
+    return size;
+  }
+  float get(int n) const{
+    return data[n];
+  }
+#ifdef SIMD_FLOAT_LANES
+  simd_float load(int n) const{
+    return simd_load(data+n);
+  }
+#endif
+};
+
+/** A scalar operand */
+class FloatScalarExpression : public FloatExpression<FloatScalarExpression> {
+private:
+  float value;
+public:
+  FloatScalarExpression(float x) : value(x) {}
+  int getSize() const{
+    return 0;
+  }
+  float get(int n) const{
+    return value;
+  }
+#ifdef SIMD_FLOAT_LANES
+  simd_float load(int n) const{
+    return simd_set(value);
+  }
+#endif
+};
+
+template<typename Operator, typename L, typename R>
+class FloatBinaryExpression : public FloatExpression<FloatBinaryExpression<Operator, L, R> > {
+private:
+  L left;
+  R right;
+public:
+  FloatBinaryExpression(const L& l, const R& r) :
+    left(l), right(r) {}
+  /* the shortest array operand, or 0 if there are none */
+  int getSize() const{
+    int l = left.getSize();
+    int r = right.getSize();
+    return l == 0 ? r : r == 0 ? l : min(l, r);
+  }
+  float get(int n) const{
+    return Operator::apply(left.get(n), right.get(n));
+  }
+#ifdef SIMD_FLOAT_LANES
+  simd_float load(int n) const{
+    return Operator::apply(left.load(n), right.load(n));
+  }
+#endif
+};
+
+template<typename Operator, typename E>
+class FloatUnaryExpression : public FloatExpression<FloatUnaryExpression<Operator, E> > {
+private:
+  E operand;
+  Operator op;
+public:
+  FloatUnaryExpression(const E& e, const Operator& o) :
+    operand(e), op(o) {}
+  int getSize() const{
+    return operand.getSize();
+  }
+  float get(int n) const{
+    return op(operand.get(n));
+  }
+#ifdef SIMD_FLOAT_LANES
+  simd_float load(int n) const{
+    return op(operand.load(n));
+  }
+#endif
+};
+
+struct FloatAddOperator {
+  static float apply(float a, float b){ return a+b; }
+#ifdef SIMD_FLOAT_LANES
+  static simd_float apply(simd_float a, simd_float b){ return simd_add(a, b); }
+#endif
+};
+
+struct FloatSubtractOperator {
+  static float apply(float a, float b){ return a-b; }
+#ifdef SIMD_FLOAT_LANES
+  static simd_float apply(simd_float a, simd_float b){ return simd_sub(a, b); }
+#endif
+};
+
+struct FloatMultiplyOperator {
+  static float apply(float a, float b){ return a*b; }
+#ifdef SIMD_FLOAT_LANES
+  static simd_float apply(simd_float a, simd_float b){ return simd_mul(a, b); }
+#endif
+};
+
+struct FloatNegateOperator {
+  float operator()(float x) const{ return -x; }
+#ifdef SIMD_FLOAT_LANES
+  simd_float operator()(simd_float x) const{ return simd_neg(x); }
+#endif
+};
+
+struct FloatRectifyOperator {
+  float operator()(float x) const{ return fabsf(x); }
+#ifdef SIMD_FLOAT_LANES
+  simd_float operator()(simd_float x) const{ return simd_abs(x); }
+#endif
+};
+
+struct FloatClipOperator {
+  float lo, hi;
+  FloatClipOperator(float l, float h) : lo(l), hi(h) {}
+  float operator()(float x) const{ return x > hi ? hi : x < lo ? lo : x; }
+#ifdef SIMD_FLOAT_LANES
+  simd_float operator()(simd_float x) const{ return simd_max(simd_min(x, simd_set(hi)), simd_set(lo)); }
+#endif
+};
+
+/**
+ * Maps the types that can be used as operands to their expression types.
+ * Only expressions, FloatArrays and floats can be operands, and at least
+ * one operand of each operator must be an array or an expression.
+ */
+template<typename T> struct FloatOperand {};
+
+template<> struct FloatOperand<FloatArray> {
+  typedef FloatArrayExpression type;
+  static const bool array = true;
+  static type wrap(FloatArray a){ return type(a); }
+};
+
+template<> struct FloatOperand<float> {
+  typedef FloatScalarExpression type;
+  static const bool array = false;
+  static type wrap(float x){ return type(x); }
+};
+
+template<> struct FloatOperand<FloatArrayExpression> {
+  typedef FloatArrayExpression type;
+  static const bool array = true;
+  static const type& wrap(const type& e){ return e; }
+};
+
+template<typename Operator, typename L, typename R>
+struct FloatOperand<FloatBinaryExpression<Operator, L, R> > {
+  typedef FloatBinaryExpression<Operator, L, R> type;
+  static const bool array = true;
+  static const type& wrap(const type& e){ return e; }
+};
+
+template<typename Operator, typename E>
+struct FloatOperand<FloatUnaryExpression<Operator, E> > {
+  typedef FloatUnaryExpression<Operator, E> type;
+  static const bool array = true;
+  static const type& wrap(const type& e){ return e; }
+};
+
+template<typename T, typename Array, int N> class StaticArray;
+
+template<int N> struct FloatOperand<StaticArray<float, FloatArray, N> > {
+  typedef FloatArrayExpression type;
+  static const bool array = true;
+  static type wrap(const StaticArray<float, FloatArray, N>& a){
+    return type(const_cast<StaticArray<float, FloatArray, N>&>(a).getArray());
+  }
+};
+
+template<bool Condition, typename T> struct FloatExpressionIf {};
+template<typename T> struct FloatExpressionIf<true, T> { typedef T type; };
+
+#define FLOAT_EXPRESSION_OPERATOR(symbol, Operator)			\
+  template<typename L, typename R>					\
+  typename FloatExpressionIf<FloatOperand<L>::array || FloatOperand<R>::array, \
+			     FloatBinaryExpression<Operator, typename FloatOperand<L>::type, typename FloatOperand<R>::type> >::type \
+  operator symbol(const L& left, const R& right){			\
+    return FloatBinaryExpression<Operator, typename FloatOperand<L>::type, typename FloatOperand<R>::type> \
+      (FloatOperand<L>::wrap(left), FloatOperand<R>::wrap(right));	\
+  }
+
+FLOAT_EXPRESSION_OPERATOR(+, FloatAddOperator)
+FLOAT_EXPRESSION_OPERATOR(-, FloatSubtractOperator)
+FLOAT_EXPRESSION_OPERATOR(*, FloatMultiplyOperator)
+
+#undef FLOAT_EXPRESSION_OPERATOR
+
+template<typename T>
+FloatUnaryExpression<FloatNegateOperator, typename FloatExpressionIf<FloatOperand<T>::array, typename FloatOperand<T>::type>::type>
+operator-(const T& operand){
+  return FloatUnaryExpression<FloatNegateOperator, typename FloatOperand<T>::type>(FloatOperand<T>::wrap(operand), FloatNegateOperator());
+}
+
+/** Absolute values, as FloatArray::rectify() */
+template<typename T>
+FloatUnaryExpression<FloatRectifyOperator, typename FloatExpressionIf<FloatOperand<T>::array, typename FloatOperand<T>::type>::type>
+rectify(const T& operand){
+  return FloatUnaryExpression<FloatRectifyOperator, typename FloatOperand<T>::type>(FloatOperand<T>::wrap(operand), FloatRectifyOperator());
+}
+
+/** Limit values to between -range and range, as FloatArray::clip() */
+template<typename T>
+FloatUnaryExpression<FloatClipOperator, typename FloatExpressionIf<FloatOperand<T>::array, typename FloatOperand<T>::type>::type>
+clip(const T& operand, float range = 1.0f){
+  return FloatUnaryExpression<FloatClipOperator, typename FloatOperand<T>::type>(FloatOperand<T>::wrap(operand), FloatClipOperator(-range, range));
+}
+
+/** Limit values to between lo and hi, as FloatArray::clip() */
+template<typename T>
+FloatUnaryExpression<FloatClipOperator, typename FloatExpressionIf<FloatOperand<T>::array, typename FloatOperand<T>::type>::type>
+clip(const T& operand, float lo, float hi){
+  return FloatUnaryExpression<FloatClipOperator, typename FloatOperand<T>::type>(FloatOperand<T>::wrap(operand), FloatClipOperator(lo, hi));
+}
+
+template<typename E>
+FloatArray& FloatArray::operator=(const FloatExpression<E>& expression){
+  const E& e = expression.self();
+  ASSERT(e.getSize() == 0 || e.getSize() >= size, "Array too small");
+  int n=0;
+#ifdef SIMD_FLOAT_LANES
+  for(; n+SIMD_FLOAT_LANES<=size; n+=SIMD_FLOAT_LANES)
+    simd_store(data+n, e.load(n));
+#else
+  for(; n+4<=size; n+=4){
+    float x0 = e.get(n);
+    float x1 = e.get(n+1);
+    float x2 = e.get(n+2);
+    float x3 = e.get(n+3);
+    data[n] = x0;
+    data[n+1] = x1;
+    data[n+2] = x2;
+    data[n+3] = x3;
+  }
+#endif
+  for(; n<size; n++)
+    data[n] = e.get(n);
+  return *this;
+}
+
+#endif // __FloatExpression_h__
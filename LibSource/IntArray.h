@@ -1,11 +1,19 @@
+#ifndef __IntArray_h__
+#define __IntArray_h__
+
+#include <stdint.h>
+#include "basicmaths.h"
+
 class IntArray
 {
 private:
   int32_t* data;
   int size;
 public:
-  IntArray();
-  IntArray(int32_t* data, int size);
+  IntArray() :
+    data(NULL), size(0) {}
+  IntArray(int32_t* d, int s) :
+    data(d), size(s) {}
 
   int getSize() const{
     return size;
@@ -154,9 +162,12 @@ public:
 #ifdef ARM_CORTEX
     arm_shift_q31(data, shiftValue, data, size);
 #else
-    #warning TODO
-    
-    //ASSERT(false, "TODO");
+    for(int n=0; n<size; n++){
+      int64_t value = shiftValue >= 0 ? (int64_t)data[n] << shiftValue : data[n] >> -shiftValue;
+      data[n] = value > INT32_MAX ? INT32_MAX : value < INT32_MIN ? INT32_MIN : value;
+    }
 #endif
   }
 };
+
+#endif // __IntArray_h__
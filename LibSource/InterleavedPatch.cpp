@@ -0,0 +1,36 @@
+#include "InterleavedPatch.h"
+#include "PatchProcessor.h"
+#include "SampleConversion.h"
+
+PatchProcessor* getInitialisingPatchProcessor();
+
+InterleavedPatch::InterleavedPatch(){
+  getInitialisingPatchProcessor()->setInterleavedPatch(this);
+}
+
+InterleavedPatch::~InterleavedPatch(){
+  IntArray::destroy(input);
+  IntArray::destroy(output);
+}
+
+void InterleavedPatch::processAudio(AudioBuffer& buffer){
+  int size = buffer.getSize();
+  // scratch frames are only needed when not running on interleaved codec buffers
+  if(input.getSize() < size*2){
+    IntArray::destroy(input);
+    IntArray::destroy(output);
+    input = IntArray::create(size*2);
+    output = IntArray::create(size*2);
+  }
+  FloatArray left = buffer.getSamples(LEFT_CHANNEL);
+  FloatArray right = buffer.getSamples(RIGHT_CHANNEL);
+  for(int i=0; i<size; ++i){
+    input[i*2] = sample_float_to_q31_saturate(left[i]);
+    input[i*2+1] = sample_float_to_q31_saturate(right[i]);
+  }
+  processInterleaved(IntArray(input, size*2), IntArray(output, size*2));
+  for(int i=0; i<size; ++i){
+    left[i] = sample_q31_to_float(output[i*2]);
+    right[i] = sample_q31_to_float(output[i*2+1]);
+  }
+}
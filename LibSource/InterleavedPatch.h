@@ -0,0 +1,33 @@
+#ifndef __InterleavedPatch_h__
+#define __InterleavedPatch_h__
+
+#include "Patch.h"
+#include "IntArray.h"
+
+/**
+ * Base class for patches that process interleaved stereo frames.
+ * Audio is passed as Q31 samples, L R L R..., taken directly from the codec
+ * buffers, with no de-interleaving or float conversion. This suits
+ * pass-through and routing patches such as loopers, and integer DSP in 24-bit.
+ *
+ * Subclasses implement processInterleaved() instead of processAudio().
+ * Where the audio is only available as float channels, e.g. in the web
+ * build, processAudio() converts to and from interleaved frames.
+ */
+class InterleavedPatch : public Patch {
+public:
+  InterleavedPatch();
+  virtual ~InterleavedPatch();
+  /**
+   * Process one block of interleaved frames.
+   * @param input getBlockSize() frames of 2 channels
+   * @param output getBlockSize() frames of 2 channels, may not be the same buffer as input
+   */
+  virtual void processInterleaved(IntArray input, IntArray output) = 0;
+  void processAudio(AudioBuffer& buffer);
+private:
+  IntArray input;
+  IntArray output;
+};
+
+#endif // __InterleavedPatch_h__
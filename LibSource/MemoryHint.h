@@ -0,0 +1,79 @@
+#ifndef __MemoryHint_h__
+#define __MemoryHint_h__
+
+#include <stddef.h>
+#include "heap.h"
+
+/**
+ * Placement hint for heap allocations.
+ * The heap is made up of three regions, defined in this order in main.cpp:
+ * 32k of core coupled memory (CCM), which is zero wait state but can't be
+ * reached by DMA; what remains of the internal SRAM after the program; and
+ * 1M of external SRAM, which is large but several times slower to access.
+ * Use MEMORY_FAST for small, frequently accessed state such as filter
+ * coefficients and FFT buffers, and MEMORY_BULK for delay lines, samples
+ * and anything else that is large and accessed sparsely.
+ * Allocations without a hint are first-fit, starting with CCM.
+ */
+enum MemoryHint {
+  MEMORY_FAST   = 0, // CCM
+  MEMORY_NORMAL = 1, // internal SRAM
+  MEMORY_BULK   = 2  // external SRAM
+};
+
+/**
+ * Allocate from the region given by hint. If that region is full the other
+ * regions are tried, nearest in speed first, and only if all of them are
+ * full is the memory allocation failed hook called.
+ */
+inline void* allocateMemory(size_t size, MemoryHint hint){
+  static const BaseType_t order[3][3] = {
+    { MEMORY_FAST, MEMORY_NORMAL, MEMORY_BULK },
+    { MEMORY_NORMAL, MEMORY_BULK, MEMORY_FAST },
+    { MEMORY_BULK, MEMORY_NORMAL, MEMORY_FAST }
+  };
+  for(int i=0; i<3; ++i){
+    void* ptr = pvPortMallocFrom(size, order[hint][i]);
+    if(ptr != NULL)
+      return ptr;
+  }
+  return pvPortMalloc(size);
+}
+
+/**
+ * Allocate an object with a placement hint, e.g. new(MEMORY_BULK) float[size].
+ * Release with delete as usual.
+ */
+inline void* operator new(size_t size, MemoryHint hint){
+  return allocateMemory(size, hint);
+}
+
+inline void* operator new[](size_t size, MemoryHint hint){
+  return allocateMemory(size, hint);
+}
+
+/**
+ * Attribute the allocations made while the tag is in scope to it in the
+ * heap statistics, rather than to the functions that made them, e.g.
+ * MemoryTag tag("reverb"); in a constructor. The tag must be a string
+ * constant. Does nothing unless the heap is traced, as in the renderer or
+ * firmware built with HEAPSTATS=1.
+ */
+class MemoryTag {
+#ifdef HEAP_TRACE
+private:
+  const char* previous;
+public:
+  MemoryTag(const char* tag) : previous(pcHeapTraceTag) {
+    pcHeapTraceTag = tag;
+  }
+  ~MemoryTag(){
+    pcHeapTraceTag = previous;
+  }
+#else
+public:
+  MemoryTag(const char* tag){}
+#endif
+};
+
+#endif // __MemoryHint_h__
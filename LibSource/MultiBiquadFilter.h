@@ -0,0 +1,280 @@
+#ifndef __MultiBiquadFilter_h__
+#define __MultiBiquadFilter_h__
+
+#include "FloatArray.h"
+#include "Patch.h"
+#include "BiquadFilter.h"
+#ifndef ARM_CORTEX
+#include "simd.h"
+#endif
+
+/**
+ * Cascaded Biquad Filter for several channels with the same coefficients,
+ * such as the two sides of a stereo EQ, or one filter per voice of a
+ * polyphonic synth. The channels are filtered together in one pass, rather
+ * than by one BiquadFilter each.
+ * On ARM the channels are processed in pairs with the CMSIS stereo Direct
+ * Form 2 Transposed cascade, which shares the coefficient loads between
+ * them, and an odd last channel with the mono cascade. The host build keeps
+ * the state of all channels side by side and filters SIMD_FLOAT_LANES
+ * channels at a time.
+ * @code
+ * filter = MultiBiquadFilter::create(2, 4, getBlockSize());
+ * filter->setLowPass(0.2, FilterStage::BUTTERWORTH_Q);
+ * ...
+ * filter->process(buffer);
+ * @endcode
+ * The setters below set every stage alike; each stage can also be set on
+ * its own with getFilterStage(), for instance for a multi-band EQ.
+ */
+class MultiBiquadFilter {
+private:
+  FloatArray coefficients; // stages*5, shared by all channels
+  FloatArray state; // stages*2 per channel
+  FloatArray buffer; // interleaved frames
+  int channels;
+  int stages;
+  int blockSize;
+#ifdef ARM_CORTEX
+  arm_biquad_cascade_stereo_df2T_instance_f32* pairs;
+  arm_biquad_cascade_df2T_instance_f32 last;
+#else
+  int width; // channels, rounded up to a whole number of vectors
+#endif /* ARM_CORTEX */
+
+  void copyCoefficients(){
+    for(int i=1; i<stages; ++i)
+      coefficients.subArray(i*BIQUAD_COEFFICIENTS_PER_STAGE, BIQUAD_COEFFICIENTS_PER_STAGE).copyFrom(coefficients.subArray(0, BIQUAD_COEFFICIENTS_PER_STAGE));
+  }
+
+#ifndef ARM_CORTEX
+  /* filter size interleaved frames of width channels in place */
+  void processInterleaved(float* frames, int size){
+    for(int k=0; k<stages; k++){
+      const float* c = coefficients.getData()+k*BIQUAD_COEFFICIENTS_PER_STAGE;
+      float* s1 = state.getData()+2*k*width;
+      float* s2 = s1+width;
+      int ch = 0;
+#ifdef SIMD_FLOAT_LANES
+      simd_float b0 = simd_set(c[0]);
+      simd_float b1 = simd_set(c[1]);
+      simd_float b2 = simd_set(c[2]);
+      simd_float a1 = simd_set(c[3]);
+      simd_float a2 = simd_set(c[4]);
+      for(; ch+SIMD_FLOAT_LANES<=width; ch+=SIMD_FLOAT_LANES){
+	simd_float d1 = simd_load(s1+ch);
+	simd_float d2 = simd_load(s2+ch);
+	float* p = frames+ch;
+	for(int n=0; n<size; n++, p+=width){
+	  simd_float x = simd_load(p);
+	  simd_float y = simd_add(simd_mul(b0, x), d1);
+	  d1 = simd_add(simd_add(simd_mul(b1, x), simd_mul(a1, y)), d2);
+	  d2 = simd_add(simd_mul(b2, x), simd_mul(a2, y));
+	  simd_store(p, y);
+	}
+	simd_store(s1+ch, d1);
+	simd_store(s2+ch, d2);
+      }
+#endif
+      for(; ch<width; ch++){
+	float d1 = s1[ch];
+	float d2 = s2[ch];
+	float* p = frames+ch;
+	for(int n=0; n<size; n++, p+=width){
+	  float x = *p;
+	  float y = c[0]*x + d1;
+	  d1 = c[1]*x + c[3]*y + d2;
+	  d2 = c[2]*x + c[4]*y;
+	  *p = y;
+	}
+	s1[ch] = d1;
+	s2[ch] = d2;
+      }
+    }
+  }
+#endif /* ARM_CORTEX */
+
+public:
+  MultiBiquadFilter() : channels(0), stages(0), blockSize(0) {
+#ifdef ARM_CORTEX
+    pairs = NULL;
+#endif /* ARM_CORTEX */
+  }
+
+  MultiBiquadFilter(int aChannels, int aStages, int aBlockSize){
+    init(aChannels, aStages, aBlockSize);
+  }
+
+  ~MultiBiquadFilter(){
+    FloatArray::destroy(coefficients);
+    FloatArray::destroy(state);
+    FloatArray::destroy(buffer);
+#ifdef ARM_CORTEX
+    delete[] pairs;
+#endif /* ARM_CORTEX */
+  }
+
+  void init(int aChannels, int aStages, int aBlockSize){
+    channels = aChannels;
+    stages = aStages;
+    blockSize = aBlockSize;
+    coefficients = FloatArray::create(stages*BIQUAD_COEFFICIENTS_PER_STAGE);
+#ifdef ARM_CORTEX
+    state = FloatArray::create(channels*stages*BIQUAD_STATE_VARIABLES_PER_STAGE);
+    buffer = FloatArray::create(2*blockSize);
+    pairs = new arm_biquad_cascade_stereo_df2T_instance_f32[channels/2];
+    for(int i=0; i<channels/2; i++)
+      arm_biquad_cascade_stereo_df2T_init_f32(&pairs[i], stages, coefficients.getData(), state.getData()+i*2*stages*BIQUAD_STATE_VARIABLES_PER_STAGE);
+    if(channels & 1)
+      arm_biquad_cascade_df2T_init_f32(&last, stages, coefficients.getData(), state.getData()+(channels-1)*stages*BIQUAD_STATE_VARIABLES_PER_STAGE);
+#else
+#ifdef SIMD_FLOAT_LANES
+    width = (channels+SIMD_FLOAT_LANES-1)/SIMD_FLOAT_LANES*SIMD_FLOAT_LANES;
+#else
+    width = channels;
+#endif
+    state = FloatArray::create(width*stages*BIQUAD_STATE_VARIABLES_PER_STAGE);
+    buffer = FloatArray::create(width*blockSize);
+#endif /* ARM_CORTEX */
+  }
+
+  /**
+   * Clear the state of all channels.
+   */
+  void reset(){
+    state.clear();
+  }
+
+  int getChannels(){
+    return channels;
+  }
+
+  int getStages(){
+    return stages;
+  }
+
+  /**
+   * Filter each channel of input into the same channel of output, which
+   * can be the same buffer.
+   */
+  void process(AudioBuffer& input, AudioBuffer& output){
+    int size = input.getSize();
+    ASSERT(input.getChannels() >= channels && output.getChannels() >= channels, "Too few channels");
+    ASSERT(size <= blockSize && output.getSize() == size, "Wrong size");
+#ifdef ARM_CORTEX
+    float* frames = buffer.getData();
+    for(int i=0; i<channels/2; i++){
+      float* left = input.getSamples(2*i).getData();
+      float* right = input.getSamples(2*i+1).getData();
+      for(int n=0; n<size; n++){
+	frames[2*n] = left[n];
+	frames[2*n+1] = right[n];
+      }
+      arm_biquad_cascade_stereo_df2T_f32(&pairs[i], frames, frames, size);
+      left = output.getSamples(2*i).getData();
+      right = output.getSamples(2*i+1).getData();
+      for(int n=0; n<size; n++){
+	left[n] = frames[2*n];
+	right[n] = frames[2*n+1];
+      }
+    }
+    if(channels & 1)
+      arm_biquad_cascade_df2T_f32(&last, input.getSamples(channels-1).getData(), output.getSamples(channels-1).getData(), size);
+#else
+    float* frames = buffer.getData();
+    for(int ch=0; ch<channels; ch++){
+      float* samples = input.getSamples(ch).getData();
+      for(int n=0; n<size; n++)
+	frames[n*width+ch] = samples[n];
+    }
+    processInterleaved(frames, size);
+    for(int ch=0; ch<channels; ch++){
+      float* samples = output.getSamples(ch).getData();
+      for(int n=0; n<size; n++)
+	samples[n] = frames[n*width+ch];
+    }
+#endif /* ARM_CORTEX */
+  }
+
+  /* perform in-place processing */
+  void process(AudioBuffer& samples){
+    process(samples, samples);
+  }
+
+  FloatArray getCoefficients(){
+    return coefficients;
+  }
+
+  /**
+   * Get one stage of the cascade, to set its coefficients separately, e.g.
+   * a low shelf followed by peaks:
+   * @code
+   * filter->getFilterStage(0).setLowShelf(0.01, 0.7);
+   * filter->getFilterStage(1).setPeak(0.1, 2, 0.3);
+   * @endcode
+   * The state is kept per channel, so the stage has no state array.
+   */
+  FilterStage getFilterStage(int stage){
+    ASSERT(stage < stages, "Invalid filter stage index");
+    return FilterStage(coefficients.subArray(stage*BIQUAD_COEFFICIENTS_PER_STAGE, BIQUAD_COEFFICIENTS_PER_STAGE), FloatArray());
+  }
+
+  /**
+   * Set the coefficients of all stages, stages*5 values in the order of
+   * BiquadFilter, or copy the coefficients of one stage to all stages.
+   */
+  void setCoefficients(FloatArray newCoefficients){
+    if(newCoefficients.getSize() == BIQUAD_COEFFICIENTS_PER_STAGE){
+      coefficients.subArray(0, BIQUAD_COEFFICIENTS_PER_STAGE).copyFrom(newCoefficients);
+      copyCoefficients();
+    }else{
+      ASSERT(newCoefficients.getSize() == coefficients.getSize(), "wrong size");
+      coefficients.copyFrom(newCoefficients);
+    }
+  }
+
+  void setLowPass(float fc, float q){
+    FilterStage::setLowPass(coefficients, fc, q);
+    copyCoefficients();
+  }
+
+  void setHighPass(float fc, float q){
+    FilterStage::setHighPass(coefficients, fc, q);
+    copyCoefficients();
+  }
+
+  void setBandPass(float fc, float q){
+    FilterStage::setBandPass(coefficients, fc, q);
+    copyCoefficients();
+  }
+
+  void setNotch(float fc, float q){
+    FilterStage::setNotch(coefficients, fc, q);
+    copyCoefficients();
+  }
+
+  void setPeak(float fc, float q, float gain){
+    FilterStage::setPeak(coefficients, fc, q, gain);
+    copyCoefficients();
+  }
+
+  void setLowShelf(float fc, float gain){
+    FilterStage::setLowShelf(coefficients, fc, gain);
+    copyCoefficients();
+  }
+
+  void setHighShelf(float fc, float gain){
+    FilterStage::setHighShelf(coefficients, fc, gain);
+    copyCoefficients();
+  }
+
+  static MultiBiquadFilter* create(int channels, int stages, int blockSize){
+    return new MultiBiquadFilter(channels, stages, blockSize);
+  }
+
+  static void destroy(MultiBiquadFilter* filter){
+    delete filter;
+  }
+};
+
+#endif // __MultiBiquadFilter_h__
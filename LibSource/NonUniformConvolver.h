@@ -0,0 +1,181 @@
+#ifndef __NonUniformConvolver_h__
+#define __NonUniformConvolver_h__
+
+#include "PartitionedConvolver.h"
+
+/**
+ * Convolution with a long impulse response, such as a reverb, with no
+ * latency beyond that of the block processing and an even load per block.
+ * A PartitionedConvolver with partitions of one block must do P multiply-adds
+ * of a whole spectrum for every block, which is costly at small block sizes.
+ * Here only the head of the impulse response, two blocks, uses partitions of
+ * one block. The rest is split into stages with partitions of 2, 4, 8...
+ * blocks, up to 2048 samples, two partitions per stage, and the last stage
+ * takes whatever remains. A stage with partitions of m blocks collects m
+ * blocks of input, then spreads its transform, multiply-adds and inverse
+ * over the next m blocks, so that its result is ready just as the output
+ * reaches the start of its part of the impulse response.
+ * Each stage runs at its own phase, so that the transforms of different
+ * stages fall on different blocks: the first stage does one FFT of four
+ * blocks every block, and at most one other stage does a forward or inverse
+ * FFT in any block. The worst block then costs the two FFTs and two
+ * multiply-adds of the head, one FFT of four blocks, one real FFT of at
+ * most 4096 points, and one spectrum multiply-add per stage, with
+ * P*blockSize/2048 of them, rounded up, for the P partitions of the last
+ * stage.
+ * At block sizes of 64 and below this is several times faster than a
+ * PartitionedConvolver with the same impulse response. At larger block
+ * sizes the PartitionedConvolver is as fast, and uses less memory.
+ * The partition spectra and delay lines of the stages are allocated in
+ * external SRAM, and take 16 bytes per tap in all, so 1M holds about 1.3
+ * seconds at 48kHz.
+ * @code
+ * reverb = NonUniformConvolver::create(getBlockSize(), ir.getSize());
+ * reverb->setImpulseResponse(ir);
+ * ...
+ * reverb->process(left, left);
+ * @endcode
+ */
+class NonUniformConvolver {
+private:
+  static const int MAX_PARTITION_SIZE = 2048;
+  static const int MAX_STAGES = 8;
+  class Stage {
+  public:
+    PartitionedConvolver* convolver;
+    FloatArray input; // m blocks of input
+    FloatArray output; // m blocks of output, read one block at a time
+    int offset; // in the impulse response
+    int length;
+    int steps; // m
+    int shift; // added to the block counter to give the phase of this stage
+  };
+  PartitionedConvolver* head;
+  Stage stages[MAX_STAGES];
+  int stageCount;
+  int activeStages;
+  int blockSize;
+  int counter; // blocks since reset, modulo the largest m
+
+public:
+  NonUniformConvolver() : head(NULL), stageCount(0), activeStages(0), blockSize(0), counter(0) {}
+
+  NonUniformConvolver(int aBlockSize, int maxLength){
+    init(aBlockSize, maxLength);
+  }
+
+  ~NonUniformConvolver(){
+    PartitionedConvolver::destroy(head);
+    for(int i=0; i<stageCount; i++){
+      PartitionedConvolver::destroy(stages[i].convolver);
+      FloatArray::destroy(stages[i].input);
+      FloatArray::destroy(stages[i].output);
+    }
+  }
+
+  /**
+   * Allocate the buffers for impulse responses of up to maxLength samples.
+   */
+  void init(int aBlockSize, int maxLength){
+    blockSize = aBlockSize;
+    int offset = min(2*blockSize, maxLength);
+    if(2*blockSize > MAX_PARTITION_SIZE)
+      offset = maxLength;
+    head = PartitionedConvolver::create(blockSize, offset, MEMORY_FAST);
+    stageCount = 0;
+    // with two partitions per stage, a stage with partitions of M samples
+    // starts at 2M-2*blockSize, which is when its first result is ready
+    for(int size=2*blockSize; offset<maxLength && size<=MAX_PARTITION_SIZE; size*=2){
+      Stage& stage = stages[stageCount++];
+      stage.offset = offset;
+      stage.length = size == MAX_PARTITION_SIZE ? maxLength-offset : min(2*size, maxLength-offset);
+      stage.steps = size/blockSize;
+      // transform when counter % m == m/2-2, and inverse one block before:
+      // each stage then takes two of the blocks that the smaller stages leave free
+      stage.shift = stage.steps/2+1;
+      stage.convolver = PartitionedConvolver::create(size, stage.length, MEMORY_BULK);
+      stage.input = FloatArray::create(size, MEMORY_NORMAL);
+      stage.output = FloatArray::create(size, MEMORY_NORMAL);
+      offset += stage.length;
+    }
+    activeStages = 0;
+    reset();
+  }
+
+  /**
+   * Set the impulse response, of up to maxLength samples.
+   * This takes about one FFT per partition, so is best done in the patch
+   * constructor.
+   */
+  void setImpulseResponse(FloatArray impulse){
+    head->setImpulseResponse(impulse.subArray(0, min(impulse.getSize(), stageCount ? stages[0].offset : impulse.getSize())));
+    activeStages = 0;
+    for(int i=0; i<stageCount; i++){
+      Stage& stage = stages[i];
+      if(impulse.getSize() > stage.offset){
+	stage.convolver->setImpulseResponse(impulse.subArray(stage.offset, min(stage.length, impulse.getSize()-stage.offset)));
+	activeStages = i+1;
+      }else{
+	stage.convolver->setImpulseResponse(FloatArray());
+      }
+    }
+  }
+
+  /**
+   * Clear the input history.
+   */
+  void reset(){
+    head->reset();
+    for(int i=0; i<stageCount; i++){
+      stages[i].convolver->reset();
+      // the first collection is partial when the stage phase is shifted
+      stages[i].input.clear();
+      stages[i].output.clear();
+    }
+    counter = 0;
+  }
+
+  int getBlockSize(){
+    return blockSize;
+  }
+
+  /**
+   * Convolve one block of input, which can be the same array as output.
+   */
+  void process(FloatArray input, FloatArray output){
+    ASSERT(input.getSize() == blockSize && output.getSize() == blockSize, "Wrong block size");
+    for(int i=0; i<activeStages; i++){
+      Stage& stage = stages[i];
+      int phase = (counter + stage.shift) % stage.steps;
+      stage.input.subArray(phase*blockSize, blockSize).copyFrom(input);
+    }
+    head->process(input, output);
+    for(int i=0; i<activeStages; i++){
+      Stage& stage = stages[i];
+      int phase = (counter + stage.shift) % stage.steps;
+      // step 0 is when the input is complete, step m-1 is one block
+      // before the next input is complete
+      int step = phase == stage.steps-1 ? 0 : phase+1;
+      int partitions = stage.convolver->getPartitions();
+      if(step == 0)
+	stage.convolver->transform(stage.input);
+      stage.convolver->accumulate(step*partitions/stage.steps, (step+1)*partitions/stage.steps);
+      if(step == stage.steps-1)
+	stage.convolver->inverse(stage.output);
+      // the inverse gives the output for this block and the next m-1
+      int read = step == stage.steps-1 ? 0 : step+1;
+      output.add(stage.output.subArray(read*blockSize, blockSize));
+    }
+    counter = (counter+1) % (MAX_PARTITION_SIZE/blockSize*2);
+  }
+
+  static NonUniformConvolver* create(int blockSize, int maxLength){
+    return new NonUniformConvolver(blockSize, maxLength);
+  }
+
+  static void destroy(NonUniformConvolver* convolver){
+    delete convolver;
+  }
+};
+
+#endif // __NonUniformConvolver_h__
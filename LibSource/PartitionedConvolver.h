@@ -0,0 +1,213 @@
+#ifndef __PartitionedConvolver_h__
+#define __PartitionedConvolver_h__
+
+#include "FloatArray.h"
+#include "ComplexFloatArray.h"
+#include "FastFourierTransform.h"
+
+/**
+ * Convolution with a long impulse response, such as a speaker cabinet or
+ * a room, with no latency beyond that of the block processing.
+ * The impulse response is split into partitions of one block, and each
+ * block of input is transformed once, with an FFT of twice the block size,
+ * and kept in a frequency domain delay line. The output is the sum of the
+ * products of the last P input spectra with the P partition spectra,
+ * transformed back with the overlap-save method. The cost per block is
+ * two FFTs and P complex multiply-adds, rather than the taps*blocksize
+ * multiply-adds of a FirFilter.
+ * The block size must be a power of two from 16 to 2048, and each call to
+ * process() takes exactly one block. The partition spectra and the delay
+ * line each take 8 bytes per tap, so 100ms of impulse response at 48kHz
+ * needs 75k.
+ * @code
+ * convolver = PartitionedConvolver::create(getBlockSize(), 4800);
+ * convolver->setImpulseResponse(ir);
+ * ...
+ * convolver->process(buffer.getSamples(LEFT_CHANNEL), buffer.getSamples(LEFT_CHANNEL));
+ * @endcode
+ */
+class PartitionedConvolver {
+private:
+  FastFourierTransform fft;
+  int blockSize;
+  int bins; // complex values in a spectrum
+  int partitions; // allocated
+  int activePartitions; // used by the current impulse response
+  int position; // of the newest input spectrum in the delay line
+  ComplexFloatArray filter; // partition spectra
+  ComplexFloatArray delayLine; // input spectra
+  FloatArray window; // the last two blocks of input
+  FloatArray buffer;
+  ComplexFloatArray spectrum;
+  ComplexFloatArray accumulator;
+
+  ComplexFloatArray getPartition(ComplexFloatArray spectra, int index){
+    return spectra.subArray(index*bins, bins);
+  }
+
+  /**
+   * Adds the product of two spectra to accumulator.
+   * arm_rfft_fast_f32 returns only the first half of the spectrum, with the
+   * real valued DC and Nyquist bins packed into the first element, which
+   * have to be multiplied separately. CMSIS has no complex multiply-add,
+   * so on ARM the product goes through spectrum as scratch.
+   */
+  void multiplyAccumulate(ComplexFloatArray a, ComplexFloatArray b){
+#ifdef ARM_CORTEX
+    ComplexFloatArray product = spectrum.subArray(0, bins);
+    a.complexByComplexMultiplication(b, product);
+    product[0].re = a[0].re*b[0].re;
+    product[0].im = a[0].im*b[0].im;
+    FloatArray((float*)accumulator.getData(), 2*bins).add(FloatArray((float*)product.getData(), 2*bins));
+#else
+    ComplexFloat* x = a.getData();
+    ComplexFloat* y = b.getData();
+    ComplexFloat* z = accumulator.getData();
+    for(int n=0; n<bins; n++){
+      z[n].re += x[n].re*y[n].re - x[n].im*y[n].im;
+      z[n].im += x[n].re*y[n].im + x[n].im*y[n].re;
+    }
+#endif /* ARM_CORTEX */
+  }
+
+public:
+  PartitionedConvolver() : blockSize(0), bins(0), partitions(0), activePartitions(0), position(0) {}
+
+  PartitionedConvolver(int aBlockSize, int maxLength, MemoryHint hint = MEMORY_NORMAL) {
+    init(aBlockSize, maxLength, hint);
+  }
+
+  /**
+   * Allocate the buffers for impulse responses of up to maxLength samples.
+   * The partition spectra and the delay line are allocated from the region
+   * given by hint, and the working buffers from CCM.
+   */
+  void init(int aBlockSize, int maxLength, MemoryHint hint = MEMORY_NORMAL){
+    ASSERT(aBlockSize >= 16 && aBlockSize <= 2048 && (aBlockSize & (aBlockSize-1)) == 0, "Unsupported block size");
+    blockSize = aBlockSize;
+    fft.init(2*blockSize);
+#ifdef ARM_CORTEX
+    bins = blockSize;
+#else
+    // the spectrum of a real signal is conjugate symmetric, so only the
+    // first half, up to and including the Nyquist bin, is kept
+    bins = blockSize+1;
+#endif /* ARM_CORTEX */
+    partitions = (maxLength+blockSize-1)/blockSize;
+    activePartitions = 0;
+    filter = ComplexFloatArray::create(partitions*bins, hint);
+    delayLine = ComplexFloatArray::create(partitions*bins, hint);
+    window = FloatArray::create(2*blockSize, MEMORY_FAST);
+    buffer = FloatArray::create(2*blockSize, MEMORY_FAST);
+    spectrum = ComplexFloatArray::create(2*blockSize, MEMORY_FAST);
+    accumulator = ComplexFloatArray::create(2*blockSize, MEMORY_FAST);
+    reset();
+  }
+
+  /**
+   * Set the impulse response, of up to maxLength samples.
+   * Computes the partition spectra, which takes about one FFT per partition,
+   * so this is best done in the patch constructor. The input history is
+   * kept, so that changing the impulse response while running doesn't
+   * click more than necessary.
+   */
+  void setImpulseResponse(FloatArray impulse){
+    ASSERT(impulse.getSize() <= partitions*blockSize, "Impulse response too long");
+    activePartitions = (impulse.getSize()+blockSize-1)/blockSize;
+    for(int p=0; p<activePartitions; p++){
+      int length = min(blockSize, impulse.getSize()-p*blockSize);
+      buffer.clear();
+      buffer.copyFrom(impulse.getData()+p*blockSize, length);
+      fft.fft(buffer, spectrum);
+      getPartition(filter, p).copyFrom(spectrum.getData(), bins);
+    }
+  }
+
+  /**
+   * Clear the input history.
+   */
+  void reset(){
+    delayLine.clear();
+    window.clear();
+    accumulator.clear();
+    position = 0;
+  }
+
+  int getBlockSize(){
+    return blockSize;
+  }
+
+  /**
+   * Convolve one block of input, which can be the same array as output.
+   */
+  void process(FloatArray input, FloatArray output){
+    transform(input);
+    accumulate(0, activePartitions);
+    inverse(output);
+  }
+
+  /**
+   * The three steps of process(), which can be spread over several calls
+   * to even out the load of a long impulse response: transform() a block
+   * of input, accumulate() the products with all of the partitions, in as
+   * many parts as needed, then get the result with inverse().
+   */
+  void transform(FloatArray input){
+    ASSERT(input.getSize() == blockSize, "Wrong block size");
+    // slide the window of two blocks along
+    window.copyFrom(window.getData()+blockSize, blockSize);
+    window.subArray(blockSize, blockSize).copyFrom(input);
+    buffer.copyFrom(window);
+    position = position == 0 ? partitions-1 : position-1;
+    fft.fft(buffer, spectrum);
+    getPartition(delayLine, position).copyFrom(spectrum.getData(), bins);
+    accumulator.clear();
+  }
+
+  /**
+   * Add the products for partitions from, up to but not including to.
+   */
+  void accumulate(int from, int to){
+    to = min(to, activePartitions);
+    for(int p=from; p<to; p++){
+      int index = position+p < partitions ? position+p : position+p-partitions;
+      multiplyAccumulate(getPartition(delayLine, index), getPartition(filter, p));
+    }
+  }
+
+  void inverse(FloatArray output){
+    ASSERT(output.getSize() == blockSize, "Wrong block size");
+#ifndef ARM_CORTEX
+    for(int n=1; n<blockSize; n++){
+      accumulator[2*blockSize-n].re = accumulator[n].re;
+      accumulator[2*blockSize-n].im = -accumulator[n].im;
+    }
+#endif /* ARM_CORTEX */
+    // the first block of the circular convolution is aliased, the second
+    // is the linear convolution
+    fft.ifft(accumulator, buffer);
+    output.copyFrom(buffer.getData()+blockSize, blockSize);
+  }
+
+  int getPartitions(){
+    return activePartitions;
+  }
+
+  static PartitionedConvolver* create(int blockSize, int maxLength, MemoryHint hint = MEMORY_NORMAL){
+    return new PartitionedConvolver(blockSize, maxLength, hint);
+  }
+
+  static void destroy(PartitionedConvolver* convolver){
+    if(convolver == NULL)
+      return;
+    ComplexFloatArray::destroy(convolver->filter);
+    ComplexFloatArray::destroy(convolver->delayLine);
+    FloatArray::destroy(convolver->window);
+    FloatArray::destroy(convolver->buffer);
+    ComplexFloatArray::destroy(convolver->spectrum);
+    ComplexFloatArray::destroy(convolver->accumulator);
+    delete convolver;
+  }
+};
+
+#endif // __PartitionedConvolver_h__
@@ -41,6 +41,13 @@ float Patch::getParameterValue(PatchParameterId pid){
   return 0.0f;
 }
 
+FloatArray Patch::getParameterRamp(PatchParameterId pid, bool exponential){
+  float value = getParameterValue(pid);
+  if(exponential)
+    value = max(value, 1.0f/4096);
+  return getInitialisingPatchProcessor()->getParameterRamp(pid, value, exponential);
+}
+
 void Patch::setParameterValue(PatchParameterId pid, float value){
   if(getProgramVector()->hardware_version == OWL_MODULAR_HARDWARE && pid < 4)
     doSetPatchParameter(pid, 4095 - (int16_t)(value*4096.0f));
@@ -65,6 +72,10 @@ AudioBuffer* Patch::createMemoryBuffer(int channels, int samples){
   return AudioBuffer::create(channels, samples);
 }
 
+AudioBuffer* Patch::createMemoryBuffer(int channels, int samples, MemoryHint hint){
+  return AudioBuffer::create(channels, samples, hint);
+}
+
 #define DWT_CYCCNT ((volatile unsigned int *)0xE0001004)
 
 float Patch::getElapsedBlockTime(){
@@ -80,6 +91,10 @@ AudioBuffer* AudioBuffer::create(int channels, int samples){
   return new ManagedMemoryBuffer(channels, samples);
 }
 
+AudioBuffer* AudioBuffer::create(int channels, int samples, MemoryHint hint){
+  return new ManagedMemoryBuffer(channels, samples, hint);
+}
+
 FloatParameter Patch::getParameter(const char* name, float defaultValue){
   return getFloatParameter(name, 0.0f, 1.0f, defaultValue, 0.0f, 0.0f, LIN);
 }
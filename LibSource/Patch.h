@@ -74,6 +74,7 @@ public:
   virtual int getSize() = 0;
   virtual void clear() = 0;
   static AudioBuffer* create(int channels, int samples);
+  static AudioBuffer* create(int channels, int samples, MemoryHint hint);
 };
 
 class Patch {
@@ -97,6 +98,14 @@ public:
   IntParameter getIntParameter(const char* name, int min, int max, int defaultValue=0, float lambda=0.0f, float delta=0.0, float skew=LIN);
   void registerParameter(PatchParameterId pid, const char* name);
   float getParameterValue(PatchParameterId pid);
+  /**
+   * Get a block of per-sample values for a parameter, interpolated from the
+   * value at the previous block to the current value of getParameterValue().
+   * The ramp is computed once per block and shared by all callers, so the
+   * returned array must not be modified. Exponential ramps are floored at
+   * one parameter step, 1/4096, since they can't start or end at zero.
+   */
+  FloatArray getParameterRamp(PatchParameterId pid, bool exponential=false);
   void setParameterValue(PatchParameterId pid, float value);
   bool isButtonPressed(PatchButtonId bid);
   /** @deprecated */
@@ -105,11 +114,25 @@ public:
   int getBlockSize();
   float getSampleRate();
   AudioBuffer* createMemoryBuffer(int channels, int samples);
+  /** Create a buffer in the memory region given by hint, e.g. MEMORY_BULK for long delay lines */
+  AudioBuffer* createMemoryBuffer(int channels, int samples, MemoryHint hint);
   float getElapsedBlockTime();
   int getElapsedCycles();
+  /**
+   * Button, MIDI note and encoder events are queued as they arrive and
+   * delivered before the next call to processAudio(), in the order received.
+   * @param samples the offset into the block at which the event should take effect,
+   * so that patches can split their processing for sample accurate timing
+   */
   virtual void encoderChanged(PatchParameterId pid, int16_t delta, uint16_t samples){};
   virtual void buttonChanged(PatchButtonId bid, uint16_t value, uint16_t samples){}
-  /* virtual void parameterChanged(PatchParameterId pid, float value, int samples){} */
+  /**
+   * Called once per block, before processAudio(), for each parameter whose value has changed.
+   * Use this for derived work, such as computing filter coefficients, that need only be done when a knob moves.
+   * Parameters are read once per block, so there is no sample offset as there is for buttons.
+   * @param value the new value, as returned by getParameterValue()
+   */
+  virtual void parameterChanged(PatchParameterId pid, float value){}
   virtual void processAudio(AudioBuffer& output) = 0;
 };
 
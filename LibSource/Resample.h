@@ -1,72 +1,239 @@
 #ifndef __Resample_h__
 #define __Resample_h__
 
-#include "BiquadFilter.h"
-#
+#include "FloatArray.h"
+
 /**
-   Implements 4x oversampling
-*/  
-class Resampler {
+ * Halfband lowpass filter for 2x upsampling and downsampling.
+ * A halfband FIR has every other coefficient zero except the centre one,
+ * which is 0.5, so the polyphase form only multiplies by the K distinct
+ * non-zero coefficients, for each pair of samples at the higher rate, and
+ * never by the zeros that upsampling inserts. The up and down directions
+ * have separate state, so one filter serves both sides of an oversampled
+ * process.
+ */
+class HalfbandFilter {
 private:
-  BiquadFilter *downfilter;
-  BiquadFilter *upfilter;
-  int factor=4;
-  int upsampleStages;
-  int downsampleStages;
+  const float* coefficients; // c[j] = h[2j+1] = h[-2j-1]
+  int K;
+  int blockSize;
+  FloatArray upBuffer; // 2K-1 samples of history, then the input
+  FloatArray downBuffer; // 4K-2 samples of history, then the input
 public:
-  Resampler():upsampleStages(1), downsampleStages(1){
-    // two filters: same coefficients, different state variables
-    init();
+  HalfbandFilter() : coefficients(NULL), K(0), blockSize(0) {}
+
+  ~HalfbandFilter(){
+    FloatArray::destroy(upBuffer);
+    FloatArray::destroy(downBuffer);
   }
-  Resampler(int stages){
-    upsampleStages=stages;
-    downsampleStages=stages;
-    init();
+
+  /**
+   * @param aCoefficients the K distinct odd coefficients, h[1], h[3]...
+   * @param aBlockSize the largest input to upsample(), and half the largest
+   * input to downsample()
+   */
+  void init(const float* aCoefficients, int aK, int aBlockSize){
+    coefficients = aCoefficients;
+    K = aK;
+    blockSize = aBlockSize;
+    upBuffer = FloatArray::create(2*K-1+blockSize);
+    downBuffer = FloatArray::create(4*K-2+2*blockSize);
   }
-  Resampler(int aUpsampleStages, int aDownsampleStages){
-    upsampleStages=aUpsampleStages;
-    downsampleStages=aDownsampleStages;
-    init();
+
+  void reset(){
+    upBuffer.clear();
+    downBuffer.clear();
   }
-  ~Resampler(){
-    BiquadFilter::destroy(upfilter);
-    BiquadFilter::destroy(downfilter);
-  }
-  void init(){
-    upfilter=BiquadFilter::create(upsampleStages);
-    downfilter=BiquadFilter::create(downsampleStages);
-    // [B, A]=cheby1(2, 2, 0.25); then use [B, -A(2:end)] , note the minus sign in front of the A coefficients!!!!
-    //alternatively, we could use FilterStage to compute the coefficients
-    static float downCoeffs[5]={0.07609109, 0.15218218, 0.07609109, +1.16511283,  -0.54828486};
-    static float upCoeffs[5]={0.07609109, 0.15218218, 0.07609109, +1.16511283,  -0.54828486};
-    for(int n=0; n<3; n++){
-      upCoeffs[n]=downCoeffs[n]*factor; //compensate for the gain loss due to zero-stuffing, gives unitary gain after upsampling
-    }
-    for(int n=3; n<5; n++){
-      upCoeffs[n]=downCoeffs[n];
+
+  /**
+   * Upsample input into output, which must be twice the size.
+   * Output can overlap input. The delay is 2K-1 samples at the output rate.
+   */
+  void upsample(FloatArray input, FloatArray output){
+    int size = input.getSize();
+    ASSERT(size <= blockSize && output.getSize() == 2*size, "Wrong size");
+    const int history = 2*K-1;
+    upBuffer.subArray(history, size).copyFrom(input);
+    float* out = output.getData();
+    for(int i=0; i<size; i++){
+      const float* p = upBuffer.getData()+i+K;
+      float y = 0;
+      for(int j=0; j<K; j++)
+	y += coefficients[j]*(p[-1-j] + p[j]);
+      *out++ = 2*y;
+      *out++ = p[0];
     }
-    downfilter->setCoefficients(FloatArray(downCoeffs,5));
-    upfilter->setCoefficients(FloatArray(upCoeffs,5));
+    upBuffer.move(size, 0, history);
   }
+
+  /**
+   * Downsample input into output, which must be half the size.
+   * Output can overlap input. The delay is 2K-1 samples at the input rate.
+   */
   void downsample(FloatArray input, FloatArray output){
-    ASSERT(input.getSize()==output.getSize()*factor, "wrong size");
-    downfilter->process(input, input.getSize());
-    float* p = (float*)input;
-    for(int i=0; i<input.getSize(); ++i){
-      output[i] = *p;
-      p += 4;
+    int size = output.getSize();
+    ASSERT(size <= blockSize && input.getSize() == 2*size, "Wrong size");
+    const int history = 4*K-2;
+    downBuffer.subArray(history, 2*size).copyFrom(input);
+    float* out = output.getData();
+    for(int i=0; i<size; i++){
+      const float* q = downBuffer.getData()+2*i+2*K-1;
+      float y = 0.5f*q[0];
+      for(int j=0; j<K; j++)
+	y += coefficients[j]*(q[-2*j-1] + q[2*j+1]);
+      out[i] = y;
     }
+    downBuffer.move(2*size, 0, history);
+  }
+
+  int getDelay(){
+    return 2*K-1;
+  }
+};
+
+/**
+ * Oversampling by 2, 4, 8 or 16, with a cascade of polyphase halfband
+ * filters.
+ * The first stage, between the base rate and 2x, has the steep filter: 59
+ * taps, flat to within 3e-5 up to 0.4 of the base sample rate, and more
+ * than 90dB down from 0.6. The later stages only have to remove what would
+ * fold back below that, and have 23, 15 and 15 taps. All of them reject
+ * images and aliases by at least 85dB.
+ * Work is only done for the samples that are not zero, so 4x costs 27
+ * multiplies per base rate sample in each direction.
+ * @code
+ * resampler = Resampler::create(4, getBlockSize());
+ * upsampled = FloatArray::create(4*getBlockSize());
+ * ...
+ * resampler->upsample(samples, upsampled);
+ * upsampled.hyperbolicTangent();
+ * resampler->downsample(upsampled, samples);
+ * @endcode
+ */
+class Resampler {
+private:
+  static const int MAX_STAGES = 4;
+  HalfbandFilter stages[MAX_STAGES];
+  int stageCount;
+  int factor;
+  int blockSize;
+  FloatArray scratch;
+
+  static const float* getCoefficients(int stage, int& K){
+    // Kaiser windowed, normalised to unity gain at DC
+    static const float stage1[] = {
+      3.166907650e-01f, -1.013286864e-01f, 5.598582783e-02f, -3.528737272e-02f, 2.316439736e-02f,
+      -1.525931665e-02f, 9.879672179e-03f, -6.194225031e-03f, 3.710875370e-03f, -2.093491523e-03f,
+      1.091365877e-03f, -5.110392012e-04f, 2.044069638e-04f, -6.231278510e-05f, 9.133683085e-06f };
+    static const float stage2[] = {
+      3.055459533e-01f, -7.296824263e-02f, 2.168537119e-02f, -4.823017834e-03f, 5.669651864e-04f,
+      -7.029176778e-06f };
+    static const float stage3[] = {
+      2.966320987e-01f, -5.477643685e-02f, 8.330443179e-03f, -1.861050238e-04f };
+    static const float stage4[] = {
+      2.897041656e-01f, -4.384908972e-02f, 4.166385525e-03f, -2.146136804e-05f };
+    switch(stage){
+    case 0:
+      K = 15;
+      return stage1;
+    case 1:
+      K = 6;
+      return stage2;
+    case 2:
+      K = 4;
+      return stage3;
+    default:
+      K = 4;
+      return stage4;
+    }
+  }
+
+  /* not implemented: a Resampler needs a factor and block size to allocate its buffers */
+  Resampler();
+
+  /*
+   * Private, so that code written for the biquad Resampler(upsampleStages,
+   * downsampleStages) fails to compile rather than at run time: use create()
+   */
+  Resampler(int aFactor, int aBlockSize){
+    init(aFactor, aBlockSize);
   }
+
+public:
+  ~Resampler(){
+    FloatArray::destroy(scratch);
+  }
+
+  /**
+   * @param aFactor the oversampling factor, 2, 4, 8 or 16
+   * @param aBlockSize the largest block at the base rate
+   */
+  void init(int aFactor, int aBlockSize){
+    ASSERT(aFactor == 2 || aFactor == 4 || aFactor == 8 || aFactor == 16, "Unsupported factor");
+    factor = aFactor;
+    blockSize = aBlockSize;
+    stageCount = 0;
+    for(int f=factor; f>1; f/=2){
+      int K;
+      const float* coefficients = getCoefficients(stageCount, K);
+      stages[stageCount].init(coefficients, K, blockSize << stageCount);
+      stageCount++;
+    }
+    scratch = FloatArray::create(factor*blockSize/2);
+  }
+
+  void reset(){
+    for(int i=0; i<stageCount; i++)
+      stages[i].reset();
+  }
+
+  int getFactor(){
+    return factor;
+  }
+
+  /**
+   * The delay of upsample() followed by downsample(), in samples at the base
+   * rate. It is not always a whole number of samples.
+   */
+  float getLatency(){
+    float latency = 0;
+    for(int i=0; i<stageCount; i++)
+      latency += 2*stages[i].getDelay()/(float)(2 << i);
+    return latency;
+  }
+
+  /**
+   * Upsample input into output, which must be factor times the size.
+   */
   void upsample(FloatArray input, FloatArray output){
-    ASSERT(input.getSize()*factor==output.getSize(), "wrong size");
-    float* p = output;
-    for(int i=0; i<input.getSize(); ++i){
-      *p++ = input[i];
-      *p++ = 0;
-      *p++ = 0;
-      *p++ = 0;
+    ASSERT(input.getSize() <= blockSize && output.getSize() == input.getSize()*factor, "Wrong size");
+    // each stage copies its input before writing, so they can all work in output
+    for(int i=0, size=input.getSize(); i<stageCount; i++, size*=2){
+      FloatArray out = output.subArray(0, 2*size);
+      stages[i].upsample(input, out);
+      input = out;
     }
-    upfilter->process(output, output.getSize());
+  }
+
+  /**
+   * Downsample input into output, which must be 1/factor of the size.
+   * Input is left unchanged.
+   */
+  void downsample(FloatArray input, FloatArray output){
+    ASSERT(output.getSize() <= blockSize && input.getSize() == output.getSize()*factor, "Wrong size");
+    for(int i=stageCount-1, size=input.getSize()/2; i>=0; i--, size/=2){
+      FloatArray out = i == 0 ? output : scratch.subArray(0, size);
+      stages[i].downsample(input, out);
+      input = out;
+    }
+  }
+
+  static Resampler* create(int factor, int blockSize){
+    return new Resampler(factor, blockSize);
+  }
+
+  static void destroy(Resampler* resampler){
+    delete resampler;
   }
 };
 
@@ -606,6 +606,7 @@ void ShortArray::shift(int shiftValue){
   }
 
 ShortArray ShortArray::create(int size){
+  traceHEAP_SITE();
   ShortArray fa(new int16_t[size], size);
   fa.clear();
   return fa;
@@ -616,7 +617,9 @@ void ShortArray::destroy(ShortArray array){
 }
 
 void ShortArray::setFloatValue(uint32_t n, float value){
-  data[n] = value * -SHRT_MIN;
+  // saturate like arm_float_to_q15() rather than wrap around at +1.0
+  int32_t q = value * -SHRT_MIN;
+  data[n] = q > SHRT_MAX ? SHRT_MAX : q < SHRT_MIN ? SHRT_MIN : q;
 }
 
 float ShortArray::getFloatValue(uint32_t n){
@@ -0,0 +1,54 @@
+#include "ShortPatch.h"
+#include "PatchProcessor.h"
+
+PatchProcessor* getInitialisingPatchProcessor();
+
+class ManagedShortBuffer : public ShortAudioBuffer {
+private:
+  ShortArray left;
+  ShortArray right;
+public:
+  ManagedShortBuffer(int size)
+    : left(ShortArray::create(size)), right(ShortArray::create(size)) {}
+  ~ManagedShortBuffer(){
+    ShortArray::destroy(left);
+    ShortArray::destroy(right);
+  }
+  ShortArray getSamples(int channel){
+    return channel == LEFT_CHANNEL ? left : right;
+  }
+  int getChannels(){
+    return 2;
+  }
+  int getSize(){
+    return left.getSize();
+  }
+  void clear(){
+    left.clear();
+    right.clear();
+  }
+};
+
+ShortPatch::ShortPatch() : samples(NULL) {
+  getInitialisingPatchProcessor()->setShortPatch(this);
+}
+
+ShortPatch::~ShortPatch(){
+  delete samples;
+}
+
+void ShortPatch::processAudio(AudioBuffer& buffer){
+  int size = buffer.getSize();
+  // scratch buffer is only needed when not running in a fixed-point build
+  if(samples == NULL || samples->getSize() != size){
+    delete samples;
+    samples = new ManagedShortBuffer(size);
+  }
+  ShortArray left = samples->getSamples(LEFT_CHANNEL);
+  ShortArray right = samples->getSamples(RIGHT_CHANNEL);
+  left.copyFrom(buffer.getSamples(LEFT_CHANNEL));
+  right.copyFrom(buffer.getSamples(RIGHT_CHANNEL));
+  processAudio(*samples);
+  left.copyTo(buffer.getSamples(LEFT_CHANNEL));
+  right.copyTo(buffer.getSamples(RIGHT_CHANNEL));
+}
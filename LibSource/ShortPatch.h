@@ -0,0 +1,38 @@
+#ifndef __ShortPatch_h__
+#define __ShortPatch_h__
+
+#include "Patch.h"
+#include "ShortArray.h"
+
+/**
+ * Audio buffer of Q15 channels, the fixed-point counterpart of AudioBuffer.
+ */
+class ShortAudioBuffer {
+public:
+  virtual ~ShortAudioBuffer(){}
+  virtual ShortArray getSamples(int channel) = 0;
+  virtual int getChannels() = 0;
+  virtual int getSize() = 0;
+  virtual void clear() = 0;
+};
+
+/**
+ * Base class for fixed-point patches, which process Q15 ShortArray channels.
+ *
+ * Subclasses implement processAudio(ShortAudioBuffer&). When the program is
+ * built with FIXEDPOINT=1 the codec samples are converted straight to Q15
+ * and no float buffers are used at all. In a floating point build, or in
+ * the web build, the float channels are converted to and from Q15 with
+ * saturation around each call.
+ */
+class ShortPatch : public Patch {
+public:
+  ShortPatch();
+  virtual ~ShortPatch();
+  virtual void processAudio(ShortAudioBuffer& buffer) = 0;
+  void processAudio(AudioBuffer& buffer);
+private:
+  ShortAudioBuffer* samples;
+};
+
+#endif // __ShortPatch_h__
@@ -0,0 +1,107 @@
+#ifndef __StaticArray_h__
+#define __StaticArray_h__
+
+#include "FloatArray.h"
+#include "ComplexFloatArray.h"
+#include "ShortArray.h"
+#include "IntArray.h"
+
+/**
+ * An array with its storage and size fixed at compile time.
+ * Unlike the array handles, which point to memory allocated with create(),
+ * a StaticArray holds its elements, so it can be a member of a patch or a
+ * global without any allocation in setup. A global can be placed in core
+ * coupled memory with
+ * @code
+ * StaticFloatArray<256> window __attribute__ ((section (".ccmdata")));
+ * @endcode
+ * but with the default Source/flash.ld that memory is the 16k CCMRAM region
+ * the patch also runs its stack in: the stack takes whatever .ccmdata leaves,
+ * and the link only fails once that is less than 2k (_Min_Stack_Size). So
+ * keep .ccmdata to a few k, and allocate larger buffers with MEMORY_FAST,
+ * from the 32k of CCM set aside for the heap.
+ * A StaticArray converts implicitly to its handle type, e.g. FloatArray,
+ * so it can be passed to anything that takes one. The handle points to
+ * the StaticArray's storage and must not be used after it goes out of scope,
+ * or be passed to destroy(). Loops up to getSize(), or the size constant,
+ * have a compile time bound and can be unrolled and vectorised.
+ * Unlike the handles, copying a StaticArray copies its contents.
+ */
+template<typename T, typename Array, int N>
+class StaticArray {
+private:
+  T data[N];
+public:
+  static const int size = N;
+
+  /**
+   * Constructor.
+   * Initialises all elements to zero, as create() does.
+   */
+  StaticArray() : data() {}
+
+  int getSize() const{
+    return N;
+  }
+
+  T* getData(){
+    return data;
+  }
+
+  /**
+   * Get a handle to the array, to use the methods of the handle type.
+   */
+  Array getArray(){
+    return Array(data, N);
+  }
+
+  operator Array(){
+    return Array(data, N);
+  }
+
+  operator T*(){
+    return data;
+  }
+
+  T& operator [](const int index){
+    return data[index];
+  }
+
+  const T& operator [](const int index) const{
+    return data[index];
+  }
+
+  /**
+   * Set all the elements in the array.
+   */
+  void setAll(T value){
+    for(int n=0; n<N; n++)
+      data[n] = value;
+  }
+
+  /**
+   * Copy N elements from source.
+   */
+  void copyFrom(const T* source){
+    for(int n=0; n<N; n++)
+      data[n] = source[n];
+  }
+
+  /**
+   * Copy all elements to destination, which must hold at least N elements.
+   */
+  void copyTo(T* destination) const{
+    for(int n=0; n<N; n++)
+      destination[n] = data[n];
+  }
+};
+
+template<typename T, typename Array, int N>
+const int StaticArray<T, Array, N>::size;
+
+template<int N> using StaticFloatArray = StaticArray<float, FloatArray, N>;
+template<int N> using StaticComplexFloatArray = StaticArray<ComplexFloat, ComplexFloatArray, N>;
+template<int N> using StaticShortArray = StaticArray<int16_t, ShortArray, N>;
+template<int N> using StaticIntArray = StaticArray<int32_t, IntArray, N>;
+
+#endif // __StaticArray_h__
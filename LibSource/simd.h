@@ -0,0 +1,196 @@
+#ifndef __simd_h__
+#define __simd_h__
+
+/*
+ * Vector primitives for the host builds of the array kernels, which use
+ * CMSIS on ARM. The backend is chosen at compile time from the target:
+ * AVX2 (8 lanes) if enabled with -mavx2, SSE2 (4 lanes) on x86, or
+ * WebAssembly SIMD128 (4 lanes) when emscripten is given -msimd128, which
+ * the web build adds with WEBSIMD=1.
+ * SIMD_FLOAT_LANES is left undefined when there is no vector unit, and
+ * callers then only run their scalar loops.
+ *
+ * Loads and stores are unaligned. Callers process SIMD_FLOAT_LANES
+ * elements at a time and finish the remainder with scalar code.
+ *
+ * The arithmetic functions are also defined for float, on all targets, so
+ * that a kernel written as a template, with constants from simd_splat<V>(),
+ * serves both the vector loop and the scalar remainder.
+ * simd_min(a, b) and simd_max(a, b) compare like a < b ? a : b and
+ * a > b ? a : b on all backends, so they return b when either is NaN.
+ * simd_round() rounds to the nearest integer, simd_pow2i() returns 2^n
+ * for an integer valued n in [-126, 127], and simd_exponent() and
+ * simd_mantissa() split a positive normal x into the exponent e and
+ * the mantissa m in [1, 2), so that x = m*2^e.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined ARM_CORTEX
+/* CMSIS */
+#elif defined __AVX2__
+
+#include <immintrin.h>
+#define SIMD_FLOAT_LANES 8
+typedef __m256 simd_float;
+
+static inline simd_float simd_load(const float* p){ return _mm256_loadu_ps(p); }
+static inline void simd_store(float* p, simd_float a){ _mm256_storeu_ps(p, a); }
+static inline simd_float simd_set(float x){ return _mm256_set1_ps(x); }
+static inline simd_float simd_add(simd_float a, simd_float b){ return _mm256_add_ps(a, b); }
+static inline simd_float simd_sub(simd_float a, simd_float b){ return _mm256_sub_ps(a, b); }
+static inline simd_float simd_mul(simd_float a, simd_float b){ return _mm256_mul_ps(a, b); }
+static inline simd_float simd_min(simd_float a, simd_float b){ return _mm256_min_ps(a, b); }
+static inline simd_float simd_max(simd_float a, simd_float b){ return _mm256_max_ps(a, b); }
+static inline simd_float simd_abs(simd_float a){ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+static inline simd_float simd_neg(simd_float a){ return _mm256_xor_ps(_mm256_set1_ps(-0.0f), a); }
+static inline float simd_sum(simd_float a){
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+static inline float simd_hmin(simd_float a){
+  __m128 s = _mm_min_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  s = _mm_min_ps(s, _mm_movehl_ps(s, s));
+  return _mm_cvtss_f32(_mm_min_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+static inline float simd_hmax(simd_float a){
+  __m128 s = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  s = _mm_max_ps(s, _mm_movehl_ps(s, s));
+  return _mm_cvtss_f32(_mm_max_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+static inline simd_float simd_div(simd_float a, simd_float b){ return _mm256_div_ps(a, b); }
+static inline simd_float simd_round(simd_float a){ return _mm256_cvtepi32_ps(_mm256_cvtps_epi32(a)); }
+static inline simd_float simd_pow2i(simd_float n){
+  return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23));
+}
+static inline simd_float simd_exponent(simd_float x){
+  return _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(x), 23), _mm256_set1_epi32(127)));
+}
+static inline simd_float simd_mantissa(simd_float x){
+  return _mm256_or_ps(_mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff))), _mm256_set1_ps(1.0f));
+}
+
+#elif defined __SSE2__
+
+#include <emmintrin.h>
+#define SIMD_FLOAT_LANES 4
+typedef __m128 simd_float;
+
+static inline simd_float simd_load(const float* p){ return _mm_loadu_ps(p); }
+static inline void simd_store(float* p, simd_float a){ _mm_storeu_ps(p, a); }
+static inline simd_float simd_set(float x){ return _mm_set1_ps(x); }
+static inline simd_float simd_add(simd_float a, simd_float b){ return _mm_add_ps(a, b); }
+static inline simd_float simd_sub(simd_float a, simd_float b){ return _mm_sub_ps(a, b); }
+static inline simd_float simd_mul(simd_float a, simd_float b){ return _mm_mul_ps(a, b); }
+static inline simd_float simd_min(simd_float a, simd_float b){ return _mm_min_ps(a, b); }
+static inline simd_float simd_max(simd_float a, simd_float b){ return _mm_max_ps(a, b); }
+static inline simd_float simd_abs(simd_float a){ return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline simd_float simd_neg(simd_float a){ return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+static inline float simd_sum(simd_float a){
+  simd_float s = _mm_add_ps(a, _mm_movehl_ps(a, a));
+  return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+static inline float simd_hmin(simd_float a){
+  simd_float s = _mm_min_ps(a, _mm_movehl_ps(a, a));
+  return _mm_cvtss_f32(_mm_min_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+static inline float simd_hmax(simd_float a){
+  simd_float s = _mm_max_ps(a, _mm_movehl_ps(a, a));
+  return _mm_cvtss_f32(_mm_max_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+static inline simd_float simd_div(simd_float a, simd_float b){ return _mm_div_ps(a, b); }
+static inline simd_float simd_round(simd_float a){ return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+static inline simd_float simd_pow2i(simd_float n){
+  return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23));
+}
+static inline simd_float simd_exponent(simd_float x){
+  return _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(127)));
+}
+static inline simd_float simd_mantissa(simd_float x){
+  return _mm_or_ps(_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x007fffff))), _mm_set1_ps(1.0f));
+}
+
+#elif defined __wasm_simd128__
+
+#include <wasm_simd128.h>
+#define SIMD_FLOAT_LANES 4
+typedef v128_t simd_float;
+
+static inline simd_float simd_load(const float* p){ return wasm_v128_load(p); }
+static inline void simd_store(float* p, simd_float a){ wasm_v128_store(p, a); }
+static inline simd_float simd_set(float x){ return wasm_f32x4_splat(x); }
+static inline simd_float simd_add(simd_float a, simd_float b){ return wasm_f32x4_add(a, b); }
+static inline simd_float simd_sub(simd_float a, simd_float b){ return wasm_f32x4_sub(a, b); }
+static inline simd_float simd_mul(simd_float a, simd_float b){ return wasm_f32x4_mul(a, b); }
+static inline simd_float simd_min(simd_float a, simd_float b){ return wasm_f32x4_pmin(b, a); }
+static inline simd_float simd_max(simd_float a, simd_float b){ return wasm_f32x4_pmax(b, a); }
+static inline simd_float simd_abs(simd_float a){ return wasm_f32x4_abs(a); }
+static inline simd_float simd_neg(simd_float a){ return wasm_f32x4_neg(a); }
+static inline float simd_sum(simd_float a){
+  return (wasm_f32x4_extract_lane(a, 0) + wasm_f32x4_extract_lane(a, 1)) +
+    (wasm_f32x4_extract_lane(a, 2) + wasm_f32x4_extract_lane(a, 3));
+}
+static inline float simd_hmin(simd_float a){
+  float x = wasm_f32x4_extract_lane(a, 0);
+  x = wasm_f32x4_extract_lane(a, 1) < x ? wasm_f32x4_extract_lane(a, 1) : x;
+  x = wasm_f32x4_extract_lane(a, 2) < x ? wasm_f32x4_extract_lane(a, 2) : x;
+  return wasm_f32x4_extract_lane(a, 3) < x ? wasm_f32x4_extract_lane(a, 3) : x;
+}
+static inline float simd_hmax(simd_float a){
+  float x = wasm_f32x4_extract_lane(a, 0);
+  x = wasm_f32x4_extract_lane(a, 1) > x ? wasm_f32x4_extract_lane(a, 1) : x;
+  x = wasm_f32x4_extract_lane(a, 2) > x ? wasm_f32x4_extract_lane(a, 2) : x;
+  return wasm_f32x4_extract_lane(a, 3) > x ? wasm_f32x4_extract_lane(a, 3) : x;
+}
+static inline simd_float simd_div(simd_float a, simd_float b){ return wasm_f32x4_div(a, b); }
+static inline simd_float simd_round(simd_float a){ return wasm_f32x4_nearest(a); }
+static inline simd_float simd_pow2i(simd_float n){
+  return wasm_i32x4_shl(wasm_i32x4_add(wasm_i32x4_trunc_sat_f32x4(n), wasm_i32x4_splat(127)), 23);
+}
+static inline simd_float simd_exponent(simd_float x){
+  return wasm_f32x4_convert_i32x4(wasm_i32x4_sub(wasm_u32x4_shr(x, 23), wasm_i32x4_splat(127)));
+}
+static inline simd_float simd_mantissa(simd_float x){
+  return wasm_v128_or(wasm_v128_and(x, wasm_i32x4_splat(0x007fffff)), wasm_f32x4_splat(1.0f));
+}
+
+#endif
+
+template<typename V> V simd_splat(float x);
+
+template<> inline float simd_splat<float>(float x){ return x; }
+static inline float simd_add(float a, float b){ return a+b; }
+static inline float simd_sub(float a, float b){ return a-b; }
+static inline float simd_mul(float a, float b){ return a*b; }
+static inline float simd_div(float a, float b){ return a/b; }
+static inline float simd_min(float a, float b){ return a < b ? a : b; }
+static inline float simd_max(float a, float b){ return a > b ? a : b; }
+static inline float simd_abs(float a){ return a < 0 ? -a : a; }
+static inline float simd_neg(float a){ return -a; }
+static inline float simd_round(float a){ return (float)(int32_t)(a < 0 ? a-0.5f : a+0.5f); }
+static inline float simd_pow2i(float n){
+  int32_t i = ((int32_t)n + 127) << 23;
+  float x;
+  memcpy(&x, &i, sizeof(x));
+  return x;
+}
+static inline float simd_exponent(float x){
+  int32_t i;
+  memcpy(&i, &x, sizeof(i));
+  return (float)((i >> 23) - 127);
+}
+static inline float simd_mantissa(float x){
+  int32_t i;
+  memcpy(&i, &x, sizeof(i));
+  i = (i & 0x007fffff) | 0x3f800000;
+  memcpy(&x, &i, sizeof(x));
+  return x;
+}
+
+#ifdef SIMD_FLOAT_LANES
+template<> inline simd_float simd_splat<simd_float>(float x){ return simd_set(x); }
+#endif
+
+#endif // __simd_h__
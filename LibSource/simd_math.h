@@ -0,0 +1,79 @@
+#ifndef __simd_math_h__
+#define __simd_math_h__
+
+#include "simd.h"
+
+/*
+ * Polynomial approximations of transcendental functions, written once for
+ * float and for simd_float, see simd.h. The FloatArray methods that use
+ * them document the error bounds. Coefficients are Chebyshev interpolants,
+ * which are close to minimax, and the bounds were measured against double
+ * precision over the ranges given.
+ */
+
+template<typename V>
+static inline V simd_polynomial(V x, const float* c, int order){
+  V y = simd_splat<V>(c[order]);
+  for(int i=order-1; i>=0; i--)
+    y = simd_add(simd_mul(y, x), simd_splat<V>(c[i]));
+  return y;
+}
+
+/* 2^x, for x in [-126, 127] */
+template<typename V>
+static inline V simd_pow2f(V x){
+  static const float c[] = { 1.0000000755e+00f, 6.9314718803e-01f, 2.4022107485e-01f,
+			     5.5503571142e-02f, 9.6760319183e-03f, 1.3390863365e-03f };
+  x = simd_min(simd_max(x, simd_splat<V>(-126.0f)), simd_splat<V>(127.0f));
+  V k = simd_round(x);
+  // 2^(x-k) for x-k in [-0.5, 0.5]
+  return simd_mul(simd_polynomial(simd_sub(x, k), c, 5), simd_pow2i(k));
+}
+
+/* log2(x), for positive normal x */
+template<typename V>
+static inline V simd_log2f(V x){
+  static const float c[] = { 1.4426947246e+00f, -7.2130675743e-01f, 4.8001246080e-01f,
+			     -3.5309635334e-01f, 2.5517634922e-01f, -1.5415200644e-01f,
+			     6.2748433576e-02f, -1.2077020270e-02f };
+  // log2(m) = t*p(t) for the mantissa m = 1+t
+  V t = simd_sub(simd_mantissa(x), simd_splat<V>(1.0f));
+  return simd_add(simd_exponent(x), simd_mul(t, simd_polynomial(t, c, 7)));
+}
+
+/* sin(x) */
+template<typename V>
+static inline V simd_sinf(V x){
+  static const float c[] = { 9.9999999570e-01f, -1.6666657948e-01f, 8.3330501707e-03f,
+			     -1.9809017409e-04f, 2.6051076353e-06f };
+  // reduce to r in [-pi/2, pi/2] with x = r + k*pi, with pi in two parts
+  // so that k*pi is exact for moderate k, then sin(x) = (-1)^k sin(r)
+  V k = simd_round(simd_mul(x, simd_splat<V>(0.318309886f)));
+  V r = simd_sub(x, simd_mul(k, simd_splat<V>(3.140625f)));
+  r = simd_sub(r, simd_mul(k, simd_splat<V>(9.67653589793e-4f)));
+  V odd = simd_abs(simd_sub(k, simd_mul(simd_splat<V>(2.0f), simd_round(simd_mul(k, simd_splat<V>(0.5f))))));
+  V sign = simd_sub(simd_splat<V>(1.0f), simd_mul(simd_splat<V>(2.0f), odd));
+  return simd_mul(simd_mul(sign, r), simd_polynomial(simd_mul(r, r), c, 4));
+}
+
+/* tanh(x), a rational approximation, saturating to +/-1 */
+template<typename V>
+static inline V simd_tanhf(V x){
+  static const float p[] = { 4.89352455891786e-03f, 6.37261928875436e-04f, 1.48572235717979e-05f,
+			     5.12229709037114e-08f, -8.60467152213735e-11f, 2.00018790482477e-13f,
+			     -2.76076847742355e-16f };
+  static const float q[] = { 4.89352518554385e-03f, 2.26843463243900e-03f, 1.18534705686654e-04f,
+			     1.19825839466702e-06f };
+  x = simd_min(simd_max(x, simd_splat<V>(-7.90531110763549805f)), simd_splat<V>(7.90531110763549805f));
+  V x2 = simd_mul(x, x);
+  return simd_div(simd_mul(x, simd_polynomial(x2, p, 6)), simd_polynomial(x2, q, 3));
+}
+
+/* cubic soft clipper: 1.5x - 0.5x^3, limited to +/-1 */
+template<typename V>
+static inline V simd_softclipf(V x){
+  x = simd_min(simd_max(x, simd_splat<V>(-1.0f)), simd_splat<V>(1.0f));
+  return simd_mul(x, simd_sub(simd_splat<V>(1.5f), simd_mul(simd_splat<V>(0.5f), simd_mul(x, x))));
+}
+
+#endif // __simd_math_h__
@@ -0,0 +1,120 @@
+#ifndef __EventQueue_h__
+#define __EventQueue_h__
+
+#include <stdint.h>
+#include "Patch.h"
+
+enum PatchEventType {
+  BUTTON_EVENT,
+  ENCODER_EVENT
+};
+
+struct PatchEvent {
+  uint8_t type;
+  uint8_t id;
+  union {
+    /** button value */
+    uint16_t value;
+    /** encoder delta */
+    int16_t delta;
+  };
+  /** sample offset into the block */
+  uint16_t samples;
+};
+
+#ifdef ARM_CORTEX
+#define EVENT_QUEUE_BARRIER() __asm__ volatile("dmb" ::: "memory")
+#else
+#define EVENT_QUEUE_BARRIER() __sync_synchronize()
+#endif
+
+/**
+ * Lock-free single producer, single consumer ring of patch events.
+ * The firmware callbacks push events, possibly from interrupt context,
+ * and processBlock() pops them, so events never reach the patch while
+ * it is processing audio. Only the producer writes head and only the
+ * consumer writes tail. When the queue is full new events are dropped.
+ * SIZE must be a power of two.
+ */
+template<int SIZE>
+class EventQueue {
+private:
+  PatchEvent events[SIZE];
+  volatile uint32_t head;
+  volatile uint32_t tail;
+  volatile uint32_t dropped;
+  /** @return the slot for the next event, or NULL if the queue is full */
+  PatchEvent* next(){
+    uint32_t h = head;
+    if(h - tail >= SIZE){
+      dropped = dropped + 1;
+      return NULL;
+    }
+    return &events[h & (SIZE-1)];
+  }
+  void publish(){
+    EVENT_QUEUE_BARRIER(); // publish the event before the index
+    head = head + 1;
+  }
+public:
+  EventQueue() : head(0), tail(0), dropped(0) {}
+  /** Called by the producer. @return false if the queue is full and the event was dropped */
+  bool pushButton(uint8_t id, uint16_t value, uint16_t samples){
+    PatchEvent* event = next();
+    if(event == NULL)
+      return false;
+    event->type = BUTTON_EVENT;
+    event->id = id;
+    event->value = value;
+    event->samples = samples;
+    publish();
+    return true;
+  }
+  /** Called by the producer. @return false if the queue is full and the event was dropped */
+  bool pushEncoder(uint8_t id, int16_t delta, uint16_t samples){
+    PatchEvent* event = next();
+    if(event == NULL)
+      return false;
+    event->type = ENCODER_EVENT;
+    event->id = id;
+    event->delta = delta;
+    event->samples = samples;
+    publish();
+    return true;
+  }
+  /** Called by the consumer. @return false if the queue is empty */
+  bool pop(PatchEvent& event){
+    uint32_t t = tail;
+    if(t == head)
+      return false;
+    EVENT_QUEUE_BARRIER(); // read the index before the event
+    event = events[t & (SIZE-1)];
+    EVENT_QUEUE_BARRIER(); // finish reading before releasing the slot
+    tail = t + 1;
+    return true;
+  }
+  /**
+   * Called by the consumer, before the patch processes a block. Delivers
+   * all queued events to the patch, with their sample offsets limited to
+   * the block.
+   */
+  void process(Patch* patch, int blocksize){
+    PatchEvent event;
+    while(pop(event)){
+      uint16_t samples = event.samples < blocksize ? event.samples : blocksize-1;
+      if(event.type == BUTTON_EVENT)
+        patch->buttonChanged((PatchButtonId)event.id, event.value, samples);
+      else
+        patch->encoderChanged((PatchParameterId)event.id, event.delta, samples);
+    }
+  }
+  int getSize(){
+    return head - tail;
+  }
+  /** number of events dropped because the queue was full */
+  uint32_t getDropped(){
+    return dropped;
+  }
+};
+
+#endif // __EventQueue_h__
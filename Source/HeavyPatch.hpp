@@ -20,7 +20,6 @@
 #define HEAVY_MESSAGE_OUT_QUEUE_SIZE 0 // in kB (default 0kB)
 
 extern "C" {
-  volatile bool _msgLock = false;
   static bool isButtonPressed(PatchButtonId bid){
     return getProgramVector()->buttons & (1<<bid);
   }
@@ -104,9 +103,8 @@ public:
     free(notein);
   }
   
+  // called from processBlock() before processAudio(), with samples as offset into the block
   void buttonChanged(PatchButtonId bid, uint16_t value, uint16_t samples){
-    if(_msgLock)
-      return;
     if(bid == PUSHBUTTON){
       context->sendFloatToReceiver(receiverHash[8], value ? 1.0 : 0.0);
     }else if(bid >= MIDI_NOTE_BUTTON){
@@ -115,12 +113,11 @@ public:
       float note = (float)(bid - MIDI_NOTE_BUTTON);
       float velocity = (float)(value>>5);
       // unsigned int hash = 0x41BE0F9C; // __hv_ctlin
-      float ms = 1000.0f*(samples+getBlockSize())/getSampleRate(); // delay in milliseconds
+      float ms = 1000.0f*samples/getSampleRate(); // delay in milliseconds
       // float cmd = value ? 0x90 : 0x80;
       hv_msg_setFloat(notein, 0, note);
       hv_msg_setFloat(notein, 1, velocity);
       // notein expects: note, velocity, channel, command, port
-      // not thread safe
       context->sendMessageToReceiver(hash, ms, notein);
     }
   }
@@ -134,7 +131,6 @@ public:
     float paramF = getParameterValue(PARAMETER_F);
     float paramG = getParameterValue(PARAMETER_G);
     float paramH = getParameterValue(PARAMETER_H);
-    _msgLock = true;
     context->sendFloatToReceiver(receiverHash[0], paramA);
     context->sendFloatToReceiver(receiverHash[1], paramB);
     context->sendFloatToReceiver(receiverHash[2], paramC);
@@ -143,7 +139,6 @@ public:
     context->sendFloatToReceiver(receiverHash[5], paramF);
     context->sendFloatToReceiver(receiverHash[6], paramG);
     context->sendFloatToReceiver(receiverHash[7], paramH);
-    _msgLock = false;
     float* outputs[] = {buffer.getSamples(LEFT_CHANNEL), buffer.getSamples(RIGHT_CHANNEL)};
     context->process(outputs, outputs, getBlockSize());
   }
@@ -0,0 +1,66 @@
+#ifndef __INTERLEAVEDBUFFER_H__
+#define __INTERLEAVEDBUFFER_H__
+
+#include <stdint.h>
+#include "IntArray.h"
+#include "device.h"
+#include "message.h"
+#include "SampleConversion.h"
+
+/**
+ * Exposes the codec frame buffers to an InterleavedPatch as interleaved
+ * Q31 samples, L R L R..., without de-interleaving to float.
+ * In 24-bit little-endian mode the codec buffers are used as they are. In
+ * big-endian mode the 16-bit halves of each word are swapped in place. In
+ * 16-bit mode the samples are widened to Q31 in scratch buffers.
+ */
+class InterleavedBuffer {
+protected:
+#if AUDIO_BITDEPTH == 16
+  int32_t input[AUDIO_MAX_BLOCK_SIZE*AUDIO_CHANNELS];
+  int32_t output[AUDIO_MAX_BLOCK_SIZE*AUDIO_CHANNELS];
+#else
+  int32_t* input;
+  int32_t* output;
+#endif
+  uint16_t size;
+public:
+  void split(int16_t* in, int16_t* out, uint16_t blocksize){
+    size = blocksize;
+#if AUDIO_BITDEPTH == 16
+    for(int i=0; i<size*AUDIO_CHANNELS; ++i)
+      input[i] = in[i]*65536; // left shifting a negative sample is undefined
+#else /* AUDIO_BITDEPTH != 16 */
+    ASSERT(((uintptr_t)in & 3) == 0 && ((uintptr_t)out & 3) == 0, "Unaligned audio buffer");
+    input = (int32_t*)in;
+    output = (int32_t*)out;
+#ifdef AUDIO_BIGEND
+    sample_rotate24be(in, size);
+#endif
+#endif /* AUDIO_BITDEPTH != 16 */
+  }
+  void comb(int16_t* out){
+#if AUDIO_BITDEPTH == 16
+    for(int i=0; i<size*AUDIO_CHANNELS; ++i)
+      out[i] = output[i] >> 16;
+#elif defined AUDIO_BIGEND
+    sample_rotate24be(out, size);
+#endif
+  }
+  /** Interleaved input frames, AUDIO_CHANNELS samples per frame */
+  IntArray getInput(){
+    return IntArray(input, size*AUDIO_CHANNELS);
+  }
+  /** Interleaved output frames, AUDIO_CHANNELS samples per frame */
+  IntArray getOutput(){
+    return IntArray(output, size*AUDIO_CHANNELS);
+  }
+  inline int getChannels(){
+    return AUDIO_CHANNELS;
+  }
+  inline int getSize(){
+    return size;
+  }
+};
+
+#endif // __INTERLEAVEDBUFFER_H__
@@ -33,6 +33,11 @@ public:
     if(buffer == NULL)
       error(OUT_OF_MEMORY_ERROR_STATUS, "Out of memory");
   }
+  ManagedMemoryBuffer(int ch, int sz, MemoryHint hint) :
+    MemoryBuffer(new(hint) float[ch*sz], ch, sz) {
+    if(buffer == NULL)
+      error(OUT_OF_MEMORY_ERROR_STATUS, "Out of memory");
+  }
   ~ManagedMemoryBuffer(){
     delete buffer;
   }
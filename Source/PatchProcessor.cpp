@@ -7,9 +7,9 @@
 #include "SmoothValue.h"
 
 PatchProcessor::PatchProcessor() 
-  : patch(NULL), bufferCount(0), parameterCount(0) {
+  : patch(NULL), interleaved(NULL), fixedpoint(NULL), bufferCount(0), parameterCount(0), blockCount(0), skewCount(0), settling(0) {
   for(int i=0; i<MAX_NUMBER_OF_PARAMETERS; ++i)
-    parameters[i] = NULL;
+    values[i] = -1;
 }
 
 PatchProcessor::~PatchProcessor(){
@@ -22,13 +22,22 @@ void PatchProcessor::clear(){
     buffers[i] = NULL;
   }
   bufferCount = 0;
-  for(int i=0; i<parameterCount; ++i){
-    delete parameters[i];
-    parameters[i] = NULL;
-  }
   parameterCount = 0;
+  for(int i=0; i<MAX_NUMBER_OF_PARAMETERS; ++i){
+    FloatArray::destroy(ramps[i].values);
+    ramps[i].values = FloatArray();
+    values[i] = -1;
+  }
+  settling = 0;
+  for(int i=0; i<skewCount; ++i){
+    FloatArray::destroy(skews[i].values);
+    skews[i].values = FloatArray();
+  }
+  skewCount = 0;
   delete patch;
   patch = NULL;
+  interleaved = NULL;
+  fixedpoint = NULL;
   index = -1;
   // memset(parameterNames, 0, sizeof(parameterNames));
 }
@@ -37,6 +46,14 @@ void PatchProcessor::setPatch(Patch* p){
   patch = p;
 }
 
+void PatchProcessor::setInterleavedPatch(InterleavedPatch* p){
+  interleaved = p;
+}
+
+void PatchProcessor::setShortPatch(ShortPatch* p){
+  fixedpoint = p;
+}
+
 AudioBuffer* PatchProcessor::createMemoryBuffer(int channels, int size){
   MemoryBuffer* buf = new ManagedMemoryBuffer(channels, size);
   if(buf == NULL)
@@ -46,68 +63,156 @@ AudioBuffer* PatchProcessor::createMemoryBuffer(int channels, int size){
   return buf;
 }
 
+/**
+ * Only parameters whose raw value has changed, or which are still
+ * settling, have their updaters called. Patch::parameterChanged() is
+ * called once for each changed parameter, after all updaters have run.
+ */
 void PatchProcessor::setParameterValues(int16_t *params){
-  if(getProgramVector()->hardware_version == OWL_MODULAR_HARDWARE){
-    for(int i=0; i<4 && i<parameterCount; ++i)
-      parameters[i]->update(4095 - params[i]);
-    for(int i=4; i<parameterCount; ++i)
-      parameters[i]->update(params[i]);
-  }else{
-    for(int i=0; i<parameterCount; ++i)
-      parameters[i]->update(params[i]);
+  blockCount++;
+  int size = min((int)getProgramVector()->parameters_size, MAX_NUMBER_OF_PARAMETERS);
+  bool modular = getProgramVector()->hardware_version == OWL_MODULAR_HARDWARE;
+  uint64_t changed = 0;
+  for(int i=0; i<size; ++i){
+    int16_t value = (modular && i < 4) ? 4095 - params[i] : params[i];
+    if(value != values[i]){
+      values[i] = value;
+      changed |= 1ULL<<i;
+    }
+  }
+  settling |= changed & ((1ULL<<parameterCount)-1);
+  uint64_t mask = settling;
+  for(int i=0; mask != 0; ++i, mask >>= 1){
+    if((mask & 1) && !parameters[i].update(values[i]))
+      settling &= ~(1ULL<<i);
+  }
+  if(patch != NULL){
+    mask = changed;
+    for(int i=0; mask != 0; ++i, mask >>= 1){
+      if(mask & 1)
+	patch->parameterChanged((PatchParameterId)i, values[i]/4096.0f);
+    }
+  }
+}
+
+/**
+ * Ramps are computed at most once per block, on first request, and shared
+ * by all callers in that block, so the interpolation mode is set by the
+ * first caller. Each ramp starts from the value at the end of the last ramp
+ * for the same parameter.
+ */
+FloatArray PatchProcessor::getParameterRamp(int pid, float value, bool exponential){
+  ASSERT(pid >= 0 && pid < MAX_NUMBER_OF_PARAMETERS, "Invalid parameter id");
+  ParameterRamp& ramp = ramps[pid];
+  if(ramp.values.getSize() == 0){
+    ramp.values = FloatArray::create(getBlockSize());
+    if((float*)ramp.values == NULL)
+      error(OUT_OF_MEMORY_ERROR_STATUS, "Out of memory");
+    ramp.last = value;
+    ramp.block = blockCount-1;
+  }
+  if(ramp.block != blockCount){
+    if(exponential)
+      ramp.values.expRamp(ramp.last, value);
+    else
+      ramp.values.ramp(ramp.last, value);
+    ramp.last = value;
+    ramp.block = blockCount;
   }
+  return ramp.values;
+}
+
+void ParameterUpdater::init(float min, float max, float defaultValue, uint8_t flt, float lambda, float delta, const float* tbl){
+  table = tbl;
+  filter = flt;
+  integer = false;
+  f.minimum = min;
+  f.maximum = max;
+  f.lambda = lambda;
+  f.delta = delta;
+  f.value = defaultValue;
+  f.parameter = NULL;
+}
+
+void ParameterUpdater::init(int min, int max, int defaultValue, uint8_t flt, int lambda, int delta, const float* tbl){
+  table = tbl;
+  filter = flt;
+  integer = true;
+  i.minimum = min;
+  i.maximum = max;
+  i.lambda = lambda;
+  i.delta = delta;
+  i.value = defaultValue;
+  i.parameter = NULL;
+}
+
+bool ParameterUpdater::update(int16_t value){
+  return integer ? update(i, value) : update(f, value);
 }
 
-template<typename T, typename V>
-class LinearParameterUpdater : public ParameterUpdater {
-private:
-  PatchParameter<T>* parameter;
-  T minimum;
-  T maximum;
-  V value;
-public:
-  LinearParameterUpdater(T min, T max, V initialValue)
-    : parameter(NULL), minimum(min), maximum(max), value(initialValue) {}
-  void update(int16_t newValue){
-    value = (newValue*(maximum-minimum))/4096+minimum;
-    if(parameter != NULL)
-      parameter->update((T)value);
+template<typename T>
+inline bool ParameterUpdater::update(ParameterState<T>& state, int16_t newValue){
+  T previous = state.value;
+  T target;
+  if(table == NULL){
+    target = (newValue*(state.maximum-state.minimum))/4096+state.minimum;
+  }else{
+    float v = table[newValue < 0 ? 0 : newValue > 4095 ? 4095 : newValue];
+    target = v*(state.maximum-state.minimum)+state.minimum;
   }
-  void setParameter(PatchParameter<T>* p){
-    parameter = p;
+  switch(filter){
+  case SMOOTH: {
+    SmoothValue<T> smooth(state.lambda, state.value);
+    smooth.update(target);
+    state.value = smooth.getValue();
+    break;
   }
-};
-
-// void setSkew(float mid){
-//   if (maximum > minimum)
-//     skew = log (0.5) / log ((mid - minimum) / (maximum - minimum));
-// }
-
-template<typename T, typename V>
-class ExponentialParameterUpdater : public ParameterUpdater {
-private:
-  PatchParameter<T>* parameter;
-  float skew;
-  T minimum;
-  T maximum;
-  V value;
-public:
-  ExponentialParameterUpdater(float skw, T min, T max, V initialValue)
-    : parameter(NULL), skew(skw), minimum(min), maximum(max), value(initialValue) {
-    //    ASSERT(skew > 0.0 && skew <= 2.0, "Invalid exponential skew value");
-    ASSERT(skew > 0.0, "Invalid exponential skew value");
+  case STIFF: {
+    StiffValue<T> stiff(state.delta, state.value);
+    stiff.update(target);
+    state.value = stiff.getValue();
+    break;
   }
-  void update(int16_t newValue){
-    float v = newValue/4096.0f;
-    v = expf(logf(v)/skew);
-    value = v*(maximum-minimum)+minimum;
-    if(parameter != NULL)
-      parameter->update((T)value);
+  case SMOOTH_STIFF: {
+    SmoothStiffValue<T> smoothstiff(state.lambda, state.delta, state.value);
+    smoothstiff.update(target);
+    state.value = smoothstiff.getValue();
+    break;
   }
-  void setParameter(PatchParameter<T>* p){
-    parameter = p;
+  default:
+    state.value = target;
+    break;
   }
-};
+  if(state.parameter != NULL)
+    state.parameter->update(state.value);
+  // a smoothed parameter has settled once another update leaves it unchanged,
+  // where updating it every block would also have left it
+  return (filter & SMOOTH) && state.value != previous;
+}
+
+/**
+ * Returns a table of the 4096 possible knob values raised to the power of
+ * 1/skew, so that skewed parameter updates don't call expf() and logf().
+ * Tables are shared by all parameters with the same skew. At 16k each they
+ * are read once per parameter change, so they go in bulk memory.
+ */
+const float* PatchProcessor::getSkewTable(float skew){
+  ASSERT(skew > 0.0, "Invalid exponential skew value");
+  for(int i=0; i<skewCount; ++i)
+    if(skews[i].skew == skew)
+      return skews[i].values;
+  ASSERT(skewCount < MAX_NUMBER_OF_PARAMETERS, "Too many skew tables");
+  FloatArray values = FloatArray::create(4096, MEMORY_BULK);
+  if((float*)values == NULL)
+    error(OUT_OF_MEMORY_ERROR_STATUS, "Out of memory");
+  values[0] = 0.0f;
+  for(int i=1; i<4096; ++i)
+    values[i] = expf(logf(i/4096.0f)/skew);
+  skews[skewCount].skew = skew;
+  skews[skewCount].values = values;
+  skewCount++;
+  return values;
+}
 
 double PatchProcessor::getSampleRate(){
   return getProgramVector()->audio_samplingrate;
@@ -135,33 +240,15 @@ PatchParameter<T> PatchProcessor::getParameter(const char* name, T min, T max, T
     if(getProgramVector()->registerPatchParameter != NULL)
       getProgramVector()->registerPatchParameter(pid, name);
     setDefaultValue(pid, defaultValue);
-    if(parameters[pid] != NULL)
-      delete parameters[pid];
-    ParameterUpdater* updater = NULL;
     T l = SmoothValue<T>::normal(lambda, blocksize);
     T d = StiffValue<T>::normal(delta)*abs(max-min);
-    if(skew == 1.0){
-      if(lambda == 0.0 && delta == 0.0){
-	updater = new LinearParameterUpdater<T, T>(min, max, defaultValue);
-      }else if(delta == 0.0){
-	updater = new LinearParameterUpdater<T, SmoothValue<T> >(min, max, SmoothValue<T>(l, defaultValue));
-      }else if(lambda == 0.0){      
-	updater = new LinearParameterUpdater<T, StiffValue<T> >(min, max, StiffValue<T>(d, defaultValue));
-      }else{
-	updater = new LinearParameterUpdater<T, SmoothStiffValue<T> >(min, max, SmoothStiffValue<T>(l, d, defaultValue));
-      }
-    }else{
-      if(lambda == 0.0 && delta == 0.0){
-	updater = new ExponentialParameterUpdater<T, T>(skew, min, max, defaultValue);
-      }else if(delta == 0.0){
-	updater = new ExponentialParameterUpdater<T, SmoothValue<T> >(skew, min, max, SmoothValue<T>(l, defaultValue));
-      }else if(lambda == 0.0){      
-	updater = new ExponentialParameterUpdater<T, StiffValue<T> >(skew, min, max, StiffValue<T>(d, defaultValue));
-      }else{
-	updater = new ExponentialParameterUpdater<T, SmoothStiffValue<T> >(skew, min, max, SmoothStiffValue<T>(l, d, defaultValue));
-      }
-    }
-    parameters[pid] = updater;
+    uint8_t filter = ParameterUpdater::NONE;
+    if(lambda != 0.0)
+      filter |= ParameterUpdater::SMOOTH;
+    if(delta != 0.0)
+      filter |= ParameterUpdater::STIFF;
+    const float* table = skew == 1.0 ? NULL : getSkewTable(skew);
+    parameters[pid].init(min, max, defaultValue, filter, l, d, table);
   }
   PatchParameter<T> pp(pid);
   return pp;
@@ -172,11 +259,11 @@ template PatchParameter<float> PatchProcessor::getParameter(const char* name, fl
 template PatchParameter<int> PatchProcessor::getParameter(const char* name, int min, int max, int defaultValue, float lambda, float delta, float skew);
 
 void PatchProcessor::setPatchParameter(int pid, FloatParameter* param){
-  if(pid < parameterCount && parameters[pid] != NULL)
-    parameters[pid]->setParameter(param);
+  if(pid < parameterCount)
+    parameters[pid].setParameter(param);
 }
 
 void PatchProcessor::setPatchParameter(int pid, IntParameter* param){
-  if(pid < parameterCount && parameters[pid] != NULL)
-    parameters[pid]->setParameter(param);
+  if(pid < parameterCount)
+    parameters[pid].setParameter(param);
 }
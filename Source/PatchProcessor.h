@@ -4,13 +4,61 @@
 #include <stdint.h>
 #include "Patch.h"
 #include "device.h"
+#include "EventQueue.h"
 
+class InterleavedPatch;
+class ShortPatch;
+
+#if MAX_NUMBER_OF_PARAMETERS > 64
+#error "Parameter bitmasks hold at most 64 parameters"
+#endif
+
+template<typename T>
+struct ParameterState {
+  T minimum;
+  T maximum;
+  T lambda;
+  T delta;
+  T value;
+  PatchParameter<T>* parameter;
+};
+
+/**
+ * Scaling, smoothing and hysteresis for one registered parameter.
+ * Updaters are stored by value in PatchProcessor and dispatch on their
+ * flags, rather than being heap allocated subclasses with virtual calls.
+ */
 class ParameterUpdater {
 public:
-  virtual ~ParameterUpdater(){}
-  virtual void update(int16_t value) = 0;
-  virtual void setParameter(IntParameter* p){}
-  virtual void setParameter(FloatParameter* p){}
+  enum Filter {
+    NONE = 0,
+    SMOOTH,
+    STIFF,
+    SMOOTH_STIFF
+  };
+  void init(float min, float max, float defaultValue, uint8_t filter, float lambda, float delta, const float* table);
+  void init(int min, int max, int defaultValue, uint8_t filter, int lambda, int delta, const float* table);
+  /** @return true while the parameter is still settling, e.g. smoothing towards a new value */
+  bool update(int16_t value);
+  void setParameter(FloatParameter* p){
+    if(!integer)
+      f.parameter = p;
+  }
+  void setParameter(IntParameter* p){
+    if(integer)
+      i.parameter = p;
+  }
+private:
+  template<typename T>
+  bool update(ParameterState<T>& state, int16_t value);
+  /** skew table for exponential scaling, or NULL for linear scaling */
+  const float* table;
+  uint8_t filter;
+  bool integer;
+  union {
+    ParameterState<float> f;
+    ParameterState<int> i;
+  };
 };
 
 class PatchProcessor {
@@ -19,12 +67,21 @@ public:
   ~PatchProcessor();
   void clear();
   void setPatch(Patch* patch);
+  void setInterleavedPatch(InterleavedPatch* patch);
+  void setShortPatch(ShortPatch* patch);
   int getBlockSize();
   double getSampleRate();
   AudioBuffer* createMemoryBuffer(int channels, int samples);
   void setParameterValues(int16_t* parameters);
+  FloatArray getParameterRamp(int pid, float value, bool exponential);
   Patch* patch;
+  /** set if the patch processes interleaved frames instead of AudioBuffer */
+  InterleavedPatch* interleaved;
+  /** set if the patch processes Q15 ShortAudioBuffers */
+  ShortPatch* fixedpoint;
   uint8_t index;
+  /** button and encoder events from the firmware, delivered to the patch before each block */
+  EventQueue<EVENT_QUEUE_SIZE> events;
   void setPatchParameter(int pid, FloatParameter* param);
   void setPatchParameter(int pid, IntParameter* param);
   template<typename T>
@@ -32,10 +89,28 @@ public:
 private:
   void setDefaultValue(int pid, float value);
   void setDefaultValue(int pid, int value);
+  const float* getSkewTable(float skew);
   uint8_t bufferCount;
-  ParameterUpdater* parameters[MAX_NUMBER_OF_PARAMETERS];
+  ParameterUpdater parameters[MAX_NUMBER_OF_PARAMETERS];
   uint8_t parameterCount;
   AudioBuffer* buffers[MAX_BUFFERS_PER_PATCH];
+  struct ParameterRamp {
+    FloatArray values;
+    float last;
+    uint32_t block;
+  };
+  ParameterRamp ramps[MAX_NUMBER_OF_PARAMETERS];
+  uint32_t blockCount;
+  struct SkewTable {
+    float skew;
+    FloatArray values;
+  };
+  SkewTable skews[MAX_NUMBER_OF_PARAMETERS];
+  uint8_t skewCount;
+  /** last raw value of each parameter, -1 before the first block */
+  int16_t values[MAX_NUMBER_OF_PARAMETERS];
+  /** bitmask of parameters whose updaters must be called */
+  uint64_t settling;
 };
 
 
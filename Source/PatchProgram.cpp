@@ -1,12 +1,17 @@
 #include "ProgramVector.h"
 #include "ServiceCall.h"
 #include "SampleBuffer.hpp"
+#include "InterleavedBuffer.hpp"
+#include "InterleavedPatch.h"
 #include "PatchProcessor.h"
 #include "message.h"
 #include "Patch.h"
 #include "registerpatch.h"
 #include "main.h"
 #include "heap.h"
+#ifdef HEAP_STATS
+#include "heap_stats.h"
+#endif
 
 PatchProcessor processor;
 
@@ -30,14 +35,13 @@ void doSetButton(uint8_t id, uint16_t value, uint16_t samples){
     vec->setButton((PatchButtonId)id, value, samples);
 }
 
+// event callbacks may run concurrently with processBlock(): queue the events for the next block
 void onButtonChanged(uint8_t id, uint16_t value, uint16_t samples){
-  if(processor.patch != NULL)
-    processor.patch->buttonChanged((PatchButtonId)id, value, samples);
+  processor.events.pushButton(id, value, samples);
 }
 
 void onEncoderChanged(uint8_t id, int16_t delta, uint16_t samples){
-  if(processor.patch != NULL)
-    processor.patch->encoderChanged((PatchParameterId)id, delta, samples);
+  processor.events.pushEncoder(id, delta, samples);
 }
 
 #define REGISTER_PATCH(T, STR, IN, OUT) registerPatch(STR, IN, OUT, new T)
@@ -51,6 +55,7 @@ void registerPatch(const char* name, uint8_t inputs, uint8_t outputs, Patch* pat
 }
 
 SampleBuffer* samples;
+InterleavedBuffer* frames;
 void setup(ProgramVector* pv){
 #ifdef DEBUG_MEM
 #ifdef ARM_CORTEX
@@ -65,14 +70,29 @@ void setup(ProgramVector* pv){
 #ifdef ARM_CORTEX
   getProgramVector()->heap_bytes_used = before - xPortGetFreeHeapSize();
 #endif
+#endif
+#ifdef HEAP_STATS
+  debugMessage(pcHeapStatsSummary());
 #endif
   // samples = new SampleBuffer(getBlockSize());
-  samples = new SampleBuffer();
+  if(processor.interleaved != NULL)
+    frames = new InterleavedBuffer();
+  else
+    samples = new SampleBuffer();
 }
 
 void processBlock(ProgramVector* pv){
-  samples->split(pv->audio_input, pv->audio_blocksize);
-  processor.setParameterValues(pv->parameters);
-  processor.patch->processAudio(*samples);
-  samples->comb(pv->audio_output);
+  if(processor.interleaved != NULL){
+    frames->split(pv->audio_input, pv->audio_output, pv->audio_blocksize);
+    processor.setParameterValues(pv->parameters);
+    processor.events.process(processor.patch, pv->audio_blocksize);
+    processor.interleaved->processInterleaved(frames->getInput(), frames->getOutput());
+    frames->comb(pv->audio_output);
+  }else{
+    samples->split(pv->audio_input, pv->audio_blocksize);
+    processor.setParameterValues(pv->parameters);
+    processor.events.process(processor.patch, pv->audio_blocksize);
+    processor.patch->processAudio(*samples);
+    samples->comb(pv->audio_output);
+  }
 }
@@ -5,6 +5,7 @@
 #include <string.h>
 #include "Patch.h"
 #include "device.h"
+#include "SampleConversion.h"
 #ifdef ARM_CORTEX
 #include "arm_math.h"
 #endif //ARM_CORTEX
@@ -32,34 +33,9 @@ public:
 #else /* AUDIO_BITDEPTH != 16 */
     size = blocksize;
 #ifdef AUDIO_BIGEND
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size;
-    int32_t qint;
-    while(blkCnt > 0u){
-      qint = (*input++)<<16;
-      qint |= *input++;
-      *l++ = qint / 2147483648.0f;
-      qint = (*input++)<<16;
-      qint |= *input++;
-      *r++ = qint / 2147483648.0f;
-      // *l++ = (int32_t)((*input++)<<16|*++input) / 2147483648.0f;
-      // *r++ = (int32_t)((*input++)<<16|*++input) / 2147483648.0f;
-      // *l++ = (int32_t)((*input++)<<16|*++input) / 2147483648.0f;
-      // *r++ = (int32_t)((*input++)<<16|*++input) / 2147483648.0f;
-      blkCnt--;
-    }
+    sample_split24be(input, left, right, size);
 #else /* AUDIO_BIGEND */
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size>>1;
-    while(blkCnt > 0u){
-      *l++ = (int32_t)((*input++)|(*++input)<<16) / 2147483648.0f;
-      *r++ = (int32_t)((*input++)|(*++input)<<16) / 2147483648.0f;
-      *l++ = (int32_t)((*input++)|(*++input)<<16) / 2147483648.0f;
-      *r++ = (int32_t)((*input++)|(*++input)<<16) / 2147483648.0f;
-      blkCnt--;
-    }
+    sample_split24le(input, left, right, size);
 #endif /* AUDIO_BIGEND */
 #endif /* AUDIO_BITDEPTH != 16 */
   }
@@ -84,42 +60,17 @@ public:
     }
 #else /* AUDIO_BITDEPTH != 16 */
 #ifdef AUDIO_BIGEND
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size;
-    int16_t* dst = output;
-    int32_t qint;
-    while(blkCnt > 0u){
 #ifdef AUDIO_SATURATE_SAMPLES
-      qint = clip_q63_to_q31((q63_t)(*l++ * 2147483648.0f));
-      *dst++ = qint >> 16;
-      *dst++ = qint & 0xffff;
-      qint = clip_q63_to_q31((q63_t)(*r++ * 2147483648.0f));
-      *dst++ = qint >> 16;
-      *dst++ = qint & 0xffff;
+    sample_comb24be_saturate(left, right, output, size);
 #else /* AUDIO_SATURATE_SAMPLES */
-      qint = *l++ * 2147483648.0f;
-      *dst++ = qint >> 16;
-      *dst++ = qint & 0xffff;
-      qint = *r++ * 2147483648.0f;
-      *dst++ = qint >> 16;
-      *dst++ = qint & 0xffff;
+    sample_comb24be(left, right, output, size);
 #endif /* AUDIO_SATURATE_SAMPLES */
-      blkCnt--;
-    }
 #else /* AUDIO_BIGEND */
-    // todo: test if this works in big-endian on ARM
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size>>1;
-    int32_t* dst = (int32_t*)output;
-    while(blkCnt > 0u){
-      *dst++ = *l++ * 2147483648.0f;
-      *dst++ = *r++ * 2147483648.0f;
-      *dst++ = *l++ * 2147483648.0f;
-      *dst++ = *r++ * 2147483648.0f;
-      blkCnt--;
-    }
+#ifdef AUDIO_SATURATE_SAMPLES
+    sample_comb24le_saturate(left, right, output, size);
+#else /* AUDIO_SATURATE_SAMPLES */
+    sample_comb24le(left, right, output, size);
+#endif /* AUDIO_SATURATE_SAMPLES */
 #endif /* AUDIO_BIGEND */
 #endif /* AUDIO_BITDEPTH == 16 */
   }
@@ -0,0 +1,337 @@
+#ifndef __SampleConversion_h__
+#define __SampleConversion_h__
+
+#include <stdint.h>
+#include <string.h>
+#ifdef ARM_CORTEX
+#include "arm_math.h"
+#elif defined __AVX2__
+#include <immintrin.h>
+#elif defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+ * Conversion between interleaved stereo 24-bit codec frames and separate
+ * left and right float channels.
+ *
+ * Each 24-bit sample is left justified in a 32-bit word made up of two
+ * 16-bit halves. In big-endian mode (AUDIO_BIGEND) the high half comes first,
+ * so reading the pair as a little-endian 32-bit word gives a value rotated
+ * by 16 bits. In little-endian mode the pair is a plain 32-bit word.
+ *
+ * On Cortex-M4 the rotation is a single ROR and the int to float conversion
+ * and scaling by 2^-31 is a single fixed-point VCVT. On the host the kernels
+ * use AVX2, SSE2 or NEON where available and fall back to scalar code.
+ */
+
+#define SAMPLE_CONVERSION_SCALE     2147483648.0f
+#define SAMPLE_CONVERSION_INV_SCALE (1.0f/2147483648.0f)
+/* largest float below 1.0, which scales to 0x7fffff80 and still fits in Q31 */
+#define SAMPLE_CONVERSION_MAX       0.99999994f
+#define SAMPLE_CONVERSION_MIN       -1.0f
+
+static inline uint32_t sample_rotate16(uint32_t x){
+#ifdef ARM_CORTEX
+  return __ROR(x, 16);
+#else
+  return (x << 16) | (x >> 16);
+#endif
+}
+
+static inline int32_t sample_load32(const int16_t* src){
+  int32_t x;
+  memcpy(&x, src, sizeof(x)); // unaligned safe, compiles to a single load
+  return x;
+}
+
+static inline void sample_store32(int16_t* dst, int32_t x){
+  memcpy(dst, &x, sizeof(x));
+}
+
+/** Convert a Q31 value to float in [-1, 1) */
+static inline float sample_q31_to_float(int32_t x){
+#ifdef ARM_CORTEX
+  float f;
+  __asm__ ("vmov %0, %1\n\tvcvt.f32.s32 %0, %0, #31" : "=t"(f) : "r"(x));
+  return f;
+#else
+  return x * SAMPLE_CONVERSION_INV_SCALE;
+#endif
+}
+
+/** Convert a float in [-1, 1) to Q31. Out of range values are undefined on the host; on Cortex-M VCVT saturates. */
+static inline int32_t sample_float_to_q31(float f){
+#ifdef ARM_CORTEX
+  int32_t x;
+  __asm__ ("vcvt.s32.f32 %1, %1, #31\n\tvmov %0, %1" : "=r"(x), "+t"(f));
+  return x;
+#else
+  return (int32_t)(f * SAMPLE_CONVERSION_SCALE);
+#endif
+}
+
+/** Convert a float to Q31, clipping to [-1, 1) */
+static inline int32_t sample_float_to_q31_saturate(float f){
+#ifdef ARM_CORTEX
+  return sample_float_to_q31(f); // VCVT saturates
+#else
+  f = f > SAMPLE_CONVERSION_MAX ? SAMPLE_CONVERSION_MAX : f;
+  f = f < SAMPLE_CONVERSION_MIN ? SAMPLE_CONVERSION_MIN : f;
+  return sample_float_to_q31(f);
+#endif
+}
+
+/* Scalar conversion of a single frame, also used for the tails of the vector loops */
+static inline void sample_split24be_frame(const int16_t* src, float* l, float* r){
+  *l = sample_q31_to_float(sample_rotate16(sample_load32(src)));
+  *r = sample_q31_to_float(sample_rotate16(sample_load32(src+2)));
+}
+
+static inline void sample_split24le_frame(const int16_t* src, float* l, float* r){
+  *l = sample_q31_to_float(sample_load32(src));
+  *r = sample_q31_to_float(sample_load32(src+2));
+}
+
+static inline void sample_comb24be_frame(float l, float r, int16_t* dst){
+  sample_store32(dst, sample_rotate16(sample_float_to_q31(l)));
+  sample_store32(dst+2, sample_rotate16(sample_float_to_q31(r)));
+}
+
+static inline void sample_comb24le_frame(float l, float r, int16_t* dst){
+  sample_store32(dst, sample_float_to_q31(l));
+  sample_store32(dst+2, sample_float_to_q31(r));
+}
+
+static inline void sample_comb24be_frame_saturate(float l, float r, int16_t* dst){
+  sample_store32(dst, sample_rotate16(sample_float_to_q31_saturate(l)));
+  sample_store32(dst+2, sample_rotate16(sample_float_to_q31_saturate(r)));
+}
+
+static inline void sample_comb24le_frame_saturate(float l, float r, int16_t* dst){
+  sample_store32(dst, sample_float_to_q31_saturate(l));
+  sample_store32(dst+2, sample_float_to_q31_saturate(r));
+}
+
+#if defined __AVX2__ && !defined ARM_CORTEX
+/* 8 frames per iteration: two 256-bit words of interleaved L/R samples */
+static inline __m256i sample_rotate16_avx2(__m256i x){
+  return _mm256_or_si256(_mm256_slli_epi32(x, 16), _mm256_srli_epi32(x, 16));
+}
+
+static inline void sample_split_avx2(const int16_t* src, float* l, float* r, bool rotate){
+  __m256i a = _mm256_loadu_si256((const __m256i*)src);
+  __m256i b = _mm256_loadu_si256((const __m256i*)(src+16));
+  if(rotate){
+    a = sample_rotate16_avx2(a);
+    b = sample_rotate16_avx2(b);
+  }
+  const __m256 scale = _mm256_set1_ps(SAMPLE_CONVERSION_INV_SCALE);
+  __m256 fa = _mm256_mul_ps(_mm256_cvtepi32_ps(a), scale); // L0 R0 L1 R1 | L2 R2 L3 R3
+  __m256 fb = _mm256_mul_ps(_mm256_cvtepi32_ps(b), scale); // L4 R4 L5 R5 | L6 R6 L7 R7
+  // deinterleave within lanes, then restore sample order across lanes
+  __m256 lo = _mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(2,0,2,0)); // L0 L1 L4 L5 | L2 L3 L6 L7
+  __m256 hi = _mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(3,1,3,1));
+  _mm256_storeu_ps(l, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(lo), _MM_SHUFFLE(3,1,2,0))));
+  _mm256_storeu_ps(r, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(hi), _MM_SHUFFLE(3,1,2,0))));
+}
+
+static inline void sample_comb_avx2(const float* l, const float* r, int16_t* dst, bool rotate, bool saturate){
+  const __m256 scale = _mm256_set1_ps(SAMPLE_CONVERSION_SCALE);
+  __m256 fl = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_loadu_ps(l)), _MM_SHUFFLE(3,1,2,0)));
+  __m256 fr = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_loadu_ps(r)), _MM_SHUFFLE(3,1,2,0)));
+  if(saturate){
+    const __m256 hi = _mm256_set1_ps(SAMPLE_CONVERSION_MAX);
+    const __m256 lo = _mm256_set1_ps(SAMPLE_CONVERSION_MIN);
+    fl = _mm256_min_ps(_mm256_max_ps(fl, lo), hi);
+    fr = _mm256_min_ps(_mm256_max_ps(fr, lo), hi);
+  }
+  __m256i a = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_unpacklo_ps(fl, fr), scale));
+  __m256i b = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_unpackhi_ps(fl, fr), scale));
+  if(rotate){
+    a = sample_rotate16_avx2(a);
+    b = sample_rotate16_avx2(b);
+  }
+  _mm256_storeu_si256((__m256i*)dst, a);
+  _mm256_storeu_si256((__m256i*)(dst+16), b);
+}
+static inline void sample_rotate_avx2(int16_t* frames){
+  _mm256_storeu_si256((__m256i*)frames, sample_rotate16_avx2(_mm256_loadu_si256((const __m256i*)frames)));
+  _mm256_storeu_si256((__m256i*)(frames+16), sample_rotate16_avx2(_mm256_loadu_si256((const __m256i*)(frames+16))));
+}
+#define SAMPLE_VECTOR_FRAMES 8
+#define sample_rotate_vector sample_rotate_avx2
+#define sample_split_vector sample_split_avx2
+#define sample_comb_vector  sample_comb_avx2
+
+#elif defined __SSE2__ && !defined ARM_CORTEX
+/* 4 frames per iteration: two 128-bit words of interleaved L/R samples */
+static inline __m128i sample_rotate16_sse2(__m128i x){
+  return _mm_or_si128(_mm_slli_epi32(x, 16), _mm_srli_epi32(x, 16));
+}
+
+static inline void sample_split_sse2(const int16_t* src, float* l, float* r, bool rotate){
+  __m128i a = _mm_loadu_si128((const __m128i*)src);
+  __m128i b = _mm_loadu_si128((const __m128i*)(src+8));
+  if(rotate){
+    a = sample_rotate16_sse2(a);
+    b = sample_rotate16_sse2(b);
+  }
+  const __m128 scale = _mm_set1_ps(SAMPLE_CONVERSION_INV_SCALE);
+  __m128 fa = _mm_mul_ps(_mm_cvtepi32_ps(a), scale); // L0 R0 L1 R1
+  __m128 fb = _mm_mul_ps(_mm_cvtepi32_ps(b), scale); // L2 R2 L3 R3
+  _mm_storeu_ps(l, _mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2,0,2,0)));
+  _mm_storeu_ps(r, _mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3,1,3,1)));
+}
+
+static inline void sample_comb_sse2(const float* l, const float* r, int16_t* dst, bool rotate, bool saturate){
+  const __m128 scale = _mm_set1_ps(SAMPLE_CONVERSION_SCALE);
+  __m128 fl = _mm_loadu_ps(l);
+  __m128 fr = _mm_loadu_ps(r);
+  if(saturate){
+    const __m128 hi = _mm_set1_ps(SAMPLE_CONVERSION_MAX);
+    const __m128 lo = _mm_set1_ps(SAMPLE_CONVERSION_MIN);
+    fl = _mm_min_ps(_mm_max_ps(fl, lo), hi);
+    fr = _mm_min_ps(_mm_max_ps(fr, lo), hi);
+  }
+  __m128i a = _mm_cvttps_epi32(_mm_mul_ps(_mm_unpacklo_ps(fl, fr), scale));
+  __m128i b = _mm_cvttps_epi32(_mm_mul_ps(_mm_unpackhi_ps(fl, fr), scale));
+  if(rotate){
+    a = sample_rotate16_sse2(a);
+    b = sample_rotate16_sse2(b);
+  }
+  _mm_storeu_si128((__m128i*)dst, a);
+  _mm_storeu_si128((__m128i*)(dst+8), b);
+}
+static inline void sample_rotate_sse2(int16_t* frames){
+  _mm_storeu_si128((__m128i*)frames, sample_rotate16_sse2(_mm_loadu_si128((const __m128i*)frames)));
+  _mm_storeu_si128((__m128i*)(frames+8), sample_rotate16_sse2(_mm_loadu_si128((const __m128i*)(frames+8))));
+}
+#define SAMPLE_VECTOR_FRAMES 4
+#define sample_rotate_vector sample_rotate_sse2
+#define sample_split_vector sample_split_sse2
+#define sample_comb_vector  sample_comb_sse2
+
+#elif defined __ARM_NEON && !defined ARM_CORTEX
+/* 4 frames per iteration: VLD2/VST2 deinterleave, VREV32 swaps the 16-bit halves.
+ * VCVT to fixed-point saturates, so saturation comes for free. */
+static inline void sample_split_neon(const int16_t* src, float* l, float* r, bool rotate){
+  int32x4x2_t x = vld2q_s32((const int32_t*)src);
+  if(rotate){
+    x.val[0] = vreinterpretq_s32_s16(vrev32q_s16(vreinterpretq_s16_s32(x.val[0])));
+    x.val[1] = vreinterpretq_s32_s16(vrev32q_s16(vreinterpretq_s16_s32(x.val[1])));
+  }
+  vst1q_f32(l, vcvtq_n_f32_s32(x.val[0], 31));
+  vst1q_f32(r, vcvtq_n_f32_s32(x.val[1], 31));
+}
+
+static inline void sample_comb_neon(const float* l, const float* r, int16_t* dst, bool rotate, bool saturate){
+  int32x4x2_t x;
+  x.val[0] = vcvtq_n_s32_f32(vld1q_f32(l), 31);
+  x.val[1] = vcvtq_n_s32_f32(vld1q_f32(r), 31);
+  if(rotate){
+    x.val[0] = vreinterpretq_s32_s16(vrev32q_s16(vreinterpretq_s16_s32(x.val[0])));
+    x.val[1] = vreinterpretq_s32_s16(vrev32q_s16(vreinterpretq_s16_s32(x.val[1])));
+  }
+  vst2q_s32((int32_t*)dst, x);
+}
+static inline void sample_rotate_neon(int16_t* frames){
+  vst1q_s16(frames, vrev32q_s16(vld1q_s16(frames)));
+  vst1q_s16(frames+8, vrev32q_s16(vld1q_s16(frames+8)));
+}
+#define SAMPLE_VECTOR_FRAMES 4
+#define sample_rotate_vector sample_rotate_neon
+#define sample_split_vector sample_split_neon
+#define sample_comb_vector  sample_comb_neon
+#endif
+
+/**
+ * Convert interleaved big-endian 24-bit frames in place to native Q31 words,
+ * or native Q31 words back to big-endian frames: the operation is its own inverse.
+ */
+static inline void sample_rotate24be(int16_t* frames, int blocksize){
+  int i = 0;
+#ifdef SAMPLE_VECTOR_FRAMES
+  for(; i+SAMPLE_VECTOR_FRAMES <= blocksize; i += SAMPLE_VECTOR_FRAMES)
+    sample_rotate_vector(frames+i*4);
+#endif
+  for(; i<blocksize; ++i){
+    sample_store32(frames+i*4, sample_rotate16(sample_load32(frames+i*4)));
+    sample_store32(frames+i*4+2, sample_rotate16(sample_load32(frames+i*4+2)));
+  }
+}
+
+/** Split interleaved big-endian 24-bit frames into left and right channels */
+static inline void sample_split24be(const int16_t* src, float* l, float* r, int blocksize){
+  int i = 0;
+#ifdef SAMPLE_VECTOR_FRAMES
+  for(; i+SAMPLE_VECTOR_FRAMES <= blocksize; i += SAMPLE_VECTOR_FRAMES)
+    sample_split_vector(src+i*4, l+i, r+i, true);
+#endif
+  for(; i<blocksize; ++i)
+    sample_split24be_frame(src+i*4, l+i, r+i);
+}
+
+/** Split interleaved little-endian 24-bit frames into left and right channels */
+static inline void sample_split24le(const int16_t* src, float* l, float* r, int blocksize){
+  int i = 0;
+#ifdef SAMPLE_VECTOR_FRAMES
+  for(; i+SAMPLE_VECTOR_FRAMES <= blocksize; i += SAMPLE_VECTOR_FRAMES)
+    sample_split_vector(src+i*4, l+i, r+i, false);
+#endif
+  for(; i<blocksize; ++i)
+    sample_split24le_frame(src+i*4, l+i, r+i);
+}
+
+/** Combine left and right channels into interleaved big-endian 24-bit frames */
+static inline void sample_comb24be(const float* l, const float* r, int16_t* dst, int blocksize){
+  int i = 0;
+#ifdef SAMPLE_VECTOR_FRAMES
+  for(; i+SAMPLE_VECTOR_FRAMES <= blocksize; i += SAMPLE_VECTOR_FRAMES)
+    sample_comb_vector(l+i, r+i, dst+i*4, true, false);
+#endif
+  for(; i<blocksize; ++i)
+    sample_comb24be_frame(l[i], r[i], dst+i*4);
+}
+
+/** Combine left and right channels into interleaved little-endian 24-bit frames */
+static inline void sample_comb24le(const float* l, const float* r, int16_t* dst, int blocksize){
+  int i = 0;
+#ifdef SAMPLE_VECTOR_FRAMES
+  for(; i+SAMPLE_VECTOR_FRAMES <= blocksize; i += SAMPLE_VECTOR_FRAMES)
+    sample_comb_vector(l+i, r+i, dst+i*4, false, false);
+#endif
+  for(; i<blocksize; ++i)
+    sample_comb24le_frame(l[i], r[i], dst+i*4);
+}
+
+/**
+ * Combine left and right channels into interleaved big-endian 24-bit frames,
+ * clipping samples to [-1, 1). The whole block is clamped in float before
+ * conversion, which costs two vector min/max per four samples on the host
+ * and nothing on Cortex-M, where VCVT saturates.
+ */
+static inline void sample_comb24be_saturate(const float* l, const float* r, int16_t* dst, int blocksize){
+  int i = 0;
+#ifdef SAMPLE_VECTOR_FRAMES
+  for(; i+SAMPLE_VECTOR_FRAMES <= blocksize; i += SAMPLE_VECTOR_FRAMES)
+    sample_comb_vector(l+i, r+i, dst+i*4, true, true);
+#endif
+  for(; i<blocksize; ++i)
+    sample_comb24be_frame_saturate(l[i], r[i], dst+i*4);
+}
+
+/** Combine left and right channels into interleaved little-endian 24-bit frames, clipping samples to [-1, 1) */
+static inline void sample_comb24le_saturate(const float* l, const float* r, int16_t* dst, int blocksize){
+  int i = 0;
+#ifdef SAMPLE_VECTOR_FRAMES
+  for(; i+SAMPLE_VECTOR_FRAMES <= blocksize; i += SAMPLE_VECTOR_FRAMES)
+    sample_comb_vector(l+i, r+i, dst+i*4, false, true);
+#endif
+  for(; i<blocksize; ++i)
+    sample_comb24le_frame_saturate(l[i], r[i], dst+i*4);
+}
+
+#endif // __SampleConversion_h__
@@ -4,114 +4,88 @@
 #include <stdint.h>
 #include <string.h>
 #include "device.h"
+#include "ShortPatch.h"
 
 #ifdef ARM_CORTEX
 #include "arm_math.h"
 #endif //ARM_CORTEX
-class ShortBuffer : public AudioBuffer {
+
+/**
+ * Q15 audio buffer for fixed-point patches.
+ * In 24-bit mode the samples are rounded to 16 bits, saturating the
+ * few values that would round up past the top of the Q15 range.
+ * On output the low bits of each 24-bit word are zero. Since Q15 values
+ * always fit in the codec range, AUDIO_SATURATE_SAMPLES needs no extra work.
+ */
+class ShortBuffer : public ShortAudioBuffer {
 protected:
   int16_t left[AUDIO_MAX_BLOCK_SIZE];
   int16_t right[AUDIO_MAX_BLOCK_SIZE];
   uint16_t size;
+  /** round a 24-bit sample, given as high and low 16-bit words, to Q15 */
+  static inline int16_t round24(int16_t hi, int16_t lo){
+    int32_t value = hi + ((uint16_t)lo >> 15);
+#ifdef ARM_CORTEX
+    return __SSAT(value, 16);
+#else
+    return value > 0x7fff ? 0x7fff : value;
+#endif
+  }
 public:
   void split(int16_t* input, uint16_t blocksize){
-#if AUDIO_BITDEPTH == 16
     size = blocksize;
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size >> 1u;
+    int16_t* l = left;
+    int16_t* r = right;
+    uint32_t blkCnt = size;
+#if AUDIO_BITDEPTH == 16
     while(blkCnt > 0u){
-      *l++ = (*input++);
-      *l++ = (*input++);
-      *r++ = (*input++);
-      *r++ = (*input++);
+      *l++ = *input++;
+      *r++ = *input++;
       blkCnt--;
     }
-#else /* AUDIO_BITDEPTH != 16 */
-    size = blocksize;
-#ifdef AUDIO_BIGEND
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size;
+#elif defined AUDIO_BIGEND
     while(blkCnt > 0u){
-      *l++ = *input;
-      input += 2;
-      *r++ = *input;
-      input += 2;
+      *l++ = round24(input[0], input[1]);
+      *r++ = round24(input[2], input[3]);
+      input += 4;
       blkCnt--;
     }
 #else /* AUDIO_BIGEND */
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size>>1;
-    input++;
-    while(blkCnt > 0u){      
-      *l++ = *input;
-      input += 2;
-      *r++ = *input;
-      input += 2;
+    while(blkCnt > 0u){
+      *l++ = round24(input[1], input[0]);
+      *r++ = round24(input[3], input[2]);
+      input += 4;
       blkCnt--;
-      // ++input;
-      // *l++ = *input++;
-      // ++input;
-      // *r++ = *input++;
-      // blkCnt--;
     }
 #endif /* AUDIO_BIGEND */
-#endif /* AUDIO_BITDEPTH != 16 */
   }
   void comb(int16_t* output){
+    int16_t* l = left;
+    int16_t* r = right;
+    uint32_t blkCnt = size;
 #if AUDIO_BITDEPTH == 16
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size >> 1u;
     while(blkCnt > 0u){
-#ifdef AUDIO_SATURATE_SAMPLES
-#error todo!
-#else
       *output++ = *l++;
       *output++ = *r++;
-      *output++ = *l++;
-      *output++ = *r++;
-#endif
       blkCnt--;
     }
-#else /* AUDIO_BITDEPTH != 16 */
-#ifdef AUDIO_BIGEND
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size;
-    int16_t* dst = output;
-    int32_t qint;
+#elif defined AUDIO_BIGEND
     while(blkCnt > 0u){
-#ifdef AUDIO_SATURATE_SAMPLES
-#error todo!
-#else /* AUDIO_SATURATE_SAMPLES */
-      *output++ = *l++;
-      *output++ = 0;
-      *output++ = *r++;
-      *output++ = 0;
       *output++ = *l++;
       *output++ = 0;
       *output++ = *r++;
       *output++ = 0;
-#endif /* AUDIO_SATURATE_SAMPLES */
       blkCnt--;
     }
 #else /* AUDIO_BIGEND */
-    float* l = left;
-    float* r = right;
-    uint32_t blkCnt = size>>1;
-    int32_t* dst = (int32_t*)output;
     while(blkCnt > 0u){
+      *output++ = 0;
       *output++ = *l++;
-      *output++ = *r++;
-      *output++ = *l++;
+      *output++ = 0;
       *output++ = *r++;
       blkCnt--;
     }
 #endif /* AUDIO_BIGEND */
-#endif /* AUDIO_BITDEPTH == 16 */
   }
   void clear(){
     memset(left, 0, getSize()*sizeof(int16_t));
@@ -128,4 +102,4 @@ public:
   }
 };
 
-#endif // __SAMPLEBUFFER_H__
+#endif // __SHORTBUFFER_H__
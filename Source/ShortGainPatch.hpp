@@ -0,0 +1,22 @@
+#ifndef __ShortGainPatch_hpp__
+#define __ShortGainPatch_hpp__
+
+#include "ShortPatch.h"
+
+/**
+ * Example fixed-point patch: a gain on all channels, in Q15.
+ * Build with make PATCHNAME=ShortGain FIXEDPOINT=1
+ */
+class ShortGainPatch : public ShortPatch {
+public:
+  ShortGainPatch(){
+    registerParameter(PARAMETER_A, "Gain");
+  }
+  void processAudio(ShortAudioBuffer &buffer){
+    int16_t gain = getParameterValue(PARAMETER_A)*32767;
+    for(int ch=0; ch<buffer.getChannels(); ++ch)
+      buffer.getSamples(ch).multiply(gain);
+  }
+};
+
+#endif // __ShortGainPatch_hpp__
@@ -1,12 +1,16 @@
 #include "ProgramVector.h"
 #include "ServiceCall.h"
 #include "ShortBuffer.hpp"
+#include "ShortPatch.h"
 #include "PatchProcessor.h"
 #include "message.h"
 #include "Patch.h"
 #include "registerpatch.h"
 #include "main.h"
 #include "heap.h"
+#ifdef HEAP_STATS
+#include "heap_stats.h"
+#endif
 
 PatchProcessor processor;
 
@@ -30,14 +34,13 @@ void doSetButton(uint8_t id, uint16_t value, uint16_t samples){
     vec->setButton((PatchButtonId)id, value, samples);
 }
 
+// event callbacks may run concurrently with processBlock(): queue the events for the next block
 void onButtonChanged(uint8_t id, uint16_t value, uint16_t samples){
-  if(processor.patch != NULL)
-    processor.patch->buttonChanged((PatchButtonId)id, value, samples);
+  processor.events.pushButton(id, value, samples);
 }
 
 void onEncoderChanged(uint8_t id, int16_t delta, uint16_t samples){
-  if(processor.patch != NULL)
-    processor.patch->encoderChanged((PatchParameterId)id, delta, samples);
+  processor.events.pushEncoder(id, delta, samples);
 }
 
 #define REGISTER_PATCH(T, STR, IN, OUT) registerPatch(STR, IN, OUT, new T)
@@ -66,13 +69,22 @@ void setup(ProgramVector* pv){
   getProgramVector()->heap_bytes_used = before - xPortGetFreeHeapSize();
 #endif
 #endif
-  // samples = new SampleBuffer(getBlockSize());
+#ifdef HEAP_STATS
+  debugMessage(pcHeapStatsSummary());
+#endif
+  if(processor.fixedpoint == NULL){
+    error(CONFIGURATION_ERROR_STATUS, "Not a fixed-point patch");
+    return;
+  }
   samples = new ShortBuffer();
 }
 
 void processBlock(ProgramVector* pv){
+  if(processor.fixedpoint == NULL)
+    return;
   samples->split(pv->audio_input, pv->audio_blocksize);
   processor.setParameterValues(pv->parameters);
-  processor.patch->processAudio(*samples);
+  processor.events.process(processor.patch, pv->audio_blocksize);
+  processor.fixedpoint->processAudio(*samples);
   samples->comb(pv->audio_output);
 }
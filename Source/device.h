@@ -4,14 +4,15 @@
 /* #define STARTUP_CODE */
 
 #define AUDIO_BIGEND
-/* #define AUDIO_SATURATE_SAMPLES // SATURATE adds almost 500 cycles to 24-bit mode */
+#define AUDIO_SATURATE_SAMPLES /* clips output to [-1, 1), free on Cortex-M4 where VCVT saturates */
 #define AUDIO_CHANNELS               2
 #define AUDIO_BITDEPTH               24    /* bits per sample */
 #define AUDIO_MAX_BLOCK_SIZE         1024
 
 #define MAX_BUFFERS_PER_PATCH        8
 #define MAX_NUMBER_OF_PATCHES        32
-#define MAX_NUMBER_OF_PARAMETERS     24
+#define MAX_NUMBER_OF_PARAMETERS     40
+#define EVENT_QUEUE_SIZE             64    /* button and encoder events per block, power of two */
 
 #define LED_PORT                     GPIOE
 #define LED_GREEN                    GPIO_Pin_5
@@ -2,6 +2,7 @@
 #define __heap_h
 
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
  extern "C" {
@@ -13,6 +14,34 @@
 #define portBYTE_ALIGNMENT_MASK ( 0x0007 )
 #endif
 #define configASSERT( x )
+#define portMAX_HEAP_REGIONS		4
+
+/* HEAP_STATS builds account for every allocation, see heap_stats.c */
+#if defined HEAP_STATS && !defined HEAP_TRACE
+#define HEAP_TRACE
+#endif
+
+/* Hosts can define HEAP_TRACE and implement the trace functions to record
+   every allocation and free, e.g. to replay them in a benchmark. xRegion is
+   -1 for allocations from any region. pvSite is the address the allocation
+   was made from: the caller of pvPortMalloc(), or of the outermost
+   allocation function that uses traceHEAP_SITE(), such as operator new or
+   FloatArray::create(). The site is kept when an allocation from one region
+   fails, since it is retried in the others. */
+#ifdef HEAP_TRACE
+#define traceHEAP_SITE() do { \
+    if( pvHeapTraceSite == NULL ) pvHeapTraceSite = __builtin_return_address( 0 ); \
+  } while( 0 )
+#define traceHEAP_MALLOC( pv, xWantedSize, xRegion ) do { \
+    vHeapTraceMalloc( pv, xWantedSize, xRegion, pvHeapTraceSite != NULL ? pvHeapTraceSite : __builtin_return_address( 0 ) ); \
+    if( ( pv ) != NULL || ( xRegion ) < 0 ) pvHeapTraceSite = NULL; \
+  } while( 0 )
+#define traceHEAP_FREE( pv ) vHeapTraceFree( pv )
+#else
+#define traceHEAP_SITE()
+#define traceHEAP_MALLOC( pv, xWantedSize, xRegion )
+#define traceHEAP_FREE( pv )
+#endif
 
    typedef struct HeapRegion
    {
@@ -27,6 +56,21 @@
    size_t xPortGetFreeHeapSize( void );
    size_t xPortGetMinimumEverFreeHeapSize( void );
    void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions );
+   /* allocate only from the given region, numbered in the order the regions
+      were defined; returns NULL without calling the malloc failed hook if
+      the region is full */
+   void *pvPortMallocFrom( size_t xWantedSize, BaseType_t xRegion );
+   /* region containing pv, or -1 */
+   BaseType_t xPortGetHeapRegion( void *pv );
+   size_t xPortGetFreeRegionSize( BaseType_t xRegion );
+   /* call pxCallback for every free block, for statistics */
+   void vPortForEachFreeBlock( void ( *pxCallback )( void *pvBlock, size_t xBlockSize, void *pvContext ), void *pvContext );
+#ifdef HEAP_TRACE
+   extern const void *pvHeapTraceSite;
+   extern const char *pcHeapTraceTag;
+   void vHeapTraceMalloc( void *pv, size_t xWantedSize, BaseType_t xRegion, const void *pvSite );
+   void vHeapTraceFree( void *pv );
+#endif
 
 #ifdef __cplusplus
 }
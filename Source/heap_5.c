@@ -174,9 +174,18 @@ application.  When the bit is free the block is still part of the free heap
 space. */
 static size_t xBlockAllocatedBit = 0;
 
+/* Start and end of each region, in the order they were defined. */
+static uint8_t *pucRegionStart[ portMAX_HEAP_REGIONS ];
+static uint8_t *pucRegionEnd[ portMAX_HEAP_REGIONS ];
+static BaseType_t xRegionCount = 0;
+
 /*-----------------------------------------------------------*/
 
-void *pvPortMalloc( size_t xWantedSize )
+/*
+ * Allocates the first free block of adequate size that starts between
+ * pucLow and pucHigh, without calling the malloc failed hook.
+ */
+static void *prvPortMallocRange( size_t xWantedSize, uint8_t *pucLow, uint8_t *pucHigh )
 {
 BlockLink_t *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
 void *pvReturn = NULL;
@@ -222,7 +231,9 @@ void *pvReturn = NULL;
 				one	of adequate size is found. */
 				pxPreviousBlock = &xStart;
 				pxBlock = xStart.pxNextFreeBlock;
-				while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != NULL ) )
+				while( ( ( pxBlock->xBlockSize < xWantedSize ) ||
+					 ( ( uint8_t * ) pxBlock < pucLow ) || ( ( uint8_t * ) pxBlock >= pucHigh ) ) &&
+				       ( pxBlock->pxNextFreeBlock != NULL ) )
 				{
 					pxPreviousBlock = pxBlock;
 					pxBlock = pxBlock->pxNextFreeBlock;
@@ -298,6 +309,16 @@ void *pvReturn = NULL;
 	}
 	( void ) xTaskResumeAll();
 
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+void *pvReturn = prvPortMallocRange( xWantedSize, NULL, ( uint8_t * ) UINTPTR_MAX );
+
+	traceHEAP_MALLOC( pvReturn, xWantedSize, -1 );
+
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
 	{
 		if( pvReturn == NULL )
@@ -323,6 +344,8 @@ BlockLink_t *pxLink;
 
 	if( pv != NULL )
 	{
+		traceHEAP_FREE( pv );
+
 		/* The memory being freed will have an BlockLink_t structure immediately
 		before it. */
 		puc -= uxHeapStructSize;
@@ -364,6 +387,69 @@ BlockLink_t *pxLink;
 }
 /*-----------------------------------------------------------*/
 
+void *pvPortMallocFrom( size_t xWantedSize, BaseType_t xRegion )
+{
+void *pvReturn;
+
+	if( ( xRegion < 0 ) || ( xRegion >= xRegionCount ) )
+	{
+		return NULL;
+	}
+	pvReturn = prvPortMallocRange( xWantedSize, pucRegionStart[ xRegion ], pucRegionEnd[ xRegion ] );
+	traceHEAP_MALLOC( pvReturn, xWantedSize, xRegion );
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortGetHeapRegion( void *pv )
+{
+BaseType_t xRegion;
+
+	for( xRegion = 0; xRegion < xRegionCount; xRegion++ )
+	{
+		if( ( ( uint8_t * ) pv >= pucRegionStart[ xRegion ] ) && ( ( uint8_t * ) pv < pucRegionEnd[ xRegion ] ) )
+		{
+			return xRegion;
+		}
+	}
+	return -1;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeRegionSize( BaseType_t xRegion )
+{
+BlockLink_t *pxBlock;
+size_t xFree = 0;
+
+	if( ( xRegion >= 0 ) && ( xRegion < xRegionCount ) )
+	{
+		for( pxBlock = xStart.pxNextFreeBlock; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+		{
+			if( ( ( uint8_t * ) pxBlock >= pucRegionStart[ xRegion ] ) && ( ( uint8_t * ) pxBlock < pucRegionEnd[ xRegion ] ) )
+			{
+				xFree += pxBlock->xBlockSize;
+			}
+		}
+	}
+	return xFree;
+}
+/*-----------------------------------------------------------*/
+
+void vPortForEachFreeBlock( void ( *pxCallback )( void *pvBlock, size_t xBlockSize, void *pvContext ), void *pvContext )
+{
+BlockLink_t *pxBlock;
+
+	for( pxBlock = xStart.pxNextFreeBlock; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+	{
+		/* Skip the zero size markers at the end of each region. */
+		if( pxBlock->xBlockSize > 0 )
+		{
+			pxCallback( pxBlock, pxBlock->xBlockSize, pvContext );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
 size_t xPortGetFreeHeapSize( void )
 {
 	return xFreeBytesRemaining;
@@ -443,7 +529,7 @@ BlockLink_t *pxFirstFreeBlockInRegion = NULL, *pxPreviousFreeBlock;
 uint8_t *pucAlignedHeap;
 size_t xTotalRegionSize, xTotalHeapSize = 0;
 BaseType_t xDefinedRegions = 0;
-uint32_t ulAddress;
+uintptr_t ulAddress;
 const HeapRegion_t *pxHeapRegion;
 
 	/* Can only call once! */
@@ -456,14 +542,14 @@ const HeapRegion_t *pxHeapRegion;
 		xTotalRegionSize = pxHeapRegion->xSizeInBytes;
 
 		/* Ensure the heap region starts on a correctly aligned boundary. */
-		ulAddress = ( uint32_t ) pxHeapRegion->pucStartAddress;
+		ulAddress = ( uintptr_t ) pxHeapRegion->pucStartAddress;
 		if( ( ulAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
 		{
 			ulAddress += ( portBYTE_ALIGNMENT - 1 );
 			ulAddress &= ~portBYTE_ALIGNMENT_MASK;
 
 			/* Adjust the size for the bytes lost to alignment. */
-			xTotalRegionSize -= ulAddress - ( uint32_t ) pxHeapRegion->pucStartAddress;
+			xTotalRegionSize -= ulAddress - ( uintptr_t ) pxHeapRegion->pucStartAddress;
 		}
 
 		pucAlignedHeap = ( uint8_t * ) ulAddress;
@@ -483,7 +569,7 @@ const HeapRegion_t *pxHeapRegion;
 			configASSERT( pxEnd != NULL );
 
 			/* Check blocks are passed in with increasing start addresses. */
-			configASSERT( ulAddress > ( uint32_t ) pxEnd );
+			configASSERT( ulAddress > ( uintptr_t ) pxEnd );
 		}
 
 		/* Remember the location of the end marker in the previous region, if
@@ -492,7 +578,7 @@ const HeapRegion_t *pxHeapRegion;
 
 		/* pxEnd is used to mark the end of the list of free blocks and is
 		inserted at the end of the region space. */
-		ulAddress = ( ( uint32_t ) pucAlignedHeap ) + xTotalRegionSize;
+		ulAddress = ( ( uintptr_t ) pucAlignedHeap ) + xTotalRegionSize;
 		ulAddress -= uxHeapStructSize;
 		ulAddress &= ~portBYTE_ALIGNMENT_MASK;
 		pxEnd = ( BlockLink_t * ) ulAddress;
@@ -503,7 +589,7 @@ const HeapRegion_t *pxHeapRegion;
 		sized to take up the entire heap region minus the space taken by the
 		free block structure. */
 		pxFirstFreeBlockInRegion = ( BlockLink_t * ) pucAlignedHeap;
-		pxFirstFreeBlockInRegion->xBlockSize = ulAddress - ( uint32_t ) pxFirstFreeBlockInRegion;
+		pxFirstFreeBlockInRegion->xBlockSize = ulAddress - ( uintptr_t ) pxFirstFreeBlockInRegion;
 		pxFirstFreeBlockInRegion->pxNextFreeBlock = pxEnd;
 
 		/* If this is not the first region that makes up the entire heap space
@@ -515,6 +601,14 @@ const HeapRegion_t *pxHeapRegion;
 
 		xTotalHeapSize += pxFirstFreeBlockInRegion->xBlockSize;
 
+		/* Remember the region bounds for pvPortMallocFrom(). */
+		if( xDefinedRegions < portMAX_HEAP_REGIONS )
+		{
+			pucRegionStart[ xDefinedRegions ] = pucAlignedHeap;
+			pucRegionEnd[ xDefinedRegions ] = ( uint8_t * ) pxEnd;
+			xRegionCount = xDefinedRegions + 1;
+		}
+
 		/* Move onto the next HeapRegion_t structure. */
 		xDefinedRegions++;
 		pxHeapRegion = &( pxHeapRegions[ xDefinedRegions ] );
@@ -0,0 +1,319 @@
+/*
+ * Heap accounting for HEAP_STATS builds.
+ *
+ * Every allocation is recorded against its call site, or against the
+ * current MemoryTag if one is set, with the bytes currently allocated, the
+ * peak and the number of allocations. Live blocks are kept in an open
+ * addressing table so that frees can be credited back to their site. The
+ * free blocks can be walked for fragmentation and a size histogram.
+ *
+ * The trace hooks in heap.h are implemented by the host, which forwards
+ * them to vHeapStatsMalloc() and vHeapStatsFree().
+ */
+
+#include <string.h>
+#include "heap_stats.h"
+
+#ifdef HEAP_TRACE
+const void *pvHeapTraceSite = NULL;
+const char *pcHeapTraceTag = NULL;
+#endif
+
+#ifdef HEAP_STATS
+
+#if ( HEAP_STATS_MAX_BLOCKS & ( HEAP_STATS_MAX_BLOCKS - 1 ) ) != 0
+#error "HEAP_STATS_MAX_BLOCKS must be a power of two"
+#endif
+#define heapstatsBLOCK_MASK		( HEAP_STATS_MAX_BLOCKS - 1 )
+#define heapstatsOTHER_SITE		( HEAP_STATS_MAX_SITES - 1 )
+
+typedef struct LIVE_BLOCK
+{
+	void *pv;				/*<< NULL if the slot is empty. */
+	uint32_t ulSize;
+	uint16_t usSite;
+} LiveBlock_t;
+
+static LiveBlock_t xBlocks[ HEAP_STATS_MAX_BLOCKS ];
+static uint32_t ulLiveBlocks = 0;
+static HeapSiteStats_t xSites[ HEAP_STATS_MAX_SITES ];
+static BaseType_t xSiteCount = 0;
+static HeapStats_t xStats;
+
+/*-----------------------------------------------------------*/
+
+static inline uint32_t prvHash( const void *pv )
+{
+	return ( uint32_t ) ( ( ( uintptr_t ) pv >> 3 ) * 2654435761u ) & heapstatsBLOCK_MASK;
+}
+
+static BaseType_t prvFindSite( const void *pvSite, const char *pcTag )
+{
+BaseType_t xSite;
+
+	for( xSite = 0; xSite < xSiteCount; xSite++ )
+	{
+		if( pcTag != NULL ? ( xSites[ xSite ].pcTag != NULL && strcmp( xSites[ xSite ].pcTag, pcTag ) == 0 ) :
+			( xSites[ xSite ].pcTag == NULL && xSites[ xSite ].pvSite == pvSite ) )
+		{
+			return xSite;
+		}
+	}
+	if( xSiteCount < heapstatsOTHER_SITE )
+	{
+		xSite = xSiteCount++;
+		xSites[ xSite ].pvSite = pvSite;
+		xSites[ xSite ].pcTag = pcTag;
+		return xSite;
+	}
+	/* The table is full: the last site collects the rest. */
+	xSiteCount = HEAP_STATS_MAX_SITES;
+	xSites[ heapstatsOTHER_SITE ].pvSite = NULL;
+	xSites[ heapstatsOTHER_SITE ].pcTag = "other";
+	return heapstatsOTHER_SITE;
+}
+
+void vHeapStatsMalloc( void *pv, size_t xWantedSize, BaseType_t xRegion, const void *pvSite )
+{
+HeapSiteStats_t *pxSite;
+BaseType_t xSite;
+uint32_t ulSlot;
+
+	if( pv == NULL )
+	{
+		/* Failed attempts to allocate from a particular region are retried
+		in the others, only pvPortMalloc() failures are out of memory. */
+		if( xRegion < 0 )
+		{
+			xStats.xFailedSize = xWantedSize;
+			xStats.pvFailedSite = pvSite;
+			xStats.pcFailedTag = pcHeapTraceTag;
+		}
+		return;
+	}
+
+	xSite = prvFindSite( pvSite, pcHeapTraceTag );
+	pxSite = &xSites[ xSite ];
+	pxSite->xBytes += xWantedSize;
+	pxSite->ulAllocations++;
+	if( pxSite->xBytes > pxSite->xPeakBytes )
+	{
+		pxSite->xPeakBytes = pxSite->xBytes;
+	}
+	xStats.xBytes += xWantedSize;
+	xStats.ulAllocations++;
+	if( xStats.xBytes > xStats.xPeakBytes )
+	{
+		xStats.xPeakBytes = xStats.xBytes;
+	}
+
+	if( ulLiveBlocks == HEAP_STATS_MAX_BLOCKS - 1 )
+	{
+		/* Keep one slot empty so that searches terminate. The bytes of
+		untracked blocks are never credited back. */
+		xStats.ulUntracked++;
+		return;
+	}
+	for( ulSlot = prvHash( pv ); xBlocks[ ulSlot ].pv != NULL; ulSlot = ( ulSlot + 1 ) & heapstatsBLOCK_MASK )
+	{
+	}
+	xBlocks[ ulSlot ].pv = pv;
+	xBlocks[ ulSlot ].ulSize = ( uint32_t ) xWantedSize;
+	xBlocks[ ulSlot ].usSite = ( uint16_t ) xSite;
+	ulLiveBlocks++;
+}
+/*-----------------------------------------------------------*/
+
+void vHeapStatsFree( void *pv )
+{
+uint32_t ulSlot, ulNext, ulHome;
+HeapSiteStats_t *pxSite;
+
+	for( ulSlot = prvHash( pv ); xBlocks[ ulSlot ].pv != pv; ulSlot = ( ulSlot + 1 ) & heapstatsBLOCK_MASK )
+	{
+		if( xBlocks[ ulSlot ].pv == NULL )
+		{
+			/* Untracked, or allocated before the statistics started. */
+			return;
+		}
+	}
+
+	pxSite = &xSites[ xBlocks[ ulSlot ].usSite ];
+	pxSite->xBytes -= xBlocks[ ulSlot ].ulSize;
+	xStats.xBytes -= xBlocks[ ulSlot ].ulSize;
+	xStats.ulFrees++;
+	ulLiveBlocks--;
+
+	/* Remove the block, moving back any later blocks in the same probe
+	sequence that would otherwise no longer be found. */
+	xBlocks[ ulSlot ].pv = NULL;
+	for( ulNext = ( ulSlot + 1 ) & heapstatsBLOCK_MASK; xBlocks[ ulNext ].pv != NULL; ulNext = ( ulNext + 1 ) & heapstatsBLOCK_MASK )
+	{
+		ulHome = prvHash( xBlocks[ ulNext ].pv );
+		if( ( ( ulNext - ulHome ) & heapstatsBLOCK_MASK ) >= ( ( ulNext - ulSlot ) & heapstatsBLOCK_MASK ) )
+		{
+			xBlocks[ ulSlot ] = xBlocks[ ulNext ];
+			xBlocks[ ulNext ].pv = NULL;
+			ulSlot = ulNext;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+const HeapStats_t *pxHeapStatsGet( void )
+{
+	return &xStats;
+}
+/*-----------------------------------------------------------*/
+
+const HeapSiteStats_t *pxHeapStatsGetSite( BaseType_t xIndex )
+{
+	if( ( xIndex < 0 ) || ( xIndex >= xSiteCount ) )
+	{
+		return NULL;
+	}
+	return &xSites[ xIndex ];
+}
+/*-----------------------------------------------------------*/
+
+typedef struct FREE_BLOCK_CONTEXT
+{
+	HeapRegionStats_t *pxRegions;
+	BaseType_t xRegions;
+	uint32_t *pulHistogram;
+} FreeBlockContext_t;
+
+static void prvCountFreeBlock( void *pvBlock, size_t xBlockSize, void *pvContext )
+{
+FreeBlockContext_t *pxContext = ( FreeBlockContext_t * ) pvContext;
+BaseType_t xRegion = xPortGetHeapRegion( pvBlock );
+int xBin;
+
+	if( ( xRegion >= 0 ) && ( xRegion < pxContext->xRegions ) )
+	{
+		HeapRegionStats_t *pxRegion = &pxContext->pxRegions[ xRegion ];
+		pxRegion->xFreeBytes += xBlockSize;
+		pxRegion->ulFreeBlocks++;
+		if( xBlockSize > pxRegion->xLargestFreeBlock )
+		{
+			pxRegion->xLargestFreeBlock = xBlockSize;
+		}
+	}
+	if( pxContext->pulHistogram != NULL )
+	{
+		for( xBin = 0; ( xBin < HEAP_STATS_HISTOGRAM_BINS - 1 ) && ( xBlockSize >= ( ( size_t ) 32 << xBin ) ); xBin++ )
+		{
+		}
+		pxContext->pulHistogram[ xBin ]++;
+	}
+}
+
+void vHeapStatsGetFreeBlocks( HeapRegionStats_t *pxRegions, BaseType_t xRegions, uint32_t *pulHistogram )
+{
+FreeBlockContext_t xContext = { pxRegions, xRegions, pulHistogram };
+
+	memset( pxRegions, 0, xRegions * sizeof( HeapRegionStats_t ) );
+	if( pulHistogram != NULL )
+	{
+		memset( pulHistogram, 0, HEAP_STATS_HISTOGRAM_BINS * sizeof( uint32_t ) );
+	}
+	vPortForEachFreeBlock( prvCountFreeBlock, &xContext );
+}
+/*-----------------------------------------------------------*/
+
+static char *prvAppend( char *pc, const char *pcEnd, const char *pcString )
+{
+	while( ( *pcString != '\0' ) && ( pc < pcEnd ) )
+	{
+		*pc++ = *pcString++;
+	}
+	*pc = '\0';
+	return pc;
+}
+
+static char *prvAppendNumber( char *pc, const char *pcEnd, uintptr_t ulValue, int xBase )
+{
+char cDigits[ 24 ];
+int i = sizeof( cDigits ) - 1;
+
+	cDigits[ i ] = '\0';
+	do
+	{
+		cDigits[ --i ] = "0123456789abcdef"[ ulValue % xBase ];
+		ulValue /= xBase;
+	} while( ( ulValue != 0 ) && ( i > 0 ) );
+	if( xBase == 16 )
+	{
+		pc = prvAppend( pc, pcEnd, "0x" );
+	}
+	return prvAppend( pc, pcEnd, &cDigits[ i ] );
+}
+
+static char *prvAppendSite( char *pc, const char *pcEnd, const void *pvSite, const char *pcTag )
+{
+	if( pcTag != NULL )
+	{
+		return prvAppend( pc, pcEnd, pcTag );
+	}
+	return prvAppendNumber( pc, pcEnd, ( uintptr_t ) pvSite, 16 );
+}
+
+const char *pcHeapStatsSummary( void )
+{
+static char cBuffer[ 64 ];
+const char *pcEnd = cBuffer + sizeof( cBuffer ) - 1;
+char *pc = cBuffer;
+const HeapSiteStats_t *pxTop = NULL;
+HeapRegionStats_t xRegions[ portMAX_HEAP_REGIONS ];
+size_t xFragmentation = 0, xRegionFragmentation;
+BaseType_t i;
+
+	for( i = 0; i < xSiteCount; i++ )
+	{
+		if( ( pxTop == NULL ) || ( xSites[ i ].xPeakBytes > pxTop->xPeakBytes ) )
+		{
+			pxTop = &xSites[ i ];
+		}
+	}
+
+	if( xStats.xFailedSize != 0 )
+	{
+		pc = prvAppend( pc, pcEnd, "Out of memory " );
+		pc = prvAppendNumber( pc, pcEnd, xStats.xFailedSize, 10 );
+		pc = prvAppend( pc, pcEnd, " at " );
+		pc = prvAppendSite( pc, pcEnd, xStats.pvFailedSite, xStats.pcFailedTag );
+	}
+	else
+	{
+		vHeapStatsGetFreeBlocks( xRegions, portMAX_HEAP_REGIONS, NULL );
+		/* Report the most fragmented region. */
+		for( i = 0; i < portMAX_HEAP_REGIONS; i++ )
+		{
+			if( xRegions[ i ].xFreeBytes != 0 )
+			{
+				xRegionFragmentation = 100 - ( 100 * xRegions[ i ].xLargestFreeBlock ) / xRegions[ i ].xFreeBytes;
+				if( xRegionFragmentation > xFragmentation )
+				{
+					xFragmentation = xRegionFragmentation;
+				}
+			}
+		}
+		pc = prvAppend( pc, pcEnd, "Heap " );
+		pc = prvAppendNumber( pc, pcEnd, xStats.xBytes, 10 );
+		pc = prvAppend( pc, pcEnd, " peak " );
+		pc = prvAppendNumber( pc, pcEnd, xStats.xPeakBytes, 10 );
+		pc = prvAppend( pc, pcEnd, " frag " );
+		pc = prvAppendNumber( pc, pcEnd, xFragmentation, 10 );
+		pc = prvAppend( pc, pcEnd, "%" );
+	}
+	if( pxTop != NULL )
+	{
+		pc = prvAppend( pc, pcEnd, " top " );
+		pc = prvAppendSite( pc, pcEnd, pxTop->pvSite, pxTop->pcTag );
+		pc = prvAppend( pc, pcEnd, " " );
+		pc = prvAppendNumber( pc, pcEnd, pxTop->xPeakBytes, 10 );
+	}
+	return cBuffer;
+}
+
+#endif /* HEAP_STATS */
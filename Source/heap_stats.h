@@ -0,0 +1,65 @@
+#ifndef __heap_stats_h
+#define __heap_stats_h
+
+#include "heap.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#ifndef HEAP_STATS_MAX_SITES
+#define HEAP_STATS_MAX_SITES		32
+#endif
+#ifndef HEAP_STATS_MAX_BLOCKS
+#define HEAP_STATS_MAX_BLOCKS		256
+#endif
+#define HEAP_STATS_HISTOGRAM_BINS	16
+
+   /* Bytes allocated from one call site, or under one MemoryTag. The last
+      site also collects everything once the table is full. */
+   typedef struct HeapSiteStats
+   {
+     const void *pvSite;
+     const char *pcTag;
+     size_t xBytes;
+     size_t xPeakBytes;
+     uint32_t ulAllocations;
+   } HeapSiteStats_t;
+
+   typedef struct HeapStats
+   {
+     size_t xBytes;					/* requested bytes currently allocated */
+     size_t xPeakBytes;
+     uint32_t ulAllocations;
+     uint32_t ulFrees;
+     uint32_t ulUntracked;			/* allocations that didn't fit in the block table */
+     size_t xFailedSize;			/* the last allocation that failed, or 0 */
+     const void *pvFailedSite;
+     const char *pcFailedTag;
+   } HeapStats_t;
+
+   typedef struct HeapRegionStats
+   {
+     size_t xFreeBytes;
+     size_t xLargestFreeBlock;
+     uint32_t ulFreeBlocks;
+   } HeapRegionStats_t;
+
+   void vHeapStatsMalloc( void *pv, size_t xWantedSize, BaseType_t xRegion, const void *pvSite );
+   void vHeapStatsFree( void *pv );
+   const HeapStats_t *pxHeapStatsGet( void );
+   /* sites in the order they first allocated, NULL past the last one */
+   const HeapSiteStats_t *pxHeapStatsGetSite( BaseType_t xIndex );
+   /* walks the free blocks: free space, largest block and count per region,
+      and a histogram of free block sizes where bin n counts blocks of
+      16 << n bytes or more, and less than 32 << n, except for the first
+      and last bins which are open ended */
+   void vHeapStatsGetFreeBlocks( HeapRegionStats_t *pxRegions, BaseType_t xRegions, uint32_t *pulHistogram );
+   /* one line summary for the ProgramVector message */
+   const char *pcHeapStatsSummary( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __heap_stats_h */
@@ -0,0 +1,511 @@
+/*
+ * Two-Level Segregated Fit (TLSF) memory allocator, a drop-in replacement
+ * for heap_5.c with the same interface, selected with HEAP=heap_tlsf.
+ *
+ * Free blocks are kept in segregated lists indexed by a first level of
+ * power of two size classes, each split linearly into heapSL_INDEX_COUNT
+ * second level classes. Two levels of bitmaps record which lists are
+ * non-empty, so that a list holding a large enough block is found with a
+ * couple of find-first-set instructions. Allocation and free are both
+ * O(1), independent of the number of blocks and of fragmentation, and
+ * freed blocks are merged with their physical neighbours immediately.
+ *
+ * See M. Masmano, I. Ripoll, A. Crespo and J. Real, "TLSF: a new dynamic
+ * memory allocator for real-time systems", ECRTS 2004.
+ *
+ * Each region defined with vPortDefineHeapRegions() is a separate pool,
+ * with its control structure at the start of the region, so that
+ * pvPortMallocFrom() can allocate from one region in constant time.
+ * pvPortMalloc() tries the regions in the order they were defined, like
+ * the first-fit search of heap_5.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "heap.h"
+
+/* Block sizes are multiples of 8, so the low bits of the size are free to
+use as flags. */
+#define heapBLOCK_FREE_BIT			( ( size_t ) 1 )
+#define heapBLOCK_PREV_FREE_BIT		( ( size_t ) 2 )
+#define heapBLOCK_FLAGS				( heapBLOCK_FREE_BIT | heapBLOCK_PREV_FREE_BIT )
+
+/* Number of second level lists per first level class, as a power of two.
+With 16 lists the worst case internal fragmentation is 1/16 of the
+requested size. */
+#define heapSL_INDEX_COUNT_LOG2		4
+#define heapSL_INDEX_COUNT			( 1 << heapSL_INDEX_COUNT_LOG2 )
+
+/* Blocks below heapSMALL_BLOCK_SIZE are all in the first level class 0,
+split linearly in steps of the alignment. */
+#define heapALIGNMENT_LOG2			3
+#define heapFL_INDEX_SHIFT			( heapSL_INDEX_COUNT_LOG2 + heapALIGNMENT_LOG2 )
+#define heapSMALL_BLOCK_SIZE		( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+
+/* The largest block is 1 << heapFL_INDEX_MAX bytes, larger than the 1M
+external memory. */
+#define heapFL_INDEX_MAX			21
+#define heapFL_INDEX_COUNT			( heapFL_INDEX_MAX - heapFL_INDEX_SHIFT + 1 )
+
+/* Every block starts with a header giving its size and the previous block
+in memory. Free blocks are also linked in to the list for their size. */
+typedef struct BLOCK_HEADER
+{
+	struct BLOCK_HEADER *pxPrevPhysBlock;	/*<< The block before this one in memory. */
+	size_t xBlockSize;						/*<< Size of the block including the header, and flags. */
+	struct BLOCK_HEADER *pxNextFreeBlock;	/*<< Only valid if the block is free. */
+	struct BLOCK_HEADER *pxPrevFreeBlock;	/*<< Only valid if the block is free. */
+} BlockHeader_t;
+
+/* The pool for one heap region. */
+typedef struct POOL_CONTROL
+{
+	uint8_t *pucStart;
+	uint8_t *pucEnd;
+	size_t xFreeBytes;
+	uint32_t ulFlBitmap;
+	uint32_t ulSlBitmap[ heapFL_INDEX_COUNT ];
+	BlockHeader_t *pxBlocks[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+} PoolControl_t;
+
+#define heapALIGN_UP( x ) ( ( ( x ) + ( portBYTE_ALIGNMENT - 1 ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Allocated blocks only use the first two fields of the header. */
+static const size_t xHeaderSize = heapALIGN_UP( 2 * sizeof( void * ) );
+static const size_t xMinimumBlockSize = heapALIGN_UP( sizeof( BlockHeader_t ) );
+
+static PoolControl_t *pxPools[ portMAX_HEAP_REGIONS ];
+static BaseType_t xPoolCount = 0;
+
+static size_t xFreeBytesRemaining = 0;
+static size_t xMinimumEverFreeBytesRemaining = 0;
+
+/*-----------------------------------------------------------*/
+
+/* Index of the most significant set bit. */
+static inline int prvFls( size_t x )
+{
+	return ( int ) ( sizeof( unsigned long ) * 8 ) - 1 - __builtin_clzl( ( unsigned long ) x );
+}
+
+/* Index of the least significant set bit. */
+static inline int prvFfs( uint32_t x )
+{
+	return __builtin_ctz( x );
+}
+
+static inline size_t prvBlockSize( const BlockHeader_t *pxBlock )
+{
+	return pxBlock->xBlockSize & ~heapBLOCK_FLAGS;
+}
+
+static inline BlockHeader_t *prvNextPhysBlock( const BlockHeader_t *pxBlock )
+{
+	return ( BlockHeader_t * ) ( ( uint8_t * ) pxBlock + prvBlockSize( pxBlock ) );
+}
+
+/* Find the first and second level list for a block of size xSize. */
+static inline void prvMappingInsert( size_t xSize, int *pxFl, int *pxSl )
+{
+int xFl, xSl;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		xFl = 0;
+		xSl = ( int ) ( xSize / ( heapSMALL_BLOCK_SIZE / heapSL_INDEX_COUNT ) );
+	}
+	else
+	{
+		xFl = prvFls( xSize );
+		xSl = ( int ) ( xSize >> ( xFl - heapSL_INDEX_COUNT_LOG2 ) ) ^ heapSL_INDEX_COUNT;
+		xFl -= heapFL_INDEX_SHIFT - 1;
+	}
+	*pxFl = xFl;
+	*pxSl = xSl;
+}
+
+/* Find the first list whose blocks are all at least xSize, by rounding
+xSize up to the next list boundary. */
+static inline void prvMappingSearch( size_t xSize, int *pxFl, int *pxSl )
+{
+	if( xSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( prvFls( xSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+	prvMappingInsert( xSize, pxFl, pxSl );
+}
+
+static void prvRemoveFreeBlock( PoolControl_t *pxPool, BlockHeader_t *pxBlock, int xFl, int xSl )
+{
+BlockHeader_t *pxPrev = pxBlock->pxPrevFreeBlock;
+BlockHeader_t *pxNext = pxBlock->pxNextFreeBlock;
+
+	if( pxNext != NULL )
+	{
+		pxNext->pxPrevFreeBlock = pxPrev;
+	}
+	if( pxPrev != NULL )
+	{
+		pxPrev->pxNextFreeBlock = pxNext;
+	}
+	else
+	{
+		/* The block is the head of its list. */
+		pxPool->pxBlocks[ xFl ][ xSl ] = pxNext;
+		if( pxNext == NULL )
+		{
+			pxPool->ulSlBitmap[ xFl ] &= ~( 1UL << xSl );
+			if( pxPool->ulSlBitmap[ xFl ] == 0 )
+			{
+				pxPool->ulFlBitmap &= ~( 1UL << xFl );
+			}
+		}
+	}
+}
+
+static void prvInsertFreeBlock( PoolControl_t *pxPool, BlockHeader_t *pxBlock )
+{
+int xFl, xSl;
+BlockHeader_t *pxHead;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &xFl, &xSl );
+	pxHead = pxPool->pxBlocks[ xFl ][ xSl ];
+	pxBlock->pxNextFreeBlock = pxHead;
+	pxBlock->pxPrevFreeBlock = NULL;
+	if( pxHead != NULL )
+	{
+		pxHead->pxPrevFreeBlock = pxBlock;
+	}
+	pxPool->pxBlocks[ xFl ][ xSl ] = pxBlock;
+	pxPool->ulFlBitmap |= 1UL << xFl;
+	pxPool->ulSlBitmap[ xFl ] |= 1UL << xSl;
+}
+
+static void prvUnlinkFreeBlock( PoolControl_t *pxPool, BlockHeader_t *pxBlock )
+{
+int xFl, xSl;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &xFl, &xSl );
+	prvRemoveFreeBlock( pxPool, pxBlock, xFl, xSl );
+}
+
+/* Find the head of a non-empty list at or above xFl, xSl. */
+static BlockHeader_t *prvSearchSuitableBlock( PoolControl_t *pxPool, int *pxFl, int *pxSl )
+{
+int xFl = *pxFl;
+uint32_t ulSlMap = pxPool->ulSlBitmap[ xFl ] & ( ~0UL << *pxSl );
+
+	if( ulSlMap == 0 )
+	{
+		/* No block in this first level class, try the next larger one. */
+		uint32_t ulFlMap = ( xFl + 1 < 32 ) ? ( pxPool->ulFlBitmap & ( ~0UL << ( xFl + 1 ) ) ) : 0;
+		if( ulFlMap == 0 )
+		{
+			return NULL;
+		}
+		xFl = prvFfs( ulFlMap );
+		*pxFl = xFl;
+		ulSlMap = pxPool->ulSlBitmap[ xFl ];
+	}
+	*pxSl = prvFfs( ulSlMap );
+	return pxPool->pxBlocks[ xFl ][ *pxSl ];
+}
+
+static void *prvPoolMalloc( PoolControl_t *pxPool, size_t xWantedSize )
+{
+BlockHeader_t *pxBlock, *pxRemainder;
+size_t xSize, xBlockSize;
+int xFl, xSl;
+
+	/* Also quickly skip a full region, as pvPortMalloc() tries each in turn. */
+	if( ( xWantedSize >= ( ( size_t ) 1 << heapFL_INDEX_MAX ) ) || ( xWantedSize >= pxPool->xFreeBytes ) )
+	{
+		return NULL;
+	}
+
+	/* The requested size plus the header, aligned. */
+	xSize = heapALIGN_UP( xWantedSize + xHeaderSize );
+	if( xSize < xMinimumBlockSize )
+	{
+		xSize = xMinimumBlockSize;
+	}
+	prvMappingSearch( xSize, &xFl, &xSl );
+	pxBlock = ( xFl < heapFL_INDEX_COUNT ) ? prvSearchSuitableBlock( pxPool, &xFl, &xSl ) : NULL;
+	if( pxBlock == NULL )
+	{
+		/* Rounding up to the next list boundary fails for requests close to
+		the size of the largest free block, which may still fit. Search the
+		list that the size itself maps to. This is the only search that is
+		not constant time, and only happens when the region is nearly full. */
+		prvMappingInsert( xSize, &xFl, &xSl );
+		if( xFl >= heapFL_INDEX_COUNT )
+		{
+			return NULL;
+		}
+		for( pxBlock = pxPool->pxBlocks[ xFl ][ xSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+		{
+			if( prvBlockSize( pxBlock ) >= xSize )
+			{
+				break;
+			}
+		}
+		if( pxBlock == NULL )
+		{
+			return NULL;
+		}
+	}
+	prvRemoveFreeBlock( pxPool, pxBlock, xFl, xSl );
+
+	/* Split off the remainder as a new free block if it is large enough. */
+	xBlockSize = prvBlockSize( pxBlock );
+	if( xBlockSize - xSize >= xMinimumBlockSize )
+	{
+		pxRemainder = ( BlockHeader_t * ) ( ( uint8_t * ) pxBlock + xSize );
+		pxRemainder->xBlockSize = ( xBlockSize - xSize ) | heapBLOCK_FREE_BIT;
+		pxRemainder->pxPrevPhysBlock = pxBlock;
+		prvNextPhysBlock( pxRemainder )->pxPrevPhysBlock = pxRemainder;
+		prvInsertFreeBlock( pxPool, pxRemainder );
+		pxBlock->xBlockSize = xSize | ( pxBlock->xBlockSize & heapBLOCK_PREV_FREE_BIT );
+	}
+	else
+	{
+		prvNextPhysBlock( pxBlock )->xBlockSize &= ~heapBLOCK_PREV_FREE_BIT;
+	}
+	pxBlock->xBlockSize &= ~heapBLOCK_FREE_BIT;
+
+	xSize = prvBlockSize( pxBlock );
+	pxPool->xFreeBytes -= xSize;
+	xFreeBytesRemaining -= xSize;
+	if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+	{
+		xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+	}
+	return ( uint8_t * ) pxBlock + xHeaderSize;
+}
+
+static BaseType_t prvFindPool( void *pv )
+{
+BaseType_t xPool;
+
+	for( xPool = 0; xPool < xPoolCount; xPool++ )
+	{
+		if( ( ( uint8_t * ) pv >= pxPools[ xPool ]->pucStart ) && ( ( uint8_t * ) pv < pxPools[ xPool ]->pucEnd ) )
+		{
+			return xPool;
+		}
+	}
+	return -1;
+}
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+void *pvReturn = NULL;
+BaseType_t xPool;
+
+	if( xWantedSize > 0 )
+	{
+		for( xPool = 0; ( xPool < xPoolCount ) && ( pvReturn == NULL ); xPool++ )
+		{
+			pvReturn = prvPoolMalloc( pxPools[ xPool ], xWantedSize );
+		}
+	}
+
+	traceHEAP_MALLOC( pvReturn, xWantedSize, -1 );
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocFrom( size_t xWantedSize, BaseType_t xRegion )
+{
+void *pvReturn;
+
+	if( ( xRegion < 0 ) || ( xRegion >= xPoolCount ) || ( xWantedSize == 0 ) )
+	{
+		return NULL;
+	}
+	pvReturn = prvPoolMalloc( pxPools[ xRegion ], xWantedSize );
+	traceHEAP_MALLOC( pvReturn, xWantedSize, xRegion );
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+BlockHeader_t *pxBlock, *pxNext;
+PoolControl_t *pxPool;
+BaseType_t xPool;
+size_t xSize;
+
+	if( pv == NULL )
+	{
+		return;
+	}
+	traceHEAP_FREE( pv );
+
+	xPool = prvFindPool( pv );
+	pxBlock = ( BlockHeader_t * ) ( ( uint8_t * ) pv - xHeaderSize );
+	configASSERT( xPool >= 0 );
+	configASSERT( ( pxBlock->xBlockSize & heapBLOCK_FREE_BIT ) == 0 );
+	if( ( xPool < 0 ) || ( ( pxBlock->xBlockSize & heapBLOCK_FREE_BIT ) != 0 ) )
+	{
+		return;
+	}
+	pxPool = pxPools[ xPool ];
+
+	xSize = prvBlockSize( pxBlock );
+	pxPool->xFreeBytes += xSize;
+	xFreeBytesRemaining += xSize;
+
+	/* Merge with the previous block in memory if it is free. */
+	if( ( pxBlock->xBlockSize & heapBLOCK_PREV_FREE_BIT ) != 0 )
+	{
+		BlockHeader_t *pxPrev = pxBlock->pxPrevPhysBlock;
+		prvUnlinkFreeBlock( pxPool, pxPrev );
+		pxPrev->xBlockSize += xSize;
+		pxBlock = pxPrev;
+	}
+
+	/* Merge with the next block in memory if it is free. The end of each
+	pool is marked by a zero size block which is never free. */
+	pxNext = prvNextPhysBlock( pxBlock );
+	if( ( pxNext->xBlockSize & heapBLOCK_FREE_BIT ) != 0 )
+	{
+		prvUnlinkFreeBlock( pxPool, pxNext );
+		pxBlock->xBlockSize += prvBlockSize( pxNext );
+		pxNext = prvNextPhysBlock( pxBlock );
+	}
+
+	pxBlock->xBlockSize |= heapBLOCK_FREE_BIT;
+	pxNext->pxPrevPhysBlock = pxBlock;
+	pxNext->xBlockSize |= heapBLOCK_PREV_FREE_BIT;
+	prvInsertFreeBlock( pxPool, pxBlock );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortGetHeapRegion( void *pv )
+{
+	return prvFindPool( pv );
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeRegionSize( BaseType_t xRegion )
+{
+	if( ( xRegion < 0 ) || ( xRegion >= xPoolCount ) )
+	{
+		return 0;
+	}
+	return pxPools[ xRegion ]->xFreeBytes;
+}
+/*-----------------------------------------------------------*/
+
+void vPortForEachFreeBlock( void ( *pxCallback )( void *pvBlock, size_t xBlockSize, void *pvContext ), void *pvContext )
+{
+BaseType_t xPool;
+BlockHeader_t *pxBlock;
+int xFl, xSl;
+
+	for( xPool = 0; xPool < xPoolCount; xPool++ )
+	{
+		for( xFl = 0; xFl < heapFL_INDEX_COUNT; xFl++ )
+		{
+			for( xSl = 0; xSl < heapSL_INDEX_COUNT; xSl++ )
+			{
+				for( pxBlock = pxPools[ xPool ]->pxBlocks[ xFl ][ xSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+				{
+					pxCallback( pxBlock, prvBlockSize( pxBlock ), pvContext );
+				}
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions )
+{
+const HeapRegion_t *pxHeapRegion;
+PoolControl_t *pxPool;
+BlockHeader_t *pxBlock, *pxEnd;
+uintptr_t ulAddress, ulEnd;
+size_t xSize;
+int xFl, xSl;
+
+	/* Can only call once! */
+	configASSERT( xPoolCount == 0 );
+
+	for( pxHeapRegion = pxHeapRegions; pxHeapRegion->xSizeInBytes > 0; pxHeapRegion++ )
+	{
+		if( xPoolCount == portMAX_HEAP_REGIONS )
+		{
+			break;
+		}
+
+		/* The pool control structure goes at the aligned start of the region. */
+		ulAddress = heapALIGN_UP( ( uintptr_t ) pxHeapRegion->pucStartAddress );
+		ulEnd = ( ( uintptr_t ) pxHeapRegion->pucStartAddress + pxHeapRegion->xSizeInBytes ) & ~( ( uintptr_t ) portBYTE_ALIGNMENT_MASK );
+		if( ulEnd < ulAddress + heapALIGN_UP( sizeof( PoolControl_t ) ) + xMinimumBlockSize + xHeaderSize )
+		{
+			continue;
+		}
+		pxPool = ( PoolControl_t * ) ulAddress;
+		ulAddress += heapALIGN_UP( sizeof( PoolControl_t ) );
+
+		for( xFl = 0; xFl < heapFL_INDEX_COUNT; xFl++ )
+		{
+			pxPool->ulSlBitmap[ xFl ] = 0;
+			for( xSl = 0; xSl < heapSL_INDEX_COUNT; xSl++ )
+			{
+				pxPool->pxBlocks[ xFl ][ xSl ] = NULL;
+			}
+		}
+		pxPool->ulFlBitmap = 0;
+
+		/* One free block covering the region, followed by a zero size end
+		marker that is never free, so that merging stops there. */
+		xSize = ulEnd - xHeaderSize - ulAddress;
+		if( xSize >= ( ( size_t ) 1 << heapFL_INDEX_MAX ) )
+		{
+			xSize = ( ( size_t ) 1 << heapFL_INDEX_MAX ) - portBYTE_ALIGNMENT;
+		}
+		pxBlock = ( BlockHeader_t * ) ulAddress;
+		pxBlock->pxPrevPhysBlock = NULL;
+		pxBlock->xBlockSize = xSize | heapBLOCK_FREE_BIT;
+		pxEnd = prvNextPhysBlock( pxBlock );
+		pxEnd->pxPrevPhysBlock = pxBlock;
+		pxEnd->xBlockSize = heapBLOCK_PREV_FREE_BIT;
+
+		pxPool->pucStart = ( uint8_t * ) pxBlock;
+		pxPool->pucEnd = ( uint8_t * ) pxEnd;
+		pxPool->xFreeBytes = xSize;
+		prvInsertFreeBlock( pxPool, pxBlock );
+
+		pxPools[ xPoolCount++ ] = pxPool;
+		xFreeBytesRemaining += xSize;
+	}
+
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+}
@@ -6,6 +6,9 @@
 #include "main.h"
 #include "heap.h"
 #include "message.h"
+#ifdef HEAP_STATS
+#include "heap_stats.h"
+#endif
 
 #ifdef STARTUP_CODE
 extern char _sbss[];
@@ -21,8 +24,20 @@ ProgramVector programVector __attribute__ ((section (".pv")));
 
 extern "C" {
   void vApplicationMallocFailedHook( void ){
+#ifdef HEAP_STATS
+    error(0x60, pcHeapStatsSummary());
+#else
     error(0x60, "Memory overflow");
+#endif
   }
+#ifdef HEAP_STATS
+  void vHeapTraceMalloc( void *pv, size_t xWantedSize, BaseType_t xRegion, const void *pvSite ){
+    vHeapStatsMalloc(pv, xWantedSize, xRegion, pvSite);
+  }
+  void vHeapTraceFree( void *pv ){
+    vHeapStatsFree(pv);
+  }
+#endif
 }
 
 int main(void){
@@ -5,9 +5,9 @@ extern "C" void *__gxx_personality_v0;
 extern "C" void __cxa_end_cleanup (void);
 extern "C" void __cxa_pure_virtual(){}
 
-void * operator new(size_t size) { return pvPortMalloc(size); }
+void * operator new(size_t size) { traceHEAP_SITE(); return pvPortMalloc(size); }
 void * operator new(size_t, void * p) { return p ; }
-void * operator new[](size_t size) { return pvPortMalloc(size); }
+void * operator new[](size_t size) { traceHEAP_SITE(); return pvPortMalloc(size); }
 void operator delete(void* ptr) { vPortFree(ptr); }
 void operator delete[](void * ptr) { vPortFree(ptr); }
 //int _gettimeofday(struct timeval *__p, void *__tz){return 0;}
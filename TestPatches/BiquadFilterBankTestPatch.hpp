@@ -0,0 +1,106 @@
+#include "TestPatch.hpp"
+#include "BiquadFilterBank.h"
+
+class BiquadFilterBankTestPatch : public TestPatch {
+public:
+  /* bands stored one after the other in a single array */
+  class TestBuffer : public AudioBuffer {
+  public:
+    FloatArray samples;
+    int channels;
+    TestBuffer(FloatArray s, int ch) : samples(s), channels(ch) {}
+    FloatArray getSamples(int channel){
+      return samples.subArray(channel*getSize(), getSize());
+    }
+    int getChannels(){
+      return channels;
+    }
+    int getSize(){
+      return samples.getSize()/channels;
+    }
+    void clear(){
+      samples.clear();
+    }
+  };
+
+  void checkBands(int bands){
+    const int length = 200;
+    BiquadFilterBank* bank = BiquadFilterBank::create(bands, 128);
+    BiquadFilterBank* summed = BiquadFilterBank::create(bands, 128);
+    bank->setBandPasses(0.01, 0.8, 4);
+    summed->setBandPasses(0.01, 0.8, 4);
+    bank->setEnvelopeFollower(0.99);
+    for(int b=0; b<bands; b++)
+      summed->setGain(b, b*0.25f-1);
+    FloatArray input = FloatArray::create(length);
+    FloatArray samples = FloatArray::create(bands*length);
+    FloatArray output = FloatArray::create(length);
+    input.noise();
+    // in blocks of different sizes
+    int sizes[] = { 64, 1, 128, 7 };
+    for(int i=0, n=0; n<length; n+=sizes[i++]){
+      FloatArray block = FloatArray::create(bands*sizes[i]);
+      TestBuffer buffer(block, bands);
+      bank->process(input.subArray(n, sizes[i]), buffer);
+      for(int b=0; b<bands; b++)
+	samples.subArray(b*length+n, sizes[i]).copyFrom(buffer.getSamples(b));
+      summed->process(input.subArray(n, sizes[i]), output.subArray(n, sizes[i]));
+      FloatArray::destroy(block);
+    }
+    FloatArray expected = FloatArray::create(length);
+    FloatArray sum = FloatArray::create(length);
+    for(int b=0; b<bands; b++){
+      // each band is the same as a one stage BiquadFilter
+      BiquadFilter* filter = BiquadFilter::create(1);
+      filter->setBandPass(0.01*powf(80, b/(float)(bands-1)), 4);
+      expected.copyFrom(input);
+      filter->process(expected);
+      for(int n=0; n<length; n++)
+	CHECK_CLOSE(samples[b*length+n], expected[n], 1e-5);
+      float envelope = 0;
+      for(int n=0; n<length; n++)
+	envelope = 0.99f*envelope + 0.01f*fabsf(expected[n]);
+      CHECK_CLOSE(bank->getEnvelopes()[b], envelope, 1e-5);
+      for(int n=0; n<length; n++)
+	sum[n] += (b*0.25f-1)*expected[n];
+      BiquadFilter::destroy(filter);
+    }
+    for(int n=0; n<length; n++)
+      CHECK_CLOSE(output[n], sum[n], 1e-4);
+    BiquadFilterBank::destroy(bank);
+    BiquadFilterBank::destroy(summed);
+    FloatArray::destroy(input);
+    FloatArray::destroy(samples);
+    FloatArray::destroy(output);
+    FloatArray::destroy(expected);
+    FloatArray::destroy(sum);
+  }
+
+  BiquadFilterBankTestPatch(){
+    {
+      TEST("bands");
+      checkBands(3);
+      checkBands(16);
+      checkBands(21);
+    }
+    {
+      TEST("envelopes");
+      BiquadFilterBank* bank = BiquadFilterBank::create(4, 256);
+      bank->setBandPasses(0.02, 0.5, 8);
+      bank->setEnvelopeFollower(0.99);
+      FloatArray input = FloatArray::create(2048);
+      // a tone at the centre of the second band
+      float fc = 0.02*powf(25, 1/3.0f);
+      for(int i=0; i<2048; i++)
+	input[i] = sinf(M_PI*fc*i);
+      for(int i=0; i<2048; i+=256)
+	bank->process(input.subArray(i, 256));
+      CHECK(bank->getEnvelopes().getMaxIndex() == 1);
+      CHECK_CLOSE(bank->getEnvelopes()[1], 2/M_PI, 0.05);
+      bank->reset();
+      CHECK_EQUAL(bank->getEnvelopes().getMaxValue(), 0.0f);
+      BiquadFilterBank::destroy(bank);
+      FloatArray::destroy(input);
+    }
+  }
+};
@@ -0,0 +1,95 @@
+#include "TestPatch.hpp"
+#include "EventQueue.h"
+
+class EventQueueTestPatch : public TestPatch {
+public:
+  /* events delivered to this patch by EventQueue::process() */
+  PatchEvent received[4];
+  int count;
+
+  void buttonChanged(PatchButtonId bid, uint16_t value, uint16_t samples){
+    PatchEvent& event = received[count++ & 3];
+    event.type = BUTTON_EVENT;
+    event.id = bid;
+    event.value = value;
+    event.samples = samples;
+  }
+
+  void encoderChanged(PatchParameterId pid, int16_t delta, uint16_t samples){
+    PatchEvent& event = received[count++ & 3];
+    event.type = ENCODER_EVENT;
+    event.id = pid;
+    event.delta = delta;
+    event.samples = samples;
+  }
+
+  EventQueueTestPatch() : count(0) {
+    EventQueue<8>* queue = new EventQueue<8>();
+    PatchEvent event;
+    {
+      TEST("empty");
+      CHECK_EQUAL(queue->getSize(), 0);
+      CHECK(!queue->pop(event));
+    }
+    {
+      TEST("order");
+      CHECK(queue->pushButton(MIDI_NOTE_BUTTON+60, 4064, 12));
+      CHECK(queue->pushEncoder(PARAMETER_A, -3, 40));
+      CHECK_EQUAL(queue->getSize(), 2);
+      CHECK(queue->pop(event));
+      CHECK_EQUAL((int)event.type, (int)BUTTON_EVENT);
+      CHECK_EQUAL((int)event.id, MIDI_NOTE_BUTTON+60);
+      CHECK_EQUAL((int)event.value, 4064);
+      CHECK_EQUAL((int)event.samples, 12);
+      CHECK(queue->pop(event));
+      CHECK_EQUAL((int)event.type, (int)ENCODER_EVENT);
+      CHECK_EQUAL((int)event.delta, -3);
+      CHECK(!queue->pop(event));
+    }
+    {
+      TEST("overflow");
+      // wrap around the ring a few times
+      for(int i=0; i<20; ++i){
+	CHECK(queue->pushButton(PUSHBUTTON, i, 0));
+	CHECK(queue->pop(event));
+	CHECK_EQUAL((int)event.value, i);
+      }
+      for(int i=0; i<8; ++i)
+	CHECK(queue->pushButton(PUSHBUTTON, i, 0));
+      CHECK(!queue->pushButton(PUSHBUTTON, 8, 0));
+      CHECK_EQUAL((int)queue->getDropped(), 1);
+      for(int i=0; i<8; ++i){
+	CHECK(queue->pop(event));
+	CHECK_EQUAL((int)event.value, i);
+      }
+      CHECK(!queue->pop(event));
+    }
+    {
+      TEST("delivery");
+      CHECK(queue->pushButton(MIDI_NOTE_BUTTON+60, 40000, 12));
+      CHECK(queue->pushEncoder(PARAMETER_B, -300, 127));
+      CHECK(queue->pushButton(PUSHBUTTON, 0, 128));
+      CHECK(queue->pushEncoder(PARAMETER_C, 2, 65535));
+      queue->process(this, 128);
+      CHECK_EQUAL(count, 4);
+      CHECK_EQUAL(queue->getSize(), 0);
+      CHECK_EQUAL((int)received[0].type, (int)BUTTON_EVENT);
+      CHECK_EQUAL((int)received[0].id, MIDI_NOTE_BUTTON+60);
+      // values above 32767 keep their sign
+      CHECK_EQUAL((int)received[0].value, 40000);
+      CHECK_EQUAL((int)received[0].samples, 12);
+      CHECK_EQUAL((int)received[1].type, (int)ENCODER_EVENT);
+      CHECK_EQUAL((int)received[1].id, (int)PARAMETER_B);
+      CHECK_EQUAL((int)received[1].delta, -300);
+      CHECK_EQUAL((int)received[1].samples, 127);
+      // offsets past the end of the block are moved to the last sample
+      CHECK_EQUAL((int)received[2].id, (int)PUSHBUTTON);
+      CHECK_EQUAL((int)received[2].samples, 127);
+      CHECK_EQUAL((int)received[3].delta, 2);
+      CHECK_EQUAL((int)received[3].samples, 127);
+      queue->process(this, 128);
+      CHECK_EQUAL(count, 4);
+    }
+    delete queue;
+  }
+};
@@ -0,0 +1,88 @@
+#include "TestPatch.hpp"
+#include "FirDecimator.h"
+#include "FirInterpolator.h"
+
+class FirDecimatorTestPatch : public TestPatch {
+public:
+  /* filter x with h, with the coefficients in CMSIS order */
+  static float filter(FloatArray x, FloatArray coefficients, int index){
+    float y = 0;
+    int taps = coefficients.getSize();
+    for(int k=0; k<taps && k<=index; k++)
+      y += x[index-k]*coefficients[taps-1-k];
+    return y;
+  }
+
+  FirDecimatorTestPatch(){
+    {
+      TEST("decimate");
+      const int taps = 37;
+      FirDecimator* decimator = FirDecimator::create(4, taps, 64);
+      decimator->getCoefficients().noise();
+      FloatArray input = FloatArray::create(256);
+      FloatArray output = FloatArray::create(64);
+      input.noise();
+      // in blocks of every allowed size
+      int sizes[] = { 4, 64, 8, 12, 40, 64, 64 };
+      for(int i=0, n=0; n<256; n+=sizes[i++])
+	decimator->processBlock(input.subArray(n, sizes[i]), output.subArray(n/4, sizes[i]/4));
+      for(int i=0; i<64; i++)
+	CHECK_CLOSE(output[i], filter(input, decimator->getCoefficients(), 4*i), 1e-5);
+      FirDecimator::destroy(decimator);
+      FloatArray::destroy(input);
+      FloatArray::destroy(output);
+    }
+    {
+      TEST("interpolate");
+      const int taps = 36;
+      FirInterpolator* interpolator = FirInterpolator::create(3, taps, 32);
+      interpolator->getCoefficients().noise();
+      FloatArray input = FloatArray::create(100);
+      FloatArray zeros = FloatArray::create(300);
+      FloatArray output = FloatArray::create(300);
+      input.noise();
+      for(int i=0; i<100; i++)
+	zeros[3*i] = input[i];
+      int sizes[] = { 1, 32, 7, 32, 3, 25 };
+      for(int i=0, n=0; n<100; n+=sizes[i++])
+	interpolator->processBlock(input.subArray(n, sizes[i]), output.subArray(3*n, 3*sizes[i]));
+      for(int i=0; i<300; i++)
+	CHECK_CLOSE(output[i], filter(zeros, interpolator->getCoefficients(), i), 1e-5);
+      FirInterpolator::destroy(interpolator);
+      FloatArray::destroy(input);
+      FloatArray::destroy(zeros);
+      FloatArray::destroy(output);
+    }
+    {
+      TEST("lowpass");
+      FirDecimator* decimator = FirDecimator::create(4, 64, 256);
+      FirInterpolator* interpolator = FirInterpolator::create(4, 64, 64);
+      decimator->setLowPass(0.2);
+      interpolator->setLowPass(0.2);
+      CHECK_CLOSE(decimator->getCoefficients().getMean()*64, 1.0f, 1e-6);
+      CHECK_CLOSE(interpolator->getCoefficients().getMean()*64, 4.0f, 1e-6);
+      FloatArray input = FloatArray::create(256);
+      FloatArray low = FloatArray::create(64);
+      FloatArray output = FloatArray::create(256);
+      // a tone in the stopband is removed
+      for(int i=0; i<256; i++)
+	input[i] = sinf(2*M_PI*0.25*i);
+      for(int i=0; i<4; i++)
+	decimator->processBlock(input, low);
+      CHECK(low.getRms() < 1e-3);
+      // a constant passes through both
+      input.setAll(1);
+      for(int i=0; i<4; i++){
+	decimator->processBlock(input, low);
+	interpolator->processBlock(low, output);
+      }
+      CHECK_CLOSE(output.getMinValue(), 1.0f, 1e-3);
+      CHECK_CLOSE(output.getMaxValue(), 1.0f, 1e-3);
+      FirDecimator::destroy(decimator);
+      FirInterpolator::destroy(interpolator);
+      FloatArray::destroy(input);
+      FloatArray::destroy(low);
+      FloatArray::destroy(output);
+    }
+  }
+};
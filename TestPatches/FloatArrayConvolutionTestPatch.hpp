@@ -0,0 +1,99 @@
+#include "TestPatch.hpp"
+#include "FloatArray.h"
+
+/* Compares the FFT convolution and correlation with the direct computations */
+class FloatArrayConvolutionTestPatch : public TestPatch {
+public:
+  static void fillNoise(FloatArray array){
+    for(int i=0; i<array.getSize(); ++i)
+      array[i] = rand()/(float)RAND_MAX*2.0f - 1.0f;
+  }
+
+  /* largest difference, relative to the largest possible output */
+  float compare(int size1, int size2, bool fft){
+    FloatArray a = FloatArray::create(size1);
+    FloatArray b = FloatArray::create(size2);
+    FloatArray result = FloatArray::create(size1+size2+1);
+    FloatArray reference = FloatArray::create(size1+size2-1);
+    fillNoise(a);
+    fillNoise(b);
+    result.setAll(2.0f);
+    if(fft)
+      a.fftConvolve(b, result);
+    else
+      a.convolve(b, result);
+    a.convolve(b, reference, 0, size1+size2-1);
+    float error = 0;
+    for(int i=0; i<reference.getSize(); ++i)
+      error = max(error, fabsf(result[i]-reference[i]));
+    // elements past the end are left unchanged
+    CHECK_EQUAL(result[size1+size2-1], 2.0f);
+    CHECK_EQUAL(result[size1+size2], 2.0f);
+    FloatArray::destroy(a);
+    FloatArray::destroy(b);
+    FloatArray::destroy(result);
+    FloatArray::destroy(reference);
+    return error/min(size1, size2);
+  }
+
+  /* largest difference from the correlation computed here */
+  float compareCorrelation(bool fft){
+    FloatArray a = FloatArray::create(1000);
+    FloatArray b = FloatArray::create(200);
+    FloatArray result = FloatArray::create(1199);
+    FloatArray reference = FloatArray::create(1199);
+    fillNoise(a);
+    fillNoise(b);
+    result.setAll(2.0f);
+    if(fft)
+      a.fftCorrelate(b, result);
+    else
+      a.correlate(b, result);
+    for(int n=0; n<reference.getSize(); n++){
+      for(int k=0; k<b.getSize(); k++){
+	int i = n-b.getSize()+1+k;
+	if(i >= 0 && i < a.getSize())
+	  reference[n] += a[i]*b[k];
+      }
+    }
+    float error = 0;
+    for(int n=0; n<reference.getSize(); n++)
+      error = max(error, fabsf(result[n]-reference[n]));
+    FloatArray::destroy(a);
+    FloatArray::destroy(b);
+    FloatArray::destroy(result);
+    FloatArray::destroy(reference);
+    return error;
+  }
+
+  FloatArrayConvolutionTestPatch(){
+    {
+      TEST("fftConvolve");
+      CHECK(compare(1, 1, true) < 1e-6);
+      CHECK(compare(100, 7, true) < 1e-6);
+      CHECK(compare(7, 100, true) < 1e-6);
+      CHECK(compare(128, 128, true) < 1e-6);
+      CHECK(compare(1000, 300, true) < 1e-6);
+      CHECK(compare(513, 2000, true) < 1e-6);
+    }
+    {
+      TEST("fftConvolve with a kernel longer than the largest FFT");
+      CHECK(compare(3000, 5000, true) < 1e-6);
+      CHECK(compare(4097, 4097, true) < 1e-6);
+    }
+    {
+      TEST("convolve");
+      CHECK(compare(7, 100, false) < 1e-6);
+      CHECK(compare(32, 1000, false) < 1e-6);
+      CHECK(compare(2048, 256, false) < 1e-6);
+    }
+    {
+      TEST("correlate");
+      CHECK(compareCorrelation(false) < 2e-5);
+    }
+    {
+      TEST("fftCorrelate");
+      CHECK(compareCorrelation(true) < 2e-5);
+    }
+  }
+};
@@ -0,0 +1,183 @@
+#include "TestPatch.hpp"
+#include "FloatArray.h"
+
+/* Checks the vectorised FloatArray kernels against scalar loops, at sizes around multiples of the vector width */
+class FloatArrayKernelTestPatch : public TestPatch {
+public:
+  FloatArray a;
+  FloatArray b;
+  FloatArray c;
+  FloatArray expected;
+  FloatArray buffer;
+  static const int maxsize = 1001;
+
+  static bool isNaN(float x){
+    return x != x;
+  }
+
+  void fill(int size){
+    a = buffer.subArray(0, size);
+    b = buffer.subArray(maxsize, size);
+    c = buffer.subArray(2*maxsize, size);
+    expected = buffer.subArray(3*maxsize, size);
+    buffer.noise(-2, 2);
+  }
+
+  void checkEqual(FloatArray x, FloatArray y, float tolerance=0){
+    bool equal = x.getSize() == y.getSize();
+    for(int i=0; equal && i<x.getSize(); ++i)
+      equal = fabsf(x[i]-y[i]) <= tolerance || (isNaN(x[i]) && isNaN(y[i]));
+    CHECK(equal);
+  }
+
+  void checkMinMax(FloatArray x){
+    float value = x[0];
+    int index = 0;
+    for(int i=1; i<x.getSize(); ++i){
+      if(x[i] < value){
+	value = x[i];
+	index = i;
+      }
+    }
+    if(isNaN(value))
+      CHECK(isNaN(x.getMinValue()))
+    else
+      CHECK_EQUAL(x.getMinValue(), value);
+    CHECK_EQUAL(x.getMinIndex(), index);
+    value = x[0];
+    index = 0;
+    for(int i=1; i<x.getSize(); ++i){
+      if(x[i] > value){
+	value = x[i];
+	index = i;
+      }
+    }
+    if(isNaN(value))
+      CHECK(isNaN(x.getMaxValue()))
+    else
+      CHECK_EQUAL(x.getMaxValue(), value);
+    CHECK_EQUAL(x.getMaxIndex(), index);
+  }
+
+  void checkSize(int size){
+    fill(size);
+    checkMinMax(a);
+
+    double sum = 0, squares = 0;
+    for(int i=0; i<size; ++i){
+      sum += a[i];
+      squares += a[i]*a[i];
+    }
+    double mean = sum/size;
+    double deviations = 0;
+    for(int i=0; i<size; ++i)
+      deviations += (a[i]-mean)*(a[i]-mean);
+    CHECK_CLOSE(a.getMean(), mean, 1e-5);
+    CHECK_CLOSE(a.getPower(), squares, 1e-5*squares);
+    CHECK_CLOSE(a.getRms(), sqrt(squares/size), 1e-5);
+    if(size > 1){
+      CHECK_CLOSE(a.getVariance(), deviations/(size-1), 1e-5);
+      CHECK_CLOSE(a.getStandardDeviation(), sqrt(deviations/(size-1)), 1e-5);
+    }
+
+    for(int i=0; i<size; ++i)
+      expected[i] = fabsf(a[i]);
+    a.rectify(c);
+    checkEqual(c, expected);
+    for(int i=0; i<size; ++i)
+      expected[i] = a[i]+b[i];
+    a.add(b, c);
+    checkEqual(c, expected);
+    for(int i=0; i<size; ++i)
+      expected[i] = a[i]-b[i];
+    a.subtract(b, c);
+    checkEqual(c, expected);
+    for(int i=0; i<size; ++i)
+      expected[i] = a[i]*b[i];
+    a.multiply(b, c);
+    checkEqual(c, expected);
+    for(int i=0; i<size; ++i)
+      expected[i] = a[i]*0.3f;
+    a.multiply(0.3f, c);
+    checkEqual(c, expected);
+    for(int i=0; i<size; ++i)
+      expected[i] = -a[i];
+    a.negate(c);
+    checkEqual(c, expected);
+
+    // in place
+    for(int i=0; i<size; ++i)
+      expected[i] = a[i]+b[i]-b[i]*b[i];
+    c.copyFrom(a);
+    c.add(b);
+    b.multiply(b, b);
+    c.subtract(b);
+    checkEqual(c, expected, 1e-6);
+    for(int i=0; i<size; ++i)
+      expected[i] = -fabsf((c[i]+0.5f)*2.0f-0.25f);
+    c.add(0.5f);
+    c.multiply(2.0f);
+    c.subtract(0.25f);
+    c.rectify();
+    c.negate();
+    checkEqual(c, expected, 1e-6);
+    for(int i=0; i<size; ++i)
+      expected[i] = a[i] > 1 ? 1 : a[i] < -1 ? -1 : a[i];
+    c.copyFrom(a);
+    c.clip();
+    checkEqual(c, expected);
+    for(int i=0; i<size; ++i)
+      expected[i] = a[i] > 0.5f ? 0.5f : a[i] < -1.5f ? -1.5f : a[i];
+    c.copyFrom(a);
+    c.clip(-1.5f, 0.5f);
+    checkEqual(c, expected);
+    for(int i=0; i<size; ++i)
+      expected[i] = 0.7f;
+    c.setAll(0.7f);
+    checkEqual(c, expected);
+  }
+
+  void checkNaN(int size){
+    fill(size);
+    for(int i=0; i<size; i+=size/3+1){
+      // NaN at the start, the end and in between
+      a[i] = NAN;
+      checkMinMax(a);
+      a[size-1-i] = NAN;
+      checkMinMax(a);
+    }
+    for(int i=0; i<size; ++i)
+      expected[i] = isNaN(a[i]) ? NAN : fabsf(a[i]) > 1 ? copysignf(1, a[i]) : a[i];
+    c.copyFrom(a);
+    c.clip();
+    checkEqual(c, expected);
+    for(int i=0; i<size; ++i)
+      expected[i] = fabsf(a[i]);
+    a.rectify(c);
+    checkEqual(c, expected);
+    CHECK(isNaN(a.getMean()));
+    CHECK(isNaN(a.getRms()));
+  }
+
+  FloatArrayKernelTestPatch(){
+    buffer = FloatArray::create(4*maxsize);
+    {
+      TEST("kernels");
+      int sizes[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 24, 31, 32, 33, 100, 128, 1001 };
+      for(int i=0; i<(int)(sizeof(sizes)/sizeof(int)); ++i)
+	checkSize(sizes[i]);
+    }
+    {
+      TEST("NaN");
+      int sizes[] = { 1, 3, 8, 16, 17, 32, 33, 100 };
+      for(int i=0; i<(int)(sizeof(sizes)/sizeof(int)); ++i)
+	checkNaN(sizes[i]);
+      // the last of 32 elements
+      fill(32);
+      a[31] = NAN;
+      checkMinMax(a);
+      CHECK_EQUAL(a.getMaxValue(), a.subArray(0, 31).getMaxValue());
+    }
+    FloatArray::destroy(buffer);
+  }
+};
@@ -0,0 +1,121 @@
+#include "TestPatch.hpp"
+#include "FloatArray.h"
+
+/* Checks the approximations against libm in double precision, with the error bounds given in FloatArray.h */
+class FloatArrayMathTestPatch : public TestPatch {
+public:
+  FloatArray input;
+  FloatArray output;
+  static const int size = 10001; // not a multiple of the vector width
+
+  void fill(float from, float to){
+    for(int i=0; i<size; ++i)
+      input[i] = from + (to-from)*i/(size-1);
+  }
+
+  double absoluteError(double (*function)(double)){
+    double error = 0;
+    for(int i=0; i<size; ++i)
+      error = fmax(error, fabs(output[i] - function(input[i])));
+    return error;
+  }
+
+  double relativeError(double (*function)(double)){
+    double error = 0;
+    for(int i=0; i<size; ++i){
+      double expected = function(input[i]);
+      error = fmax(error, fabs(output[i] - expected)/expected);
+    }
+    return error;
+  }
+
+  static double pow2(double x){
+    return ::pow(2.0, x);
+  }
+
+  static double log2(double x){
+    return ::log(x)/::log(2.0);
+  }
+
+  FloatArrayMathTestPatch(){
+    input = FloatArray::create(size);
+    output = FloatArray::create(size);
+    {
+      TEST("sine");
+      fill(-M_PI, M_PI);
+      input.sine(output);
+      CHECK(absoluteError(::sin) < 2e-7);
+      fill(-1000, 1000);
+      input.sine(output);
+      CHECK(absoluteError(::sin) < 2e-7);
+      CHECK_EQUAL(output.getSize(), size);
+    }
+    {
+      TEST("hyperbolicTangent");
+      fill(-10, 10);
+      input.hyperbolicTangent(output);
+      CHECK(absoluteError(::tanh) < 5e-7);
+      input[0] = -100;
+      input[1] = 100;
+      input.hyperbolicTangent(output);
+      CHECK_EQUAL(output[0], -1.0f);
+      CHECK_EQUAL(output[1], 1.0f);
+    }
+    {
+      TEST("exp");
+      fill(-20, 20);
+      input.exp(output);
+      CHECK(relativeError(::exp) < 1.5e-6);
+      fill(-87, 88);
+      input.exp(output);
+      CHECK(relativeError(::exp) < 2.5e-7 + 88*6e-8);
+      input[0] = -1000;
+      input[1] = 1000;
+      input.exp(output);
+      CHECK(output[0] > 0);
+      CHECK(output[1] < INFINITY);
+    }
+    {
+      TEST("pow2");
+      fill(-126, 127);
+      input.pow2(output);
+      CHECK(relativeError(pow2) < 2.5e-7);
+      fill(-1, 1);
+      input.pow2(output);
+      CHECK(relativeError(pow2) < 2.5e-7);
+    }
+    {
+      TEST("log2");
+      fill(0.5, 2);
+      input.log2(output);
+      CHECK(absoluteError(log2) < 4e-7);
+      for(int i=0; i<size; ++i)
+	input[i] = expf(-80 + 160.0f*i/size);
+      input.log2(output);
+      for(int i=0; i<size; ++i)
+	CHECK(fabs(output[i] - log2(input[i])) < 4e-7 + fabs(log2(input[i]))*6e-8);
+    }
+    {
+      TEST("softClip");
+      fill(-2, 2);
+      input.softClip(output);
+      for(int i=0; i<size; ++i){
+	float x = input[i] > 1 ? 1 : input[i] < -1 ? -1 : input[i];
+	CHECK_EQUAL(output[i], x*(1.5f - 0.5f*x*x));
+      }
+      CHECK_EQUAL(output[0], -1.0f);
+      CHECK_EQUAL(output[size-1], 1.0f);
+    }
+    {
+      TEST("in place");
+      fill(-4, 4);
+      output.copyFrom(input);
+      output.exp();
+      output.log2();
+      for(int i=0; i<size; ++i)
+	CHECK_CLOSE(output[i], input[i]*1.44269504f, 1e-5);
+    }
+    FloatArray::destroy(input);
+    FloatArray::destroy(output);
+  }
+};
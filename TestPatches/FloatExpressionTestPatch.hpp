@@ -0,0 +1,106 @@
+#include "TestPatch.hpp"
+#include "FloatExpression.h"
+#include "StaticArray.h"
+
+class FloatExpressionTestPatch : public TestPatch {
+public:
+  FloatExpressionTestPatch(){
+    const int size = 1027; // not a multiple of the vector width
+    FloatArray a = FloatArray::create(size);
+    FloatArray b = FloatArray::create(size);
+    FloatArray out = FloatArray::create(size);
+    for(int i=0; i<size; ++i){
+      a[i] = sinf(i*0.1f);
+      b[i] = cosf(i*0.03f)*2;
+    }
+    {
+      TEST("add, subtract, multiply");
+      out = a + b;
+      for(int i=0; i<size; ++i)
+	CHECK_EQUAL(out[i], a[i]+b[i]);
+      out = a - b*0.5f;
+      for(int i=0; i<size; ++i)
+	CHECK_CLOSE(out[i], a[i]-b[i]*0.5f, DEFAULT_TOLERANCE);
+      out = 2.0f*a*b;
+      for(int i=0; i<size; ++i)
+	CHECK_CLOSE(out[i], 2*a[i]*b[i], DEFAULT_TOLERANCE);
+      out = 1.0f - a;
+      for(int i=0; i<size; ++i)
+	CHECK_CLOSE(out[i], 1-a[i], DEFAULT_TOLERANCE);
+    }
+    {
+      TEST("clip, rectify, negate");
+      out = clip(a*0.3f + b*0.7f);
+      for(int i=0; i<size; ++i){
+	float x = a[i]*0.3f + b[i]*0.7f;
+	CHECK_CLOSE(out[i], x > 1 ? 1 : x < -1 ? -1 : x, DEFAULT_TOLERANCE);
+      }
+      out = clip(b, -0.5f, 0.25f);
+      for(int i=0; i<size; ++i){
+	float x = b[i];
+	CHECK_EQUAL(out[i], x > 0.25f ? 0.25f : x < -0.5f ? -0.5f : x);
+      }
+      out = rectify(-b);
+      for(int i=0; i<size; ++i)
+	CHECK_EQUAL(out[i], fabsf(b[i]));
+    }
+    {
+      TEST("matches FloatArray methods");
+      FloatArray expected = FloatArray::create(size);
+      a.multiply(0.8f, expected);
+      expected.add(b);
+      expected.clip(1.5f);
+      out = clip(a*0.8f + b, 1.5f);
+      for(int i=0; i<size; ++i)
+	CHECK_CLOSE(out[i], expected[i], DEFAULT_TOLERANCE);
+      FloatArray::destroy(expected);
+    }
+    {
+      TEST("in place");
+      out.copyFrom(a);
+      out = out*out + out;
+      for(int i=0; i<size; ++i)
+	CHECK_CLOSE(out[i], a[i]*a[i]+a[i], DEFAULT_TOLERANCE);
+    }
+    {
+      TEST("sub array");
+      out.clear();
+      FloatArray part = out.subArray(10, 20);
+      part = a.subArray(0, 20) * 3.0f;
+      CHECK_EQUAL(out[9], 0.0f);
+      CHECK_CLOSE(out[10], a[0]*3, DEFAULT_TOLERANCE);
+      CHECK_CLOSE(out[29], a[19]*3, DEFAULT_TOLERANCE);
+      CHECK_EQUAL(out[30], 0.0f);
+    }
+    {
+      TEST("size of the shortest operand");
+      FloatArray part = b.subArray(0, 10);
+      CHECK_EQUAL((a + part).getSize(), 10);
+      CHECK_EQUAL((part + a).getSize(), 10);
+      CHECK_EQUAL((a*2.0f - part*0.5f).getSize(), 10);
+      CHECK_EQUAL((2.0f*a + 1.0f).getSize(), size);
+      CHECK_EQUAL(clip(part + a).getSize(), 10);
+    }
+    {
+      TEST("StaticFloatArray operands");
+      StaticFloatArray<8> s;
+      s.setAll(2);
+      FloatArray part = out.subArray(0, 8);
+      part = s*a + s;
+      for(int i=0; i<8; ++i)
+	CHECK_CLOSE(out[i], 2*a[i]+2, DEFAULT_TOLERANCE);
+    }
+    {
+      TEST("handle semantics unchanged");
+      FloatArray c = a;
+      CHECK(c.getData() == a.getData());
+      c = b;
+      CHECK(c.getData() == b.getData());
+      float* p = a + 1;
+      CHECK(p == a.getData()+1);
+    }
+    FloatArray::destroy(a);
+    FloatArray::destroy(b);
+    FloatArray::destroy(out);
+  }
+};
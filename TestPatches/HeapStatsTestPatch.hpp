@@ -0,0 +1,127 @@
+#include "TestPatch.hpp"
+#include "heap_stats.h"
+#include "ComplexFloatArray.h"
+#include <string.h>
+
+/* Checks the heap statistics: what allocations are attributed to, and the table of live blocks */
+class HeapStatsTestPatch : public TestPatch {
+public:
+  static const int blocks = 5;
+  /* addresses inside this object, which are never the start of a live block */
+  uint8_t fake[HEAP_STATS_MAX_BLOCKS*64] __attribute__ ((aligned (8)));
+
+  /* the same hash as heap_stats.c */
+  static uint32_t getSlot(const void* pv){
+    return (uint32_t)(((uintptr_t)pv >> 3) * 2654435761u) & (HEAP_STATS_MAX_BLOCKS-1);
+  }
+
+  /* the nth fake address that hashes to slot */
+  void* getAddress(uint32_t slot, int n){
+    for(int i=0; i<(int)sizeof(fake); i+=8){
+      if(getSlot(fake+i) == (slot & (HEAP_STATS_MAX_BLOCKS-1)) && n-- == 0)
+	return fake+i;
+    }
+    return NULL;
+  }
+
+  /* the next order in lexicographic order, false after the last */
+  static bool nextPermutation(int* order, int size){
+    int i = size-2;
+    while(i >= 0 && order[i] > order[i+1])
+      i--;
+    if(i < 0)
+      return false;
+    int j = size-1;
+    while(order[j] < order[i])
+      j--;
+    int tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+    for(int k=i+1, l=size-1; k<l; k++, l--){
+      tmp = order[k]; order[k] = order[l]; order[l] = tmp;
+    }
+    return true;
+  }
+
+  static int getSiteCount(){
+    int count = 0;
+    while(pxHeapStatsGetSite(count) != NULL)
+      count++;
+    return count;
+  }
+
+  static const HeapSiteStats_t* findSite(const void* site){
+    for(int i=0; pxHeapStatsGetSite(i) != NULL; i++)
+      if(pxHeapStatsGetSite(i)->pvSite == site && pxHeapStatsGetSite(i)->pcTag == NULL)
+	return pxHeapStatsGetSite(i);
+    return NULL;
+  }
+
+  /*
+   * Blocks that collide, inserted in order, so that each one is displaced
+   * from its home slot by the ones before it:
+   * a and b at home, c and d one and three slots on, e one slot on.
+   * Each free must still find the others after moving them back.
+   */
+  void checkDeletes(uint32_t home){
+    void* addresses[blocks] = {
+      getAddress(home, 0), getAddress(home, 1), getAddress(home+1, 0),
+      getAddress(home, 2), getAddress(home+3, 0)
+    };
+    int order[blocks] = { 0, 1, 2, 3, 4 };
+    bool credited = true;
+    do{
+      for(int i=0; i<blocks; i++)
+	vHeapStatsMalloc(addresses[i], 1<<i, -1, this);
+      const HeapSiteStats_t* site = findSite(this);
+      REQUIRE(site != NULL);
+      credited = credited && site->xBytes == (1<<blocks)-1;
+      for(int i=0; i<blocks; i++){
+	size_t bytes = site->xBytes;
+	vHeapStatsFree(addresses[order[i]]);
+	credited = credited && site->xBytes == bytes-(1<<order[i]);
+      }
+      // freeing again finds nothing
+      vHeapStatsFree(addresses[0]);
+      credited = credited && site->xBytes == 0;
+    }while(nextPermutation(order, blocks));
+    CHECK(credited);
+  }
+
+  HeapStatsTestPatch(){
+    {
+      TEST("allocations are attributed to the caller of create()");
+      int sites = getSiteCount();
+      FloatArray a = FloatArray::create(100);
+      FloatArray b = FloatArray::create(200);
+      FloatArray c = FloatArray::create(100, MEMORY_FAST);
+      ComplexFloatArray d = ComplexFloatArray::create(50);
+      // one site each, not one for FloatArray::create
+      REQUIRE(getSiteCount() == sites+4);
+      CHECK_EQUAL(pxHeapStatsGetSite(sites)->xBytes, sizeof(float)*100);
+      CHECK_EQUAL(pxHeapStatsGetSite(sites+1)->xBytes, sizeof(float)*200);
+      CHECK_EQUAL(pxHeapStatsGetSite(sites+2)->xBytes, sizeof(float)*100);
+      CHECK_EQUAL(pxHeapStatsGetSite(sites+3)->xBytes, sizeof(ComplexFloat)*50);
+      {
+	MemoryTag tag("tagged");
+	FloatArray e = FloatArray::create(10);
+	REQUIRE(getSiteCount() == sites+5);
+	CHECK(strcmp(pxHeapStatsGetSite(sites+4)->pcTag, "tagged") == 0);
+	FloatArray::destroy(e);
+      }
+      FloatArray::destroy(a);
+      FloatArray::destroy(b);
+      FloatArray::destroy(c);
+      ComplexFloatArray::destroy(d);
+      for(int i=sites; i<sites+5; i++)
+	CHECK_EQUAL(pxHeapStatsGetSite(i)->xBytes, (size_t)0);
+    }
+    {
+      TEST("live blocks are found after deletes");
+      uint32_t frees = pxHeapStatsGet()->ulFrees;
+      checkDeletes(100);
+      // probe sequences that wrap around the end of the table
+      checkDeletes(HEAP_STATS_MAX_BLOCKS-2);
+      checkDeletes(HEAP_STATS_MAX_BLOCKS-1);
+      CHECK_EQUAL(pxHeapStatsGet()->ulFrees, frees+3*120*blocks);
+    }
+  }
+};
@@ -0,0 +1,119 @@
+#include "TestPatch.hpp"
+#include "heap.h"
+#include <string.h>
+
+extern const HeapRegion_t testHeapRegions[];
+
+/*
+ * Random allocations and frees against the heap selected with HEAP, e.g.
+ * make TEST=HeapTest HEAP=heap_tlsf test
+ */
+class HeapTestPatch : public TestPatch {
+public:
+  static const int regions = 3;
+  static const int maxblocks = 400;
+  uint8_t* blocks[maxblocks];
+  size_t sizes[maxblocks];
+  size_t regionFree[regions];
+  int freeBlocks[regions];
+
+  static void countFreeBlock(void* block, size_t size, void* context){
+    HeapTestPatch* test = (HeapTestPatch*)context;
+    BaseType_t region = xPortGetHeapRegion(block);
+    if(region >= 0 && region < regions)
+      test->freeBlocks[region]++;
+  }
+
+  void countFreeBlocks(){
+    for(int i=0; i<regions; i++)
+      freeBlocks[i] = 0;
+    vPortForEachFreeBlock(countFreeBlock, this);
+  }
+
+  /* each block is filled with its index, so that overlapping blocks are found when freed */
+  bool allocate(int i, size_t size, BaseType_t region){
+    uint8_t* ptr = (uint8_t*)(region < 0 ? pvPortMalloc(size) : pvPortMallocFrom(size, region));
+    if(ptr == NULL)
+      return false;
+    BaseType_t r = xPortGetHeapRegion(ptr);
+    CHECK(region < 0 || r == region);
+    CHECK(r >= 0 && r < regions);
+    if(r >= 0 && r < regions){
+      const HeapRegion_t& bounds = testHeapRegions[r];
+      CHECK(ptr >= bounds.pucStartAddress && ptr+size <= bounds.pucStartAddress+bounds.xSizeInBytes);
+    }
+    CHECK(((uintptr_t)ptr & portBYTE_ALIGNMENT_MASK) == 0);
+    memset(ptr, i, size);
+    blocks[i] = ptr;
+    sizes[i] = size;
+    return true;
+  }
+
+  void release(int i){
+    bool intact = true;
+    for(size_t j=0; j<sizes[i]; j++)
+      intact = intact && blocks[i][j] == (uint8_t)i;
+    CHECK(intact);
+    vPortFree(blocks[i]);
+    blocks[i] = NULL;
+  }
+
+  HeapTestPatch(){
+    size_t initial = xPortGetFreeHeapSize();
+    for(int i=0; i<regions; i++)
+      regionFree[i] = xPortGetFreeRegionSize(i);
+    for(int i=0; i<maxblocks; i++)
+      blocks[i] = NULL;
+    {
+      TEST("free blocks coalesce");
+      countFreeBlocks();
+      int initialBlocks[regions];
+      for(int i=0; i<regions; i++)
+	initialBlocks[i] = freeBlocks[i];
+      CHECK(allocate(0, 100, 1));
+      CHECK(allocate(1, 200, 1));
+      CHECK(allocate(2, 300, 1));
+      CHECK(allocate(3, 400, 1));
+      // with the next block
+      release(1);
+      release(0);
+      countFreeBlocks();
+      CHECK_EQUAL(freeBlocks[1], initialBlocks[1]+1);
+      // with the previous and the next block
+      release(3);
+      release(2);
+      countFreeBlocks();
+      CHECK_EQUAL(freeBlocks[1], initialBlocks[1]);
+      CHECK_EQUAL(xPortGetFreeRegionSize(1), regionFree[1]);
+      // the whole region can be allocated again
+      CHECK(allocate(0, regionFree[1]/2, 1));
+      release(0);
+    }
+    {
+      TEST("random allocations");
+      srand(1);
+      for(int n=0; n<20000; n++){
+	int i = rand()%maxblocks;
+	if(blocks[i] != NULL){
+	  release(i);
+	}else{
+	  // mostly small objects, some buffers and the occasional delay line
+	  int r = rand()%100;
+	  size_t size = r < 70 ? 1+rand()%64 : r < 97 ? 1+rand()%4096 : 1+rand()%65536;
+	  BaseType_t region = rand()%(regions+1)-1;
+	  allocate(i, size, region);
+	}
+      }
+      for(int i=0; i<maxblocks; i++)
+	if(blocks[i] != NULL)
+	  release(i);
+      CHECK_EQUAL(xPortGetFreeHeapSize(), initial);
+      for(int i=0; i<regions; i++)
+	CHECK_EQUAL(xPortGetFreeRegionSize(i), regionFree[i]);
+      // everything has coalesced back into one free block per region
+      countFreeBlocks();
+      for(int i=0; i<regions; i++)
+	CHECK_EQUAL(freeBlocks[i], 1);
+    }
+  }
+};
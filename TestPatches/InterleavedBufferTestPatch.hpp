@@ -0,0 +1,45 @@
+#include "TestPatch.hpp"
+#include "InterleavedBuffer.hpp"
+
+class InterleavedBufferTestPatch : public TestPatch {
+public:
+  InterleavedBufferTestPatch(){
+    const int size = 37;
+    int32_t in[size*2]; // codec buffers are word aligned
+    int32_t out[size*2];
+    int16_t* codecIn = (int16_t*)in;
+    int16_t* codecOut = (int16_t*)out;
+    int16_t frames[size*4];
+    for(int i=0; i<size*4; ++i)
+      frames[i] = (rand() & 0xffff) - 0x8000;
+    memcpy(in, frames, sizeof(frames));
+    InterleavedBuffer* buffer = new InterleavedBuffer();
+    {
+      TEST("split");
+      buffer->split(codecIn, codecOut, size);
+      IntArray input = buffer->getInput();
+      CHECK_EQUAL(buffer->getSize(), size);
+      CHECK_EQUAL(input.getSize(), size*2);
+      for(int i=0; i<size*2; ++i){
+#if AUDIO_BITDEPTH == 16
+	int32_t expected = frames[i] << 16;
+#elif defined AUDIO_BIGEND
+	int32_t expected = (frames[i*2] << 16) | (uint16_t)frames[i*2+1];
+#else
+	int32_t expected = (frames[i*2+1] << 16) | (uint16_t)frames[i*2];
+#endif
+	CHECK_EQUAL(input[i], expected);
+      }
+    }
+    {
+      TEST("comb");
+      IntArray input = buffer->getInput();
+      IntArray output = buffer->getOutput();
+      for(int i=0; i<output.getSize(); ++i)
+	output[i] = input[i];
+      buffer->comb(codecOut);
+      CHECK(memcmp(codecOut, frames, sizeof(frames)) == 0);
+    }
+    delete buffer;
+  }
+};
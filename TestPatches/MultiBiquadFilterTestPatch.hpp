@@ -0,0 +1,162 @@
+#include "TestPatch.hpp"
+#include "MultiBiquadFilter.h"
+
+class MultiBiquadFilterTestPatch : public TestPatch {
+public:
+  /* channels as separate arrays of a larger block */
+  class TestBuffer : public AudioBuffer {
+  public:
+    FloatArray* samples;
+    int channels;
+    int size;
+    TestBuffer(FloatArray* s, int ch, int sz) : samples(s), channels(ch), size(sz) {}
+    FloatArray getSamples(int channel){
+      return samples[channel].subArray(0, size);
+    }
+    int getChannels(){
+      return channels;
+    }
+    int getSize(){
+      return size;
+    }
+    void clear(){}
+  };
+
+  void checkChannels(int channels){
+    const int stages = 3;
+    const int length = 200;
+    MultiBiquadFilter* multi = MultiBiquadFilter::create(channels, stages, 128);
+    BiquadFilter* filters[8];
+    FloatArray input[8];
+    FloatArray output[8];
+    FloatArray expected[8];
+    multi->setPeak(0.1, 2, 0.9);
+    for(int ch=0; ch<channels; ch++){
+      filters[ch] = BiquadFilter::create(stages);
+      filters[ch]->setPeak(0.1, 2, 0.9);
+      input[ch] = FloatArray::create(length);
+      output[ch] = FloatArray::create(length);
+      expected[ch] = FloatArray::create(length);
+      input[ch].noise();
+      expected[ch].copyFrom(input[ch]);
+      filters[ch]->process(expected[ch]);
+    }
+    // in blocks of different sizes
+    int sizes[] = { 64, 1, 128, 7 };
+    FloatArray in[8];
+    FloatArray out[8];
+    for(int i=0, n=0; n<length; n+=sizes[i++]){
+      for(int ch=0; ch<channels; ch++){
+	in[ch] = input[ch].subArray(n, sizes[i]);
+	out[ch] = output[ch].subArray(n, sizes[i]);
+      }
+      TestBuffer a(in, channels, sizes[i]);
+      TestBuffer b(out, channels, sizes[i]);
+      multi->process(a, b);
+    }
+    for(int ch=0; ch<channels; ch++){
+      for(int n=0; n<length; n++)
+	CHECK_CLOSE(output[ch][n], expected[ch][n], 1e-5);
+      BiquadFilter::destroy(filters[ch]);
+      FloatArray::destroy(input[ch]);
+      FloatArray::destroy(output[ch]);
+      FloatArray::destroy(expected[ch]);
+    }
+    MultiBiquadFilter::destroy(multi);
+  }
+
+  MultiBiquadFilterTestPatch(){
+    {
+      TEST("mono");
+      checkChannels(1);
+    }
+    {
+      TEST("stereo");
+      checkChannels(2);
+    }
+    {
+      TEST("odd channels");
+      checkChannels(3);
+      checkChannels(5);
+    }
+    {
+      TEST("eight channels");
+      checkChannels(8);
+    }
+    {
+      TEST("stages set separately");
+      MultiBiquadFilter* multi = MultiBiquadFilter::create(2, 3, 64);
+      MultiBiquadFilter* copy = MultiBiquadFilter::create(2, 3, 64);
+      BiquadFilter* filter = BiquadFilter::create(3);
+      multi->getFilterStage(0).setLowShelf(0.01, 0.7);
+      multi->getFilterStage(1).setPeak(0.1, 2, 0.3);
+      multi->getFilterStage(2).setHighShelf(0.5, 0.6);
+      filter->getFilterStage(0).setLowShelf(0.01, 0.7);
+      filter->getFilterStage(1).setPeak(0.1, 2, 0.3);
+      filter->getFilterStage(2).setHighShelf(0.5, 0.6);
+      CHECK(multi->getCoefficients().equals(filter->getCoefficients()));
+      copy->setCoefficients(filter->getCoefficients());
+      CHECK(copy->getCoefficients().equals(filter->getCoefficients()));
+      FloatArray samples[2];
+      FloatArray copied[2];
+      for(int ch=0; ch<2; ch++){
+	samples[ch] = FloatArray::create(64);
+	copied[ch] = FloatArray::create(64);
+	samples[ch].noise();
+	copied[ch].copyFrom(samples[ch]);
+      }
+      FloatArray expected = FloatArray::create(64);
+      expected.copyFrom(samples[1]);
+      filter->process(expected);
+      TestBuffer buffer(samples, 2, 64);
+      multi->process(buffer);
+      TestBuffer copiedBuffer(copied, 2, 64);
+      copy->process(copiedBuffer);
+      for(int n=0; n<64; n++)
+	CHECK_CLOSE(samples[1][n], expected[n], 1e-5);
+      CHECK(samples[0].equals(copied[0]));
+      CHECK(samples[1].equals(copied[1]));
+      // one stage is still copied to all stages
+      copy->setCoefficients(filter->getFilterStage(1).getCoefficients());
+      for(int k=0; k<3; k++)
+	CHECK(copy->getFilterStage(k).getCoefficients().equals(filter->getFilterStage(1).getCoefficients()));
+      MultiBiquadFilter::destroy(multi);
+      MultiBiquadFilter::destroy(copy);
+      BiquadFilter::destroy(filter);
+      for(int ch=0; ch<2; ch++){
+	FloatArray::destroy(samples[ch]);
+	FloatArray::destroy(copied[ch]);
+      }
+      FloatArray::destroy(expected);
+    }
+    {
+      TEST("in place");
+      MultiBiquadFilter* multi = MultiBiquadFilter::create(2, 2, 64);
+      BiquadFilter* filter = BiquadFilter::create(2);
+      multi->setLowPass(0.2, FilterStage::BUTTERWORTH_Q);
+      filter->setLowPass(0.2, FilterStage::BUTTERWORTH_Q);
+      FloatArray samples[2];
+      samples[0] = FloatArray::create(64);
+      samples[1] = FloatArray::create(64);
+      FloatArray expected = FloatArray::create(64);
+      samples[0].noise();
+      samples[1].copyFrom(samples[0]);
+      expected.copyFrom(samples[0]);
+      filter->process(expected);
+      TestBuffer buffer(samples, 2, 64);
+      multi->process(buffer);
+      CHECK(samples[0].equals(samples[1]));
+      for(int n=0; n<64; n++)
+	CHECK_CLOSE(samples[0][n], expected[n], 1e-5);
+      multi->reset();
+      samples[0].setAll(0);
+      multi->process(buffer);
+      CHECK_EQUAL(samples[0].getMaxValue(), 0.0f);
+      MultiBiquadFilter::destroy(multi);
+      BiquadFilter::destroy(filter);
+      FloatArray::destroy(samples[0]);
+      FloatArray::destroy(samples[1]);
+      FloatArray::destroy(expected);
+    }
+  }
+};
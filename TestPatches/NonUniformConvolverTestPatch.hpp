@@ -0,0 +1,87 @@
+#include "TestPatch.hpp"
+#include "NonUniformConvolver.h"
+
+class NonUniformConvolverTestPatch : public TestPatch {
+public:
+  static void fillNoise(FloatArray array){
+    for(int i=0; i<array.getSize(); ++i)
+      array[i] = rand()/(float)RAND_MAX*2.0f - 1.0f;
+  }
+
+  /* largest difference from the FFT convolution of the whole input, relative to the number of taps */
+  float compare(int blockSize, int taps, int maxLength, int length){
+    FloatArray input = FloatArray::create(length);
+    FloatArray output = FloatArray::create(length);
+    FloatArray impulse = FloatArray::create(taps);
+    FloatArray reference = FloatArray::create(length+taps-1);
+    fillNoise(input);
+    fillNoise(impulse);
+    input.fftConvolve(impulse, reference);
+    NonUniformConvolver* convolver = NonUniformConvolver::create(blockSize, maxLength);
+    convolver->setImpulseResponse(impulse);
+    for(int i=0; i<length; i+=blockSize){
+      // in place
+      output.subArray(i, blockSize).copyFrom(input.subArray(i, blockSize));
+      convolver->process(output.subArray(i, blockSize), output.subArray(i, blockSize));
+    }
+    float error = 0;
+    for(int i=0; i<output.getSize(); ++i)
+      error = max(error, fabsf(output[i]-reference[i]));
+    NonUniformConvolver::destroy(convolver);
+    FloatArray::destroy(input);
+    FloatArray::destroy(output);
+    FloatArray::destroy(impulse);
+    FloatArray::destroy(reference);
+    return error/taps;
+  }
+
+  NonUniformConvolverTestPatch(){
+    {
+      TEST("head only");
+      CHECK(compare(16, 1, 1, 256) < 1e-6);
+      CHECK(compare(64, 100, 128, 1024) < 1e-6);
+      CHECK(compare(2048, 5000, 5000, 8192) < 1e-6);
+    }
+    {
+      TEST("stages");
+      CHECK(compare(16, 33, 33, 512) < 1e-6);
+      CHECK(compare(16, 1000, 1000, 2048) < 1e-6);
+      CHECK(compare(64, 3000, 3000, 4096) < 1e-6);
+      CHECK(compare(1024, 5000, 5000, 8192) < 1e-6);
+      CHECK(compare(32, 500, 3000, 2048) < 1e-6);
+    }
+    {
+      TEST("long impulse response");
+      CHECK(compare(16, 10000, 10000, 16384) < 1e-6);
+      CHECK(compare(128, 20000, 20000, 32768) < 1e-6);
+    }
+    {
+      TEST("default constructor");
+      NonUniformConvolver* convolver = new NonUniformConvolver();
+      CHECK_EQUAL(convolver->getBlockSize(), 0);
+      delete convolver;
+    }
+    {
+      TEST("reset");
+      NonUniformConvolver* convolver = NonUniformConvolver::create(32, 1000);
+      FloatArray impulse = FloatArray::create(1000);
+      fillNoise(impulse);
+      convolver->setImpulseResponse(impulse);
+      FloatArray buffer = FloatArray::create(32);
+      for(int i=0; i<10; ++i){
+	fillNoise(buffer);
+	convolver->process(buffer, buffer);
+      }
+      convolver->reset();
+      for(int i=0; i<40; ++i){
+	buffer.clear();
+	convolver->process(buffer, buffer);
+	CHECK_EQUAL(buffer.getMaxValue(), 0.0f);
+	CHECK_EQUAL(buffer.getMinValue(), 0.0f);
+      }
+      NonUniformConvolver::destroy(convolver);
+      FloatArray::destroy(impulse);
+      FloatArray::destroy(buffer);
+    }
+  }
+};
@@ -0,0 +1,86 @@
+#include "TestPatch.hpp"
+#include "ProgramVector.h"
+#include "PatchProcessor.h"
+
+PatchProcessor* getInitialisingPatchProcessor();
+
+/* Checks the ramp kernels, and that parameter ramps are computed once per block and shared */
+class ParameterRampTestPatch : public TestPatch {
+public:
+  void checkRamp(int size){
+    FloatArray array = FloatArray::create(size);
+    array.ramp(0.5, -0.5);
+    for(int n=0; n<size; n++)
+      CHECK_CLOSE(array[n], 0.5f-(n+1)/(float)size, 1e-6);
+    CHECK_EQUAL(array[size-1], -0.5f);
+    array.expRamp(0.01, 10);
+    for(int n=0; n<size; n++)
+      CHECK_CLOSE(array[n]/(0.01f*powf(1000, (n+1)/(float)size)), 1.0f, 1e-4);
+    CHECK_EQUAL(array[size-1], 10.0f);
+    FloatArray::destroy(array);
+  }
+
+  /* set a parameter and start a new block */
+  void setParameter(PatchParameterId pid, int16_t value){
+    getProgramVector()->parameters[pid] = value;
+    getInitialisingPatchProcessor()->setParameterValues(getProgramVector()->parameters);
+  }
+
+  ParameterRampTestPatch(){
+    {
+      TEST("ramp");
+      int sizes[] = { 1, 2, 3, 4, 5, 7, 8, 9, 16, 17, 128, 1001 };
+      for(int i=0; i<(int)(sizeof(sizes)/sizeof(int)); ++i)
+	checkRamp(sizes[i]);
+    }
+    {
+      TEST("getParameterRamp starts at the current value");
+      setParameter(PARAMETER_A, 1024);
+      FloatArray ramp = getParameterRamp(PARAMETER_A);
+      CHECK_EQUAL(ramp.getSize(), getBlockSize());
+      CHECK_EQUAL(ramp.getMinValue(), 0.25f);
+      CHECK_EQUAL(ramp.getMaxValue(), 0.25f);
+    }
+    {
+      TEST("getParameterRamp is computed once per block and shared");
+      setParameter(PARAMETER_A, 3072);
+      FloatArray first = getParameterRamp(PARAMETER_A);
+      CHECK_CLOSE(first[0], 0.25f+0.5f/getBlockSize(), 1e-6);
+      CHECK_EQUAL(first[getBlockSize()-1], 0.75f);
+      // the same array, left unchanged by a second caller asking for another mode
+      FloatArray second = getParameterRamp(PARAMETER_A, true);
+      CHECK((float*)first == (float*)second);
+      CHECK_CLOSE(second[0], 0.25f+0.5f/getBlockSize(), 1e-6);
+      // other parameters have their own array
+      setParameter(PARAMETER_B, 2048);
+      FloatArray other = getParameterRamp(PARAMETER_B);
+      CHECK((float*)other != (float*)first);
+    }
+    {
+      TEST("getParameterRamp continues from the last ramp");
+      setParameter(PARAMETER_A, 2048);
+      setParameter(PARAMETER_A, 2048);
+      FloatArray ramp = getParameterRamp(PARAMETER_A);
+      CHECK_CLOSE(ramp[0], 0.75f-0.25f/getBlockSize(), 1e-6);
+      CHECK_EQUAL(ramp[getBlockSize()-1], 0.5f);
+      // a new ramp in the same array for the next block
+      setParameter(PARAMETER_A, 2048);
+      FloatArray next = getParameterRamp(PARAMETER_A);
+      CHECK((float*)next == (float*)ramp);
+      CHECK_EQUAL(next.getMinValue(), 0.5f);
+      CHECK_EQUAL(next.getMaxValue(), 0.5f);
+    }
+    {
+      TEST("exponential getParameterRamp is floored at one step");
+      setParameter(PARAMETER_C, 0);
+      FloatArray ramp = getParameterRamp(PARAMETER_C, true);
+      CHECK_EQUAL(ramp.getMinValue(), 1.0f/4096);
+      CHECK_EQUAL(ramp.getMaxValue(), 1.0f/4096);
+      setParameter(PARAMETER_C, 4096);
+      ramp = getParameterRamp(PARAMETER_C, true);
+      for(int n=0; n<getBlockSize(); n++)
+	CHECK_CLOSE(ramp[n]*4096, powf(4096, (n+1)/(float)getBlockSize()), 1e-4*ramp[n]*4096);
+      CHECK_EQUAL(ramp[getBlockSize()-1], 1.0f);
+    }
+  }
+};
@@ -0,0 +1,187 @@
+#include "TestPatch.hpp"
+#include "ProgramVector.h"
+#include "PatchProcessor.h"
+#include "SmoothValue.h"
+
+PatchProcessor* getInitialisingPatchProcessor();
+
+/* Checks how PatchProcessor turns raw parameter values into patch parameters */
+class ParameterUpdateTestPatch : public TestPatch {
+public:
+  /* the heap allocated LinearParameterUpdater that the flat table replaced */
+  template<typename T, typename V>
+  class OldUpdater {
+  private:
+    T minimum;
+    T maximum;
+    V value;
+  public:
+    OldUpdater(T min, T max, V initialValue)
+      : minimum(min), maximum(max), value(initialValue) {}
+    T update(int16_t newValue){
+      value = (newValue*(maximum-minimum))/4096+minimum;
+      return (T)value;
+    }
+  };
+
+  FloatParameter expskew;
+  FloatParameter logskew;
+  FloatParameter cubic;
+  IntParameter steps;
+  FloatParameter sameskew;
+  FloatParameter linear;
+  FloatParameter smooth;
+  FloatParameter floats[4];
+  IntParameter ints[4];
+  FloatParameter slow;
+  int changes;
+  PatchParameterId changedId;
+  float changedValue;
+
+  void parameterChanged(PatchParameterId pid, float value){
+    changes++;
+    changedId = pid;
+    changedValue = value;
+  }
+
+  /* set a parameter and start a new block */
+  void setParameter(PatchParameterId pid, int16_t value){
+    getProgramVector()->parameters[pid] = value;
+    getInitialisingPatchProcessor()->setParameterValues(getProgramVector()->parameters);
+  }
+
+  ParameterUpdateTestPatch(){
+    expskew = getFloatParameter("exp", 0, 10, 0, 0, 0, EXP);
+    logskew = getFloatParameter("log", -1, 1, 0, 0, 0, LOG);
+    cubic = getFloatParameter("cubic", 0, 1, 0, 0, 0, 3.0f);
+    steps = getIntParameter("steps", 0, 100, 0, 0, 0, LOG);
+    sameskew = getFloatParameter("sameskew", 0, 1, 0, 0, 0, EXP);
+    linear = getFloatParameter("linear", 0, 1);
+    smooth = getFloatParameter("smooth", 0, 1, 0, 0.9);
+    // one of each filter: none, smooth, stiff, smooth and stiff
+    for(int i=0; i<4; i++)
+      floats[i] = getFloatParameter("float", 0, 10, 0, (i&1)*0.9, (i>>1)*0.05);
+    for(int i=0; i<4; i++)
+      ints[i] = getIntParameter("int", 0, 100, 0, (i&1)*0.9, (i>>1)*0.05);
+    slow = getFloatParameter("slow", 0, 10, 0, 0.999);
+    {
+      TEST("skew tables");
+      for(int i=0; i<4096; i++){
+	setParameter(PARAMETER_A, i);
+	setParameter(PARAMETER_B, i);
+	setParameter(PARAMETER_C, i);
+	setParameter(PARAMETER_D, i);
+	setParameter(PARAMETER_E, i);
+	CHECK_CLOSE(expskew.getValue(), 10*powf(i/4096.0f, 1/EXP), 1e-5);
+	CHECK_CLOSE(logskew.getValue(), 2*powf(i/4096.0f, 1/LOG)-1, 1e-6);
+	CHECK_CLOSE(cubic.getValue(), powf(i/4096.0f, 1/3.0f), 1e-6);
+	CHECK_CLOSE(steps.getValue(), (int)(100*powf(i/4096.0f, 1/LOG)), 1);
+	CHECK_CLOSE(sameskew.getValue(), expskew.getValue()/10, 1e-6);
+      }
+      // out of range values are clamped
+      setParameter(PARAMETER_A, -1);
+      CHECK_EQUAL(expskew.getValue(), 0.0f);
+      setParameter(PARAMETER_A, 4096);
+      CHECK_CLOSE(expskew.getValue(), 10*powf(4095/4096.0f, 1/EXP), 1e-5);
+    }
+    getInitialisingPatchProcessor()->setPatch(this);
+    changes = 0;
+    {
+      TEST("unchanged parameters are skipped");
+      setParameter(PARAMETER_F, 2048);
+      CHECK_EQUAL(linear.getValue(), 0.5f);
+      CHECK_EQUAL(changes, 1);
+      CHECK_EQUAL(changedId, PARAMETER_F);
+      CHECK_EQUAL(changedValue, 0.5f);
+      // a value that the updater would overwrite if it were called
+      linear.update(7.0f);
+      setParameter(PARAMETER_F, 2048);
+      CHECK_EQUAL(linear.getValue(), 7.0f);
+      CHECK_EQUAL(changes, 1);
+      setParameter(PARAMETER_F, 1024);
+      CHECK_EQUAL(linear.getValue(), 0.25f);
+      CHECK_EQUAL(changes, 2);
+      CHECK_EQUAL(changedValue, 0.25f);
+    }
+    {
+      TEST("smoothed parameters are updated until they settle");
+      changes = 0;
+      setParameter(PARAMETER_G, 4095);
+      CHECK_EQUAL(changes, 1);
+      CHECK_EQUAL(changedId, PARAMETER_G);
+      CHECK(smooth.getValue() > 0.0f && smooth.getValue() < 0.5f);
+      int blocks = 1;
+      float previous;
+      do{
+	previous = smooth.getValue();
+	setParameter(PARAMETER_G, 4095);
+	blocks++;
+      }while(smooth.getValue() != previous && blocks < 1000);
+      CHECK(blocks < 1000);
+      CHECK(blocks > 10);
+      CHECK_CLOSE(smooth.getValue(), 4095/4096.0f, 1e-3);
+      // called once for the change, not while settling
+      CHECK_EQUAL(changes, 1);
+      // no longer updated once settled
+      smooth.update(7.0f);
+      setParameter(PARAMETER_G, 4095);
+      CHECK_EQUAL(smooth.getValue(), 7.0f);
+      // settling again after the next change, from where the smoothing left off
+      setParameter(PARAMETER_G, 0);
+      previous = smooth.getValue();
+      CHECK(previous > 0.5f && previous < 4095/4096.0f);
+      setParameter(PARAMETER_G, 0);
+      CHECK(smooth.getValue() < previous);
+    }
+    {
+      TEST("filters update as before");
+      OldUpdater<float, float> oldFloat(0, 10, 0);
+      OldUpdater<float, SmoothFloat> oldSmoothFloat(0, 10, SmoothFloat(0.9, 0));
+      OldUpdater<float, StiffFloat> oldStiffFloat(0, 10, StiffFloat(0.05*10, 0));
+      OldUpdater<float, SmoothStiffFloat> oldSmoothStiffFloat(0, 10, SmoothStiffFloat(0.9, 0.05*10, 0));
+      OldUpdater<float, SmoothFloat> oldSlowFloat(0, 10, SmoothFloat(0.999, 0));
+      OldUpdater<int, int> oldInt(0, 100, 0);
+      int lambda = SmoothInt::normal(0.9, getBlockSize());
+      int delta = StiffInt::normal(0.05)*100;
+      OldUpdater<int, SmoothInt> oldSmoothInt(0, 100, SmoothInt(lambda, 0));
+      OldUpdater<int, StiffInt> oldStiffInt(0, 100, StiffInt(delta, 0));
+      OldUpdater<int, SmoothStiffInt> oldSmoothStiffInt(0, 100, SmoothStiffInt(lambda, delta, 0));
+      srand(1);
+      int16_t raw = 0;
+      for(int block=0; block<2000; block++){
+	// jumps, small moves and holds long enough to settle
+	int r = rand()%100;
+	if(r < 3)
+	  raw = rand()%4096;
+	else if(r < 20)
+	  raw = max(0, min(4095, raw+rand()%81-40));
+	for(int i=0; i<4; i++)
+	  getProgramVector()->parameters[PARAMETER_H+i] = raw;
+	for(int i=0; i<4; i++)
+	  getProgramVector()->parameters[PARAMETER_H+4+i] = raw;
+	getProgramVector()->parameters[PARAMETER_H+8] = raw;
+	getInitialisingPatchProcessor()->setParameterValues(getProgramVector()->parameters);
+	CHECK_EQUAL(floats[0].getValue(), oldFloat.update(raw));
+	CHECK_EQUAL(floats[1].getValue(), oldSmoothFloat.update(raw));
+	CHECK_EQUAL(floats[2].getValue(), oldStiffFloat.update(raw));
+	CHECK_EQUAL(floats[3].getValue(), oldSmoothStiffFloat.update(raw));
+	// slow knob moves are not lost while a heavily smoothed parameter creeps up
+	CHECK_EQUAL(slow.getValue(), oldSlowFloat.update(raw));
+	CHECK_EQUAL(ints[0].getValue(), oldInt.update(raw));
+	CHECK_EQUAL(ints[1].getValue(), oldSmoothInt.update(raw));
+	CHECK_EQUAL(ints[2].getValue(), oldStiffInt.update(raw));
+	CHECK_EQUAL(ints[3].getValue(), oldSmoothStiffInt.update(raw));
+      }
+    }
+    {
+      TEST("SmoothStiffValue smooths with lambda");
+      SmoothStiffFloat smoothstiff(0.5, 0.1, 0);
+      smoothstiff.update(1.0f);
+      CHECK_EQUAL(smoothstiff.getValue(), 0.5f);
+      // changes smaller than delta are ignored
+      smoothstiff.update(0.55f);
+      CHECK_EQUAL(smoothstiff.getValue(), 0.5f);
+    }
+    getInitialisingPatchProcessor()->setPatch(NULL);
+  }
+};
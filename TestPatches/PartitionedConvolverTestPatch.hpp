@@ -0,0 +1,90 @@
+#include "TestPatch.hpp"
+#include "PartitionedConvolver.h"
+
+class PartitionedConvolverTestPatch : public TestPatch {
+public:
+  static void fillNoise(FloatArray array){
+    for(int i=0; i<array.getSize(); ++i)
+      array[i] = rand()/(float)RAND_MAX*2.0f - 1.0f;
+  }
+
+  /* largest difference from the direct convolution, relative to the number of taps */
+  float compare(int blockSize, int taps, int maxLength){
+    const int blocks = 12;
+    FloatArray input = FloatArray::create(blockSize*blocks);
+    FloatArray output = FloatArray::create(blockSize*blocks);
+    FloatArray impulse = FloatArray::create(taps);
+    FloatArray reference = FloatArray::create(blockSize*blocks+taps-1);
+    fillNoise(input);
+    fillNoise(impulse);
+    input.convolve(impulse, reference, 0, input.getSize());
+    PartitionedConvolver* convolver = PartitionedConvolver::create(blockSize, maxLength);
+    convolver->setImpulseResponse(impulse);
+    for(int i=0; i<blocks; ++i)
+      convolver->process(input.subArray(i*blockSize, blockSize), output.subArray(i*blockSize, blockSize));
+    float error = 0;
+    for(int i=0; i<output.getSize(); ++i)
+      error = max(error, fabsf(output[i]-reference[i]));
+    PartitionedConvolver::destroy(convolver);
+    FloatArray::destroy(input);
+    FloatArray::destroy(output);
+    FloatArray::destroy(impulse);
+    FloatArray::destroy(reference);
+    return error/taps;
+  }
+
+  PartitionedConvolverTestPatch(){
+    {
+      TEST("impulse");
+      PartitionedConvolver* convolver = PartitionedConvolver::create(32, 100);
+      FloatArray impulse = FloatArray::create(100);
+      impulse[0] = 1.0f;
+      convolver->setImpulseResponse(impulse);
+      FloatArray buffer = FloatArray::create(32);
+      fillNoise(buffer);
+      FloatArray copy = FloatArray::create(32);
+      copy.copyFrom(buffer);
+      convolver->process(buffer, buffer);
+      for(int i=0; i<32; ++i)
+	CHECK_CLOSE(buffer[i], copy[i], 1e-6);
+      PartitionedConvolver::destroy(convolver);
+      FloatArray::destroy(impulse);
+      FloatArray::destroy(buffer);
+      FloatArray::destroy(copy);
+    }
+    {
+      TEST("convolution");
+      CHECK(compare(16, 1, 1) < 1e-6);
+      CHECK(compare(16, 16, 16) < 1e-6);
+      CHECK(compare(64, 100, 100) < 1e-6);
+      CHECK(compare(128, 1000, 1000) < 1e-6);
+      CHECK(compare(256, 256*5, 256*5) < 1e-6);
+      CHECK(compare(32, 200, 1000) < 1e-6);
+    }
+    {
+      TEST("long impulse response");
+      CHECK(compare(128, 4800, 4800) < 1e-6);
+      CHECK(compare(512, 1000, 4800) < 1e-6);
+    }
+    {
+      TEST("reset");
+      PartitionedConvolver* convolver = PartitionedConvolver::create(16, 40);
+      FloatArray impulse = FloatArray::create(40);
+      fillNoise(impulse);
+      convolver->setImpulseResponse(impulse);
+      FloatArray buffer = FloatArray::create(16);
+      fillNoise(buffer);
+      convolver->process(buffer, buffer);
+      convolver->reset();
+      buffer.clear();
+      for(int i=0; i<4; ++i){
+	convolver->process(buffer, buffer);
+	CHECK_EQUAL(buffer.getMaxValue(), 0.0f);
+	CHECK_EQUAL(buffer.getMinValue(), 0.0f);
+      }
+      PartitionedConvolver::destroy(convolver);
+      FloatArray::destroy(impulse);
+      FloatArray::destroy(buffer);
+    }
+  }
+};
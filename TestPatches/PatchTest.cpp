@@ -2,6 +2,8 @@
 #include "TestPatch.hpp"
 #include "ProgramVector.h"
 #include "PatchProcessor.h"
+#include "heap.h"
+#include "heap_stats.h"
 #include <stdio.h>
 
 #include "registerpatch.h"
@@ -34,8 +36,52 @@ void arm_bitreversal_16(uint32_t *pSrc, const uint16_t bitRevLen, const uint16_t
   #warning TODO!
   // ASSERT(false, "arm_bitreversal_16");
 }
+
+void vApplicationMallocFailedHook( void ){}
+
+void vHeapTraceMalloc( void *pv, size_t xWantedSize, BaseType_t xRegion, const void *pvSite ){
+  vHeapStatsMalloc(pv, xWantedSize, xRegion, pvSite);
+}
+
+void vHeapTraceFree( void *pv ){
+  vHeapStatsFree(pv);
+}
+}
+
+/*
+ * Tests allocate from the heap selected with HEAP, in regions like the
+ * device's but large enough for every test, so that memory hints work and
+ * the allocators are tested too, e.g. make TEST=HeapTest HEAP=heap_tlsf test
+ * Allocations are accounted for as in the renderer.
+ */
+#define FAST_HEAP_SIZE   (64*1024)
+#define NORMAL_HEAP_SIZE (256*1024)
+#define BULK_HEAP_SIZE   (16*1024*1024)
+
+static struct {
+  uint8_t fast[FAST_HEAP_SIZE];
+  uint8_t normal[NORMAL_HEAP_SIZE];
+  uint8_t bulk[BULK_HEAP_SIZE];
+} heap __attribute__ ((aligned (8)));
+
+const HeapRegion_t testHeapRegions[] = {
+  { heap.fast, FAST_HEAP_SIZE },
+  { heap.normal, NORMAL_HEAP_SIZE },
+  { heap.bulk, BULK_HEAP_SIZE },
+  { NULL, 0 } /* Terminates the array. */
+};
+
+// define the regions before any static initialisers run, as main.cpp does
+__attribute__ ((constructor (101)))
+static void defineHeapRegions(){
+  vPortDefineHeapRegions(testHeapRegions);
 }
 
+void * operator new(size_t size) { traceHEAP_SITE(); return pvPortMalloc(size); }
+void * operator new[](size_t size) { traceHEAP_SITE(); return pvPortMalloc(size); }
+void operator delete(void* ptr) { vPortFree(ptr); }
+void operator delete[](void * ptr) { vPortFree(ptr); }
+
 PatchProcessor processor;
 ProgramVector programVector;
 
@@ -72,11 +118,14 @@ void debugMessage(char const* msg){
   printf("%s\n", msg);
 }
 
-Patch::Patch(){}
-Patch::~Patch(){}
-PatchProcessor::PatchProcessor(){}
-PatchProcessor::~PatchProcessor(){}
-int Patch::getBlockSize(){return 128;}
+int16_t parameters[MAX_NUMBER_OF_PARAMETERS];
+
+extern "C" {
+  void doSetPatchParameter(uint8_t id, int16_t value){
+    parameters[id] = value;
+  }
+  void doSetButton(uint8_t id, uint16_t value, uint16_t samples){}
+}
 
 PatchProcessor* getInitialisingPatchProcessor(){
   return &processor;
@@ -92,6 +141,10 @@ void registerPatch(const char* name, uint8_t inputs, uint8_t outputs, TestPatch*
 #define REGISTER_PATCH(T, STR, IN, OUT) registerPatch(STR, IN, OUT, new T)
 
 int main(int argc, char** argv){
+  programVector.audio_blocksize = 128;
+  programVector.audio_samplingrate = 48000;
+  programVector.parameters = parameters;
+  programVector.parameters_size = MAX_NUMBER_OF_PARAMETERS;
 #include "registerpatch.cpp"
   ASSERT(testpatch != NULL, "Missing test patch");    
   int ret = 0;
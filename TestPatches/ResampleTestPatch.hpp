@@ -1,65 +1,133 @@
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*
- 
- 
- LICENSE:
- This program is free software: you can redistribute it and/or modify
- it under the terms of the GNU General Public License as published by
- the Free Software Foundation, either version 3 of the License, or
- (at your option) any later version.
- 
- This program is distributed in the hope that it will be useful,
- but WITHOUT ANY WARRANTY; without even the implied warranty of
- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- GNU General Public License for more details.
- 
- You should have received a copy of the GNU General Public License
- along with this program.  If not, see <http://www.gnu.org/licenses/>.
- 
- */
-
-
-/* created by the OWL team 2015 */
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "TestPatch.hpp"
+#include "Resample.h"
 
+class ResampleTestPatch : public TestPatch {
+public:
+  static const int length = 1024; // analysis length at the base rate
+  static const int bin = 102; // about 0.1 of the sample rate
 
-#ifndef __ResampleTestPatch_hpp__
-#define __ResampleTestPatch_hpp__
+  /* magnitude of the k cycles per size component of the last size samples of array */
+  static float magnitude(FloatArray array, int size, int k){
+    double re = 0, im = 0;
+    float* data = array.getData()+array.getSize()-size;
+    for(int i=0; i<size; i++){
+      re += data[i]*cos(2*M_PI*k*i/size);
+      im += data[i]*sin(2*M_PI*k*i/size);
+    }
+    return 2*sqrt(re*re+im*im)/size;
+  }
 
-#include "StompBox.h"
+  static float decibels(float x){
+    return 20*log10(x);
+  }
 
-class ResampleTestPatch : public Patch {
-public:
-  Resampler resampler;
-  FloatArray up;
-  FloatArray temp;
-  int factor;
-  ResampleTestPatch(){
-    registerParameter(PARAMETER_A, "do_resample");
-    registerParameter(PARAMETER_B, "gain");
-    registerParameter(PARAMETER_C, "master");
-    factor=4;
-    int blockSize=getBlockSize();
-    up=FloatArray::create(factor*blockSize);
+  static void fillSine(FloatArray array, int k, int size){
+    for(int i=0; i<array.getSize(); i++)
+      array[i] = sin(2*M_PI*k*i/size);
   }
-  ~ResampleTestPatch(){
+
+  void checkFactor(int factor){
+    const int blocksize = 64;
+    const int blocks = 4*length/blocksize;
+    Resampler* resampler = Resampler::create(factor, blocksize);
+    FloatArray input = FloatArray::create(4*length);
+    FloatArray up = FloatArray::create(4*length*factor);
+    FloatArray down = FloatArray::create(4*length);
+    fillSine(input, bin, length);
+    for(int i=0; i<blocks; i++){
+      resampler->upsample(input.subArray(i*blocksize, blocksize), up.subArray(i*blocksize*factor, blocksize*factor));
+      resampler->downsample(up.subArray(i*blocksize*factor, blocksize*factor), down.subArray(i*blocksize, blocksize));
+    }
+    // passband gain
+    CHECK_CLOSE(magnitude(up, length*factor, bin), 1.0f, 1e-3);
+    CHECK_CLOSE(magnitude(down, length, bin), 1.0f, 1e-3);
+    // images of the tone around multiples of the base rate
+    for(int j=1; j<factor; j++){
+      CHECK(decibels(magnitude(up, length*factor, j*length-bin)) < -85);
+      CHECK(decibels(magnitude(up, length*factor, j*length+bin)) < -85);
+    }
+    // a tone at the high rate that would alias onto the test bin
+    for(int j=1; j<factor; j++){
+      fillSine(up, j*length+bin, length*factor);
+      resampler->reset();
+      for(int i=0; i<blocks; i++)
+	resampler->downsample(up.subArray(i*blocksize*factor, blocksize*factor), down.subArray(i*blocksize, blocksize));
+      CHECK(decibels(magnitude(down, length, bin)) < -85);
+    }
+    Resampler::destroy(resampler);
+    FloatArray::destroy(input);
     FloatArray::destroy(up);
+    FloatArray::destroy(down);
   }
-  void processAudio(AudioBuffer &buffer){
-    FloatArray samples=buffer.getSamples(0);
-    if(getParameterValue(PARAMETER_A)<0.5){
-      // debugMessage("oversample",downsample.getCoefficients()[3]);
-      return;
+
+  ResampleTestPatch(){
+    {
+      TEST("2x");
+      checkFactor(2);
+    }
+    {
+      TEST("4x");
+      checkFactor(4);
+    }
+    {
+      TEST("8x");
+      checkFactor(8);
+    }
+    {
+      TEST("16x");
+      checkFactor(16);
+    }
+    {
+      TEST("latency");
+      Resampler* resampler = Resampler::create(4, 32);
+      FloatArray input = FloatArray::create(32);
+      FloatArray up = FloatArray::create(128);
+      FloatArray output = FloatArray::create(128);
+      input[0] = 1;
+      for(int i=0; i<4; i++){
+	resampler->upsample(input, up);
+	resampler->downsample(up, output.subArray(i*32, 32));
+	input[0] = 0;
+      }
+      int peak = output.getMaxIndex();
+      CHECK(fabsf(peak-resampler->getLatency()) <= 0.5f);
+      CHECK_CLOSE(output.getMean()*output.getSize(), 1.0f, 1e-4);
+      Resampler::destroy(resampler);
+      FloatArray::destroy(input);
+      FloatArray::destroy(up);
+      FloatArray::destroy(output);
+    }
+    {
+      TEST("block size");
+      Resampler* a = Resampler::create(8, 64);
+      Resampler* b = Resampler::create(8, 64);
+      FloatArray input = FloatArray::create(256);
+      FloatArray copy = FloatArray::create(256);
+      FloatArray upA = FloatArray::create(256*8);
+      FloatArray upB = FloatArray::create(256*8);
+      FloatArray downA = FloatArray::create(256);
+      FloatArray downB = FloatArray::create(256);
+      input.noise();
+      copy.copyFrom(input);
+      for(int i=0; i<256; i+=64){
+	a->upsample(input.subArray(i, 64), upA.subArray(i*8, 64*8));
+	a->downsample(upA.subArray(i*8, 64*8), downA.subArray(i, 64));
+      }
+      for(int i=0; i<256; i+=16){
+	b->upsample(input.subArray(i, 16), upB.subArray(i*8, 16*8));
+	b->downsample(upB.subArray(i*8, 16*8), downB.subArray(i, 16));
+      }
+      CHECK(upA.equals(upB));
+      CHECK(downA.equals(downB));
+      CHECK(input.equals(copy));
+      Resampler::destroy(a);
+      Resampler::destroy(b);
+      FloatArray::destroy(input);
+      FloatArray::destroy(copy);
+      FloatArray::destroy(upA);
+      FloatArray::destroy(upB);
+      FloatArray::destroy(downA);
+      FloatArray::destroy(downB);
     }
-    // debugMessage("oversample",downsample.getCoefficients()[0],downsample.getCoefficients()[1],downsample.getCoefficients()[2]);
-    resampler.upsample(samples,up);
-    
-    resampler.downsample(up, samples);
-    // samples.multiply(getParameterValue(PARAMETER_B));
   }
 };
-
-#endif // __ResampleTestPatch_hpp__
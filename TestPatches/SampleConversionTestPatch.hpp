@@ -0,0 +1,93 @@
+#include "TestPatch.hpp"
+#include "SampleConversion.h"
+
+class SampleConversionTestPatch : public TestPatch {
+public:
+  // reference conversions, one sample at a time
+  static float bigEndianToFloat(const int16_t* src){
+    int32_t qint = (src[0] << 16) | (uint16_t)src[1];
+    return qint / 2147483648.0f;
+  }
+  static float littleEndianToFloat(const int16_t* src){
+    int32_t qint = (src[1] << 16) | (uint16_t)src[0];
+    return qint / 2147483648.0f;
+  }
+  SampleConversionTestPatch(){
+    const int size = 67; // odd size exercises the scalar tail of the vector loops
+    int16_t frames[size*4];
+    float left[size];
+    float right[size];
+    int16_t output[size*4];
+    for(int i=0; i<size*4; ++i)
+      frames[i] = (rand() & 0xffff) - 0x8000;
+    for(int i=0; i<size*4; i+=2)
+      frames[i+1] &= 0xff00; // 24-bit samples: low byte of each word is zero
+    {
+      TEST("split24be");
+      sample_split24be(frames, left, right, size);
+      for(int i=0; i<size; ++i){
+	CHECK_EQUAL(left[i], bigEndianToFloat(frames+i*4));
+	CHECK_EQUAL(right[i], bigEndianToFloat(frames+i*4+2));
+      }
+    }
+    {
+      TEST("comb24be");
+      sample_comb24be(left, right, output, size);
+      CHECK(memcmp(frames, output, sizeof(frames)) == 0);
+    }
+    for(int i=0; i<size*4; i+=2){
+      int16_t hi = frames[i];
+      frames[i] = frames[i+1];
+      frames[i+1] = hi;
+    }
+    {
+      TEST("split24le");
+      sample_split24le(frames, left, right, size);
+      for(int i=0; i<size; ++i){
+	CHECK_EQUAL(left[i], littleEndianToFloat(frames+i*4));
+	CHECK_EQUAL(right[i], littleEndianToFloat(frames+i*4+2));
+      }
+    }
+    {
+      TEST("comb24le");
+      sample_comb24le(left, right, output, size);
+      CHECK(memcmp(frames, output, sizeof(frames)) == 0);
+    }
+    {
+      TEST("full scale");
+      left[0] = -1.0f;
+      right[0] = 0.5f;
+      sample_comb24be(left, right, output, 1);
+      CHECK_EQUAL(output[0], (int16_t)0x8000);
+      CHECK_EQUAL(output[1], (int16_t)0);
+      CHECK_EQUAL(output[2], (int16_t)0x4000);
+      CHECK_EQUAL(output[3], (int16_t)0);
+    }
+    {
+      TEST("comb24be_saturate");
+      for(int i=0; i<size; ++i){
+	left[i] = i*0.1f - 3.0f;
+	right[i] = 3.0f - i*0.1f;
+      }
+      sample_comb24be_saturate(left, right, output, size);
+      for(int i=0; i<size; ++i){
+	int32_t l = (output[i*4] << 16) | (uint16_t)output[i*4+1];
+	int32_t r = (output[i*4+2] << 16) | (uint16_t)output[i*4+3];
+	CHECK_CLOSE(l/2147483648.0f, max(-1.0f, min(left[i], 1.0f)), 0.0000001f);
+	CHECK_CLOSE(r/2147483648.0f, max(-1.0f, min(right[i], 1.0f)), 0.0000001f);
+	CHECK(left[i] < 1.0f || l > 0);
+	CHECK(right[i] < 1.0f || r > 0);
+      }
+    }
+    {
+      TEST("comb24le_saturate");
+      sample_comb24le_saturate(left, right, output, size);
+      for(int i=0; i<size; ++i){
+	int32_t l = (output[i*4+1] << 16) | (uint16_t)output[i*4];
+	int32_t r = (output[i*4+3] << 16) | (uint16_t)output[i*4+2];
+	CHECK_CLOSE(l/2147483648.0f, max(-1.0f, min(left[i], 1.0f)), 0.0000001f);
+	CHECK_CLOSE(r/2147483648.0f, max(-1.0f, min(right[i], 1.0f)), 0.0000001f);
+      }
+    }
+  }
+};
@@ -0,0 +1,67 @@
+#include "TestPatch.hpp"
+#include "ShortBuffer.hpp"
+
+class ShortBufferTestPatch : public TestPatch {
+public:
+  ShortBufferTestPatch(){
+    const int size = 33;
+    int16_t frames[size*4];
+    for(int i=0; i<size*4; ++i)
+      frames[i] = (rand() & 0xffff) - 0x8000;
+#if AUDIO_BITDEPTH != 16
+    // a full scale word that rounds up past the Q15 range
+    int hi = 0, lo = 1;
+#ifndef AUDIO_BIGEND
+    hi = 1; lo = 0;
+#endif
+    frames[hi] = 0x7fff;
+    frames[lo] = 0x7f00;
+#endif
+    ShortBuffer* buffer = new ShortBuffer();
+    {
+      TEST("split");
+      buffer->split(frames, size);
+      CHECK_EQUAL(buffer->getSize(), size);
+      for(int ch=0; ch<2; ++ch){
+	ShortArray samples = buffer->getSamples(ch);
+	for(int i=0; i<size; ++i){
+#if AUDIO_BITDEPTH == 16
+	  int expected = frames[i*2+ch];
+#else
+	  int32_t word = (frames[i*4+ch*2+hi] << 16) | (uint16_t)frames[i*4+ch*2+lo];
+	  int expected = min(0x7fff, (int)round(word/65536.0));
+#endif
+	  CHECK_EQUAL((int)samples[i], expected);
+	}
+      }
+      CHECK_EQUAL((int)buffer->getSamples(0)[0], 0x7fff);
+    }
+    {
+      TEST("comb");
+      int16_t output[size*4];
+      buffer->comb(output);
+      for(int ch=0; ch<2; ++ch){
+	ShortArray samples = buffer->getSamples(ch);
+	for(int i=0; i<size; ++i){
+#if AUDIO_BITDEPTH == 16
+	  CHECK_EQUAL((int)output[i*2+ch], (int)samples[i]);
+#else
+	  CHECK_EQUAL((int)output[i*4+ch*2+hi], (int)samples[i]);
+	  CHECK_EQUAL((int)output[i*4+ch*2+lo], 0);
+#endif
+	}
+      }
+    }
+    {
+      TEST("saturate");
+      ShortArray samples = buffer->getSamples(0);
+      samples.setFloatValue(0, 1.0f);
+      CHECK_EQUAL((int)samples[0], 0x7fff);
+      samples.setFloatValue(1, -1.5f);
+      CHECK_EQUAL((int)samples[1], -0x8000);
+      samples.setFloatValue(2, 0.5f);
+      CHECK_EQUAL((int)samples[2], 0x4000);
+    }
+    delete buffer;
+  }
+};
@@ -0,0 +1,82 @@
+#include "TestPatch.hpp"
+#include "StaticArray.h"
+
+static float sumArray(FloatArray array){
+  return array.getMean()*array.getSize();
+}
+
+class StaticArrayTestPatch : public TestPatch {
+public:
+  StaticArrayTestPatch(){
+    {
+      TEST("size");
+      StaticFloatArray<64> array;
+      CHECK_EQUAL(array.getSize(), 64);
+      CHECK_EQUAL(StaticFloatArray<64>::size, 64);
+      CHECK_EQUAL(sizeof(array), sizeof(float[64]));
+      CHECK_EQUAL(sizeof(StaticShortArray<64>), sizeof(int16_t[64]));
+    }
+    {
+      TEST("zero initialised");
+      StaticFloatArray<100> array;
+      for(int i=0; i<array.getSize(); ++i)
+	CHECK_EQUAL(array[i], 0.0f);
+      StaticComplexFloatArray<16> complex;
+      for(int i=0; i<complex.getSize(); ++i){
+	CHECK_EQUAL(complex[i].re, 0.0f);
+	CHECK_EQUAL(complex[i].im, 0.0f);
+      }
+    }
+    {
+      TEST("FloatArray conversion");
+      StaticFloatArray<32> array;
+      array.setAll(0.5f);
+      FloatArray handle = array;
+      CHECK_EQUAL(handle.getSize(), 32);
+      CHECK(handle.getData() == array.getData());
+      CHECK_CLOSE(sumArray(array), 16.0f, DEFAULT_TOLERANCE);
+      array.getArray().multiply(2.0f);
+      for(int i=0; i<array.getSize(); ++i)
+	CHECK_EQUAL(array[i], 1.0f);
+      float* data = array;
+      CHECK(data == array.getData());
+    }
+    {
+      TEST("ShortArray and IntArray conversion");
+      StaticShortArray<8> shorts;
+      shorts.setAll(100);
+      ShortArray shortHandle = shorts;
+      CHECK_EQUAL(shortHandle.getSize(), 8);
+      CHECK_EQUAL(shortHandle[7], (int16_t)100);
+      StaticIntArray<8> ints;
+      IntArray intHandle = ints;
+      intHandle.setAll(-3);
+      CHECK_EQUAL(ints[0], (int32_t)-3);
+      CHECK_EQUAL(ints[7], (int32_t)-3);
+    }
+    {
+      TEST("ComplexFloatArray conversion");
+      StaticComplexFloatArray<4> array;
+      ComplexFloatArray handle = array;
+      handle[2].re = 3.0f;
+      handle[2].im = 4.0f;
+      CHECK_EQUAL(handle.getSize(), 4);
+      CHECK_CLOSE(array[2].getMagnitude(), 5.0f, DEFAULT_TOLERANCE);
+    }
+    {
+      TEST("copy");
+      StaticFloatArray<16> array;
+      for(int i=0; i<array.getSize(); ++i)
+	array[i] = i;
+      StaticFloatArray<16> copy = array;
+      CHECK(copy.getData() != array.getData());
+      array.setAll(0);
+      for(int i=0; i<copy.getSize(); ++i)
+	CHECK_EQUAL(copy[i], (float)i);
+      float buffer[16];
+      copy.copyTo(buffer);
+      array.copyFrom(buffer);
+      CHECK(array.getArray().equals(copy));
+    }
+  }
+};
@@ -34,6 +34,7 @@ extern "C"{
   char* WEB_getParameterName(int pid);
 
   void *pvPortMalloc( size_t xWantedSize );
+  void *pvPortMallocFrom( size_t xWantedSize, BaseType_t xRegion );
   void vPortFree( void *pv );
 }
 
@@ -235,6 +236,10 @@ void *pvPortMalloc( size_t xWantedSize ){
 #endif
   return malloc(xWantedSize);
 }
+// there is only one memory region, memory hints are ignored
+void *pvPortMallocFrom( size_t xWantedSize, BaseType_t xRegion ){
+  return pvPortMalloc(xWantedSize);
+}
 void vPortFree( void *pv ){
 #ifdef free
 #undef free
@@ -0,0 +1,76 @@
+BUILDROOT ?= .
+
+C_SRC   = basicmaths.c kiss_fft.c $(HEAP).c
+CPP_SRC = BenchmarkMain.cpp
+CPP_SRC += FloatArrayBench.cpp ComplexFloatArrayBench.cpp
+CPP_SRC += FilterBench.cpp FastFourierTransformBench.cpp OscillatorBench.cpp
+CPP_SRC += SampleConversionBench.cpp HeapBench.cpp
+CPP_SRC += FloatArray.cpp ComplexFloatArray.cpp FastFourierTransform.cpp
+CPP_SRC += WavetableOscillator.cpp PolyBlepOscillator.cpp
+
+BUILD       ?= $(BUILDROOT)/Build
+BENCHDIR     = $(BUILD)/bench
+
+SOURCE       = $(BUILDROOT)/Source
+LIBSOURCE    = $(BUILDROOT)/LibSource
+BENCHMARKS   = $(BUILDROOT)/Benchmarks
+
+# results are written to BENCH_RESULT and compared against BENCH_BASELINE if it exists
+BENCH_RESULT    ?= $(BUILD)/bench.json
+BENCH_BASELINE  ?= $(BENCHMARKS)/baseline.json
+BENCH_TOLERANCE ?= 20
+BENCH_FILTER    ?=
+
+# native host build, optimised like the firmware build
+CPPFLAGS  = -O2 -ffast-math -Wall
+CPPFLAGS += -I$(SOURCE)
+CPPFLAGS += -I$(LIBSOURCE)
+CPPFLAGS += -I$(BENCHMARKS)
+CPPFLAGS += -ILibraries -ILibraries/KissFFT
+CPPFLAGS += -DBENCH_TRACES=\"$(BENCHMARKS)/traces\"
+
+CXXFLAGS = -fno-rtti -fno-exceptions -std=gnu++11
+
+LDLIBS   = -lm
+
+# object files
+OBJS  = $(C_SRC:%.c=$(BENCHDIR)/%.o) $(CPP_SRC:%.cpp=$(BENCHDIR)/%.o)
+
+# Set up search path
+vpath %.cpp $(BENCHMARKS)
+vpath %.cpp $(SOURCE)
+vpath %.c $(SOURCE)
+vpath %.cpp $(LIBSOURCE)
+vpath %.c $(LIBSOURCE)
+vpath %.c Libraries/KissFFT
+
+# compile and generate dependency info
+$(BENCHDIR)/%.o: %.c
+	@mkdir -p $(BENCHDIR)
+	@$(CC) -c $(CPPFLAGS) $(CFLAGS) $< -o $@
+	@$(CC) -MM -MT"$@" $(CPPFLAGS) $(CFLAGS) $< > $(@:.o=.d)
+
+$(BENCHDIR)/%.o: %.cpp
+	@mkdir -p $(BENCHDIR)
+	@$(CXX) -c $(CPPFLAGS) $(CXXFLAGS) $< -o $@
+	@$(CXX) -MM -MT"$@" $(CPPFLAGS) $(CXXFLAGS) $< > $(@:.o=.d)
+
+# always relink, since the objects for another HEAP may be newer
+$(BENCHDIR)/bench: $(OBJS) .FORCE
+	@$(CXX) $(LDFLAGS) -o $@ $(OBJS) $(LDLIBS)
+
+.PHONY: .FORCE bench bench-baseline
+
+.FORCE:
+
+bench: $(BENCHDIR)/bench
+ifneq ($(wildcard $(BENCH_BASELINE)),)
+	@$(BENCHDIR)/bench -o $(BENCH_RESULT) -b $(BENCH_BASELINE) -t $(BENCH_TOLERANCE) $(BENCH_FILTER)
+else
+	@$(BENCHDIR)/bench -o $(BENCH_RESULT) $(BENCH_FILTER)
+endif
+
+bench-baseline: $(BENCHDIR)/bench
+	@$(BENCHDIR)/bench -o $(BENCH_BASELINE) $(BENCH_FILTER)
+
+-include $(OBJS:.o=.d)
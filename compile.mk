@@ -1,14 +1,21 @@
 BUILDROOT ?= .
 
-C_SRC   = basicmaths.c heap_5.c # sbrk.c
-CPP_SRC = main.cpp operators.cpp message.cpp Patch.cpp PatchProcessor.cpp
+C_SRC   = basicmaths.c $(HEAP).c # sbrk.c
+CPP_SRC = main.cpp operators.cpp message.cpp Patch.cpp PatchProcessor.cpp InterleavedPatch.cpp ShortPatch.cpp
 CPP_SRC += FloatArray.cpp ComplexFloatArray.cpp ComplexShortArray.cpp FastFourierTransform.cpp ShortFastFourierTransform.cpp 
 CPP_SRC += ShortArray.cpp
 CPP_SRC += Envelope.cpp VoltsPerOctave.cpp Window.cpp
 CPP_SRC += WavetableOscillator.cpp PolyBlepOscillator.cpp
 CPP_SRC += SmoothValue.cpp PatchParameter.cpp
-CPP_SRC += PatchProgram.cpp 
-# CPP_SRC += ShortPatchProgram.cpp 
+ifdef FIXEDPOINT
+CPP_SRC += ShortPatchProgram.cpp
+else
+CPP_SRC += PatchProgram.cpp
+endif
+ifdef HEAPSTATS
+C_SRC += heap_stats.c
+CPPFLAGS += -DHEAP_STATS
+endif
 
 SOURCE       = $(BUILDROOT)/Source
 LIBSOURCE    = $(BUILDROOT)/LibSource
@@ -23,6 +23,8 @@ OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_df1_init_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_df1_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_df2T_init_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_df2T_f32.o
+OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_stereo_df2T_init_f32.o
+OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_stereo_df2T_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_correlate_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_conv_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_conv_partial_f32.o
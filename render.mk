@@ -0,0 +1,100 @@
+BUILDROOT ?= .
+
+C_SRC   = basicmaths.c kiss_fft.c $(HEAP).c heap_stats.c
+CPP_SRC = render.cpp
+CPP_SRC += PatchProcessor.cpp
+CPP_SRC += Patch.cpp PatchParameter.cpp SmoothValue.cpp InterleavedPatch.cpp ShortPatch.cpp
+CPP_SRC += FloatArray.cpp ComplexFloatArray.cpp FastFourierTransform.cpp
+CPP_SRC += ShortArray.cpp
+CPP_SRC += Envelope.cpp VoltsPerOctave.cpp Window.cpp
+CPP_SRC += WavetableOscillator.cpp PolyBlepOscillator.cpp
+ifdef FIXEDPOINT
+CPP_SRC += ShortPatchProgram.cpp
+else
+CPP_SRC += PatchProgram.cpp
+endif
+
+BUILD       ?= $(BUILDROOT)/Build
+RENDERDIR    = $(BUILD)/render
+
+SOURCE       = $(BUILDROOT)/Source
+LIBSOURCE    = $(BUILDROOT)/LibSource
+HOSTSOURCE   = $(BUILDROOT)/HostSource
+GENSOURCE    = $(BUILD)/Source
+TESTPATCHES  = $(BUILDROOT)/TestPatches
+
+# native host build: optimised like the firmware build, but without ARM_CORTEX
+CPPFLAGS  = -O2 -ffast-math -Wall
+CPPFLAGS += -I$(SOURCE)
+CPPFLAGS += -I$(LIBSOURCE)
+CPPFLAGS += -I$(HOSTSOURCE)
+CPPFLAGS += -I$(PATCHSOURCE)
+CPPFLAGS += -I$(GENSOURCE)
+CPPFLAGS += -I$(TESTPATCHES)
+CPPFLAGS += -I$(BUILD)
+CPPFLAGS += -ILibraries -ILibraries/KissFFT
+# allocation statistics, with enough live blocks for most patches
+CPPFLAGS += -DHEAP_STATS -DHEAP_STATS_MAX_BLOCKS=4096
+
+ifdef HEAVY
+CPPFLAGS += -DHV_SIMD_NONE
+endif
+
+CXXFLAGS = -fno-rtti -fno-exceptions -std=gnu++11
+
+# export symbols so that allocation sites can be named with dladdr
+LDFLAGS  = -rdynamic
+LDLIBS   = -lm -ldl
+
+PATCH_C_SRC    = $(wildcard $(PATCHSOURCE)/*.c)
+PATCH_CPP_SRC  = $(wildcard $(PATCHSOURCE)/*.cpp)
+PATCH_C_SRC   += $(wildcard $(GENSOURCE)/*.c)
+PATCH_CPP_SRC += $(wildcard $(GENSOURCE)/*.cpp)
+PATCH_OBJS  = $(addprefix $(RENDERDIR)/, $(notdir $(PATCH_C_SRC:.c=.o)))
+PATCH_OBJS += $(addprefix $(RENDERDIR)/, $(notdir $(PATCH_CPP_SRC:.cpp=.o)))
+
+# object files
+OBJS  = $(C_SRC:%.c=$(RENDERDIR)/%.o) $(CPP_SRC:%.cpp=$(RENDERDIR)/%.o)
+
+# Set up search path
+vpath %.cpp $(HOSTSOURCE)
+vpath %.cpp $(SOURCE)
+vpath %.c $(SOURCE)
+vpath %.cpp $(LIBSOURCE)
+vpath %.c $(LIBSOURCE)
+vpath %.cpp $(PATCHSOURCE)
+vpath %.c $(PATCHSOURCE)
+vpath %.cpp $(GENSOURCE)
+vpath %.c $(GENSOURCE)
+vpath %.c Libraries/KissFFT
+
+# the patch is compiled in to PatchProgram through registerpatch.h and registerpatch.cpp
+$(RENDERDIR)/PatchProgram.o: $(SOURCE)/PatchProgram.cpp .FORCE
+	@mkdir -p $(RENDERDIR)
+	@$(CXX) -c $(CPPFLAGS) $(CXXFLAGS) $(SOURCE)/PatchProgram.cpp -o $@
+
+$(RENDERDIR)/ShortPatchProgram.o: $(SOURCE)/ShortPatchProgram.cpp .FORCE
+	@mkdir -p $(RENDERDIR)
+	@$(CXX) -c $(CPPFLAGS) $(CXXFLAGS) $(SOURCE)/ShortPatchProgram.cpp -o $@
+
+# compile and generate dependency info
+$(RENDERDIR)/%.o: %.c
+	@mkdir -p $(RENDERDIR)
+	@$(CC) -c $(CPPFLAGS) $(CFLAGS) $< -o $@
+	@$(CC) -MM -MT"$@" $(CPPFLAGS) $(CFLAGS) $< > $(@:.o=.d)
+
+$(RENDERDIR)/%.o: %.cpp
+	@mkdir -p $(RENDERDIR)
+	@$(CXX) -c $(CPPFLAGS) $(CXXFLAGS) $< -o $@
+	@$(CXX) -MM -MT"$@" $(CPPFLAGS) $(CXXFLAGS) $< > $(@:.o=.d)
+
+$(RENDERDIR)/$(TARGET): $(PATCH_OBJS) $(OBJS)
+	@$(CXX) $(LDFLAGS) -o $@ $(PATCH_OBJS) $(OBJS) $(LDLIBS)
+
+.PHONY: .FORCE render
+
+.FORCE:
+
+render: $(RENDERDIR)/$(TARGET)
+
+-include $(OBJS:.o=.d) $(PATCH_OBJS:.o=.d)
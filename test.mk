@@ -1,13 +1,18 @@
 BUILDROOT ?= .
 
+HEAP    ?= heap_5
+
 C_SRC   = basicmaths.c
 C_SRC   += kiss_fft.c
+C_SRC   += $(HEAP).c heap_stats.c
 # CPP_SRC = PatchTest.cpp
 CPP_SRC += FloatArray.cpp
 CPP_SRC += ShortArray.cpp
+CPP_SRC += ComplexFloatArray.cpp FastFourierTransform.cpp
 CPP_SRC += Envelope.cpp VoltsPerOctave.cpp Window.cpp
 CPP_SRC += WavetableOscillator.cpp PolyBlepOscillator.cpp
-CPP_SRC += SmoothValue.cpp # PatchParameter.cpp
+CPP_SRC += SmoothValue.cpp PatchParameter.cpp
+CPP_SRC += Patch.cpp PatchProcessor.cpp
 
 BUILD       ?= $(BUILDROOT)/Build
 
@@ -24,6 +29,7 @@ CPPFLAGS += -ILibraries -ILibraries/KissFFT
 CPPFLAGS += -ILibraries/CMSIS/Include
 CPPFLAGS +=  -DARM_MATH_CM0
 CPPFLAGS +=  -fno-builtin -ffreestanding
+CPPFLAGS +=  -DHEAP_STATS
 
 # Tools
 # TOOLROOT=i686-pc-cygwin-
@@ -86,6 +92,8 @@ OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_df1_init_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_df1_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_df2T_init_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_df2T_f32.o
+OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_stereo_df2T_init_f32.o
+OBJS += $(DSPLIB)/FilteringFunctions/arm_biquad_cascade_stereo_df2T_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_correlate_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_conv_f32.o
 OBJS += $(DSPLIB)/FilteringFunctions/arm_conv_partial_f32.o